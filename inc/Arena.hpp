@@ -97,14 +97,7 @@ public:
     inline size_t getSize() const { return vertices.size(); }
     inline size_t getMaxPriority() const { return maxPriority; }
 
-    inline bool clearVertex(size_t id)
-    {
-        if (id < vertices.size()) {
-            vertices[id] = Vertex(id);
-            return true;
-        }
-        return false;
-    }
+    bool clearVertex(size_t id);
 
     size_t countVerticesByPriority(size_t priority) const;
 };
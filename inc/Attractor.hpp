@@ -0,0 +1,66 @@
+#ifndef ATTRACTOR_HPP
+#define ATTRACTOR_HPP
+
+#include "Arena.hpp"
+#include "VertexSet.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace PAPG {
+
+// Attractor computation over the incoming edges of an Arena, restricted to a
+// subgame given as a VertexSet. Keeps its workspace between computations, so
+// one instance should be reused rather than constructing one per attractor.
+// Not thread-safe, use one instance per thread.
+//
+// With setMaxThreads() above 1, attractors on large arenas are computed level
+// by level instead, each level (the vertices attracted by the previous one)
+// being split over that many threads when it is large enough. The region and
+// the counters are then updated with atomic operations, and the counters of
+// all candidate opponent vertices are set up front.
+class Attractor {
+private:
+    static const size_t parallelMinArenaSize = 1 << 16; // smaller arenas are always done sequentially
+    static const size_t parallelMinLevelSize = 1 << 12; // smaller levels are done on the calling thread
+
+    const Arena* arena;
+    VertexSet ownedByOdd;
+    unsigned maxThreads;
+
+    // number of successors (within the subgame) of an opponent vertex that
+    // are not yet in the region, only valid where stamps matches generation
+    std::vector<size_t> remainingSuccessors;
+    std::vector<unsigned> stamps;
+    unsigned generation;
+
+    std::vector<size_t> queue;
+    std::vector<size_t> nextLevel;
+
+    unsigned numComputations;
+    unsigned long long numEdges; // incoming edges looked at
+
+    void attractSequential(const VertexSet& subgame, VertexSet& region, Player player, std::vector<size_t>* strategy);
+    void attractParallel(const VertexSet& subgame, VertexSet& region, Player player, std::vector<size_t>* strategy);
+
+public:
+    explicit Attractor(const Arena& arena);
+
+    // starts over on another arena, keeping the workspace's storage
+    void reset(const Arena& newArena);
+
+    // Extends region (which must be a subset of subgame) to the attractor of
+    // region for player within subgame. If strategy is given, strategy[v] is
+    // set for every attracted vertex of player to its successor in the region.
+    void attract(const VertexSet& subgame, VertexSet& region, Player player, std::vector<size_t>* strategy = nullptr);
+
+    inline void setMaxThreads(unsigned threads) { maxThreads = std::max(1u, threads); }
+
+    inline unsigned getComputationCount() const { return numComputations; }
+    inline void resetComputationCount() { numComputations = 0; }
+    inline unsigned long long getEdgeCount() const { return numEdges; }
+};
+
+} // PAPG
+
+#endif // ATTRACTOR_HPP
@@ -0,0 +1,102 @@
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+
+#include "SolutionCache.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace PAPG {
+
+// The measures of a small progress measures solve at some point. Measures
+// only go up towards the solution, so any such snapshot is a valid point to
+// start lifting from again, with any lifting strategy. Each measure takes
+// recordSize words: a top flag and a value per odd priority.
+struct CheckpointData {
+    SolutionCache::Key key; // of the game alone, SolutionCache::makeKey(game, "")
+    std::string strategy; // the strategy that was running, for information only
+    unsigned long long lifts; // done by then
+    uint64_t recordSize;
+    std::vector<uint32_t> words;
+};
+
+// Writes checkpoints of the running solve to a file every interval, and
+// reads one back to resume from. BasicSPMSolver hands over a copy of its
+// measures when a checkpoint is due (see isDue()) and when it is
+// interrupted, a thread of the checkpointer writes the copy out so lifting
+// goes on meanwhile. A snapshot that comes while the previous one is still
+// being written is skipped. The file is replaced in one go (written under
+// a temporary name, synced and renamed), so it always holds a whole
+// checkpoint. Only the Measure solvers take checkpoints, not the succinct
+// ones. Write errors are kept and given by getError().
+class Checkpointer {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+private:
+    std::string path;
+    Clock::duration interval;
+    Clock::time_point nextDue;
+
+    SolutionCache::Key key; // of the game being solved
+    std::string strategy;
+    std::unique_ptr<CheckpointData> resume; // loaded but not taken yet
+    unsigned long long resumedLifts;
+
+    std::unique_ptr<CheckpointData> pending; // handed over, not written yet
+    bool isWriting;
+    bool isStopped;
+    unsigned long long numWritten;
+    std::string error;
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::thread writer;
+
+    void writeAll();
+    void writeFile(const CheckpointData& data);
+
+public:
+    Checkpointer(const std::string& path, Clock::duration interval);
+    ~Checkpointer(); // writes what was handed over first
+    Checkpointer(const Checkpointer&) = delete;
+    Checkpointer& operator=(const Checkpointer&) = delete;
+
+    // reads the checkpoint at path to resume the next solve of its game from,
+    // throws std::runtime_error if there is none or it can't be read
+    void loadResume();
+
+    // Sets the game (by its key) and strategy of the next solve and restarts
+    // the interval. Returns false if a checkpoint was loaded that is of
+    // another game; it is dropped then.
+    bool begin(const SolutionCache::Key& gameKey, const std::string& strategyName);
+
+    // the loaded checkpoint, if it is of the game being solved, once
+    std::unique_ptr<CheckpointData> takeResume();
+    inline unsigned long long getResumedLifts() const { return resumedLifts; } // of the checkpoint this solve took, 0 if none
+
+    inline bool isDue() const { return Clock::now() >= nextDue; }
+    inline const SolutionCache::Key& getKey() const { return key; }
+    inline const std::string& getStrategy() const { return strategy; }
+
+    // true if a snapshot handed over now would be written, false while the last one is still being written
+    bool isReady();
+
+    // hands a snapshot over to be written and restarts the interval
+    void write(std::unique_ptr<CheckpointData> data);
+
+    // waits until everything handed over is written
+    void flush();
+
+    unsigned long long getWrittenCount();
+    std::string getError();
+};
+
+} // PAPG
+
+#endif // CHECKPOINT_HPP
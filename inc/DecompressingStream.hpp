@@ -0,0 +1,79 @@
+#ifndef DECOMPRESSINGSTREAM_HPP
+#define DECOMPRESSINGSTREAM_HPP
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <exception>
+#include <istream>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace PAPG {
+
+enum class Compression {
+    none,
+    gzip,
+    bzip2,
+    xz
+};
+
+// detects the compression of a file from its magic bytes
+Compression detectCompression(const std::string& path);
+
+// Stream buffer over a gzip, bzip2 or xz compressed file. The file is read
+// and decompressed on a thread of its own, which hands blocks of
+// decompressed data to the reading side through a small bounded queue, so
+// decompression runs ahead of whatever consumes the stream. Errors on the
+// decompression thread are rethrown on the reading side.
+class DecompressingStreamBuffer : public std::streambuf {
+private:
+    static const size_t blockSize = 1 << 18;
+    static const size_t maxQueuedBlocks = 4;
+
+    std::FILE* file;
+    const Compression compression;
+
+    std::deque<std::vector<char> > blocks; // decompressed, waiting to be read
+    std::vector<char> current; // the block being read
+    bool isFinished; // no more blocks will be added
+    bool isStopped; // the reading side is gone, the thread should stop
+    std::exception_ptr error;
+    std::mutex mutex;
+    std::condition_variable changed;
+
+    std::thread decompressor;
+
+    void decompress();
+    void decompressGzip();
+    void decompressBzip2();
+    void decompressXz();
+
+    // hands a block to the reading side, returns false if it should stop
+    bool push(std::vector<char>& block);
+
+protected:
+    int_type underflow() override;
+
+public:
+    DecompressingStreamBuffer(const std::string& path, Compression compression);
+    ~DecompressingStreamBuffer();
+
+    DecompressingStreamBuffer(const DecompressingStreamBuffer&) = delete;
+    DecompressingStreamBuffer& operator=(const DecompressingStreamBuffer&) = delete;
+};
+
+class DecompressingStream : public std::istream {
+private:
+    DecompressingStreamBuffer buffer;
+
+public:
+    DecompressingStream(const std::string& path, Compression compression);
+};
+
+} // PAPG
+
+#endif // DECOMPRESSINGSTREAM_HPP
@@ -0,0 +1,104 @@
+#ifndef LIFTTRACE_HPP
+#define LIFTTRACE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace PAPG {
+
+// Records every lift attempt of the small progress measures solvers to a
+// file, for offline analysis with tools/tracereport.cpp. Only compiled in
+// with PAPG_TRACE defined (make TRACE=1): without it the PAPG_TRACE_* macros
+// below expand to nothing.
+//
+// Every thread fills a buffer of its own, which is handed to a writer thread
+// when full and replaced by one it is done with, so recording a lift is an
+// append to memory. When the writer falls behind, a full buffer waits for
+// one to come back.
+//
+// File format: the magic "PAPGTRC1", then chunks, each a ChunkHeader
+// followed by either size LiftRecords (records, id being the thread) or
+// size bytes of a run's name (run, id being the run). Runs are numbered
+// from 1, modulo 2^16.
+
+enum class LiftPhase : uint8_t {
+    sweep, // the Sweep and Random schedules
+    recursive, // the Recursive schedule
+    seeds, // lifting self-loop vertices in lockSelfLoopVertices()
+    propagation, // lockPredecessorsIfAble()
+    hybrid, // the Recursive schedule with HybridSeeding
+    worklist // the Worklist schedule
+};
+
+const char* toString(LiftPhase phase);
+
+struct LiftRecord {
+    uint64_t vertex;
+    uint32_t recursionDepth;
+    uint16_t run; // the run of the last LiftTrace::beginRun()
+    uint8_t phase; // a LiftPhase
+    uint8_t flags; // isLiftedFlag and isTopFlag
+
+    static const uint8_t isLiftedFlag = 1; // the measure went up
+    static const uint8_t isTopFlag = 2; // the measure is top after the lift
+};
+
+struct ChunkHeader {
+    enum Kind : uint32_t {
+        records,
+        run
+    };
+
+    uint32_t kind;
+    uint32_t id;
+    uint64_t size;
+};
+
+const char traceMagic[8] = { 'P', 'A', 'P', 'G', 'T', 'R', 'C', '1' };
+
+namespace LiftTrace {
+    // starts recording to the file at path, throws std::runtime_error if it can't be written
+    void open(const std::string& path);
+
+    // writes out what is left of every buffer and closes the file, threads
+    // that are still running lose what they record from now on
+    void close();
+
+    bool isOpen();
+
+    // starts the next run, every lift recorded after it belongs to the run
+    void beginRun(const std::string& name);
+
+    void record(size_t vertex, bool isLifted, bool isTop, unsigned recursionDepth);
+
+    // the phase of the lifts the calling thread records while it exists
+    class PhaseScope {
+    private:
+        LiftPhase previous;
+
+    public:
+        explicit PhaseScope(LiftPhase phase);
+        ~PhaseScope();
+        PhaseScope(const PhaseScope&) = delete;
+        PhaseScope& operator=(const PhaseScope&) = delete;
+    };
+} // LiftTrace
+
+} // PAPG
+
+#ifdef PAPG_TRACE
+#define PAPG_TRACE_CONCAT_(a, b) a##b
+#define PAPG_TRACE_CONCAT(a, b) PAPG_TRACE_CONCAT_(a, b)
+#define PAPG_TRACE_LIFT(vertex, isLifted, isTop, recursionDepth) PAPG::LiftTrace::record((vertex), (isLifted), (isTop), (recursionDepth))
+#define PAPG_TRACE_PHASE(phase) PAPG::LiftTrace::PhaseScope PAPG_TRACE_CONCAT(liftTracePhase, __LINE__)(PAPG::LiftPhase::phase)
+#define PAPG_TRACE_PHASE_OF(value) PAPG::LiftTrace::PhaseScope PAPG_TRACE_CONCAT(liftTracePhase, __LINE__)(value)
+#define PAPG_TRACE_RUN(name) PAPG::LiftTrace::beginRun(name)
+#else
+#define PAPG_TRACE_LIFT(vertex, isLifted, isTop, recursionDepth) ((void)0)
+#define PAPG_TRACE_PHASE(phase) ((void)0)
+#define PAPG_TRACE_PHASE_OF(value) ((void)0)
+#define PAPG_TRACE_RUN(name) ((void)0)
+#endif
+
+#endif // LIFTTRACE_HPP
@@ -0,0 +1,248 @@
+#ifndef LIFTINGPOLICIES_HPP
+#define LIFTINGPOLICIES_HPP
+
+#include "LiftTrace.hpp"
+#include "VertexSet.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+#include <deque>
+#include <vector>
+
+namespace PAPG {
+
+// The lifting strategies of BasicSPMSolver are put together from three
+// policies, see BasicSPMSolver::solveWith(): an order the vertices are
+// visited in, a schedule that lifts them in that order until nothing lifts
+// anymore, and a seeding that settles what it can before and while the
+// schedule runs. Each is a type whose static (or, for the seedings, member)
+// function templates get the solver, so a combination is instantiated as a
+// whole and the policy calls in the lifting loops are inlined.
+
+// ==================
+// orders
+
+struct InputOrder {
+    template <typename ArenaType>
+    static void sort(const ArenaType&, std::vector<size_t>&)
+    {
+    }
+};
+
+// ascending priority
+struct PriorityOrder {
+    template <typename ArenaType>
+    static void sort(const ArenaType& arena, std::vector<size_t>& vertices)
+    {
+        std::sort(vertices.begin(), vertices.end(), [&arena](size_t a, size_t b) {
+            return arena[a].priority < arena[b].priority;
+        });
+    }
+};
+
+// descending number of predecessors
+struct IncomingOrder {
+    template <typename ArenaType>
+    static void sort(const ArenaType& arena, std::vector<size_t>& vertices)
+    {
+        std::sort(vertices.begin(), vertices.end(), [&arena](size_t a, size_t b) {
+            return arena[a].incoming.size() > arena[b].incoming.size();
+        });
+    }
+};
+
+// ==================
+// seedings
+
+// Seedings have seed(solver, vertices), which may settle vertices and
+// remove them from those left to the schedule, and afterLift(solver,
+// vertex), which the schedules call after every lift that changed a measure.
+// isPropagating tells whether afterLift() does anything.
+
+struct NoSeeding {
+    static const bool isPropagating = false;
+
+    template <typename Solver>
+    void seed(Solver&, std::vector<size_t>&)
+    {
+    }
+
+    template <typename Solver>
+    inline void afterLift(Solver&, size_t)
+    {
+    }
+};
+
+// Lifts the vertices with a self-loop that their owner wins as far as they
+// go and propagates from there (see BasicSPMSolver::lockSelfLoopVertices()),
+// leaving the schedule the vertices it didn't lock.
+class PropagationSeeding {
+protected:
+    std::vector<size_t> lockedVertices;
+
+public:
+    static const bool isPropagating = false;
+
+    template <typename Solver>
+    void seed(Solver& solver, std::vector<size_t>& vertices)
+    {
+        lockedVertices = solver.lockSelfLoopVertices();
+        vertices.erase(std::remove_if(vertices.begin(), vertices.end(), [&solver](size_t vertex) { return solver.isLocked(vertex); }), vertices.end());
+    }
+
+    template <typename Solver>
+    inline void afterLift(Solver&, size_t)
+    {
+    }
+};
+
+// The same, and propagates again from every vertex the schedule lifts to top.
+class HybridSeeding : public PropagationSeeding {
+public:
+    static const bool isPropagating = true;
+
+    template <typename Solver>
+    inline void afterLift(Solver& solver, size_t vertex)
+    {
+        if (solver.isTop(vertex)) {
+            solver.lockPredecessorsIfAble(vertex, lockedVertices);
+            solver.lock(vertex, lockedVertices);
+        }
+    }
+};
+
+// ==================
+// schedules
+
+// Sweeps over the vertices in order until a sweep lifts nothing.
+struct Sweep {
+    template <typename Solver, typename Seeding>
+    static void run(Solver& solver, const std::vector<size_t>& vertices, Seeding& seeding)
+    {
+        PAPG_TRACE_PHASE(sweep);
+
+        bool isLifted = true;
+        while (isLifted) {
+            isLifted = false;
+            for (const size_t vertex : vertices) {
+                if (!solver.isTop(vertex) && solver.lift(vertex)) {
+                    seeding.afterLift(solver, vertex);
+                    isLifted = true;
+                }
+            }
+        }
+    }
+};
+
+// Picks vertices at random, until every vertex failed to lift since the last
+// lift that changed anything. The order doesn't matter here.
+struct Random {
+    template <typename Solver, typename Seeding>
+    static void run(Solver& solver, const std::vector<size_t>& vertices, Seeding& seeding)
+    {
+        PAPG_TRACE_PHASE(sweep);
+
+        std::srand(std::time(NULL));
+
+        std::vector<bool> isFinished(vertices.size(), false);
+        size_t numFinishedVertices = 0;
+
+        while (numFinishedVertices != vertices.size()) {
+            const size_t chosen = std::rand() % vertices.size();
+
+            if (!isFinished[chosen]) {
+                const size_t vertex = vertices[chosen];
+                if (solver.isTop(vertex) || !solver.lift(vertex)) { // no change was made
+                    isFinished[chosen] = true;
+                    numFinishedVertices++;
+                } else {
+                    seeding.afterLift(solver, vertex);
+                    std::fill(isFinished.begin(), isFinished.end(), false);
+                    numFinishedVertices = 0;
+                }
+            }
+        }
+    }
+};
+
+// Sweeps over the vertices, recursing on the ones that lifted, until a
+// sweep lifts nothing.
+struct Recursive {
+    template <typename Solver, typename Seeding>
+    static void run(Solver& solver, const std::vector<size_t>& vertices, Seeding& seeding)
+    {
+        PAPG_TRACE_PHASE_OF(Seeding::isPropagating ? LiftPhase::hybrid : LiftPhase::recursive);
+
+        std::vector<size_t> liftedVertices;
+        liftedVertices.reserve(vertices.size());
+
+        while (true) {
+            for (const size_t vertex : vertices) {
+                if (!solver.isTop(vertex) && solver.lift(vertex)) { // a change was made
+                    seeding.afterLift(solver, vertex);
+                    liftedVertices.emplace_back(vertex);
+                }
+            }
+
+            if (liftedVertices.empty()) {
+                // we were unable to lift anything
+                return;
+            }
+
+            // If liftedVertices is the same size as our input, that means we
+            // lifted all our vertices and a recursive call would have the exact
+            // same effect as simply iterating again, therefore only recurse if
+            // this is not the case.
+            if (liftedVertices.size() != vertices.size()) {
+                solver.enterRecursion();
+                run(solver, liftedVertices, seeding);
+                solver.leaveRecursion();
+            }
+
+            liftedVertices.clear();
+        }
+    }
+};
+
+// Lifts the vertices first in first out, starting with all of them in
+// order; a vertex that lifted queues its predecessors among them again, so
+// only vertices with a changed successor are tried.
+struct Worklist {
+    template <typename Solver, typename Seeding>
+    static void run(Solver& solver, const std::vector<size_t>& vertices, Seeding& seeding)
+    {
+        PAPG_TRACE_PHASE(worklist);
+
+        const auto& arena = solver.getArena();
+        VertexSet isMember(arena.getSize());
+        VertexSet isQueued(arena.getSize());
+        std::deque<size_t> queue(vertices.begin(), vertices.end());
+        for (const size_t vertex : vertices) {
+            isMember.insert(vertex);
+            isQueued.insert(vertex);
+        }
+
+        while (!queue.empty()) {
+            const size_t vertex = queue.front();
+            queue.pop_front();
+            isQueued.erase(vertex);
+
+            if (solver.isTop(vertex) || !solver.lift(vertex)) {
+                continue;
+            }
+            seeding.afterLift(solver, vertex);
+
+            for (const size_t predecessor : arena[vertex].incoming) {
+                if (isMember.contains(predecessor) && !isQueued.contains(predecessor) && !solver.isTop(predecessor)) {
+                    isQueued.insert(predecessor);
+                    queue.push_back(predecessor);
+                }
+            }
+        }
+    }
+};
+
+} // PAPG
+
+#endif // LIFTINGPOLICIES_HPP
@@ -0,0 +1,129 @@
+#ifndef MAPPEDARENA_HPP
+#define MAPPEDARENA_HPP
+
+#include "Arena.hpp"
+#include "MappedFile.hpp"
+
+#include <cstdint>
+#include <string>
+
+namespace PAPG {
+
+// Read-only arena in a memory-mapped file, for games that don't fit in
+// memory as an Arena. The edges are kept in compressed sparse row form:
+// per vertex an owner byte, a 32 bit priority and offsets into one array of
+// 32 bit successors and one of predecessors, so the kernel can page any of
+// it in and out as needed. Vertices are handed out as views with the
+// members of Vertex (but no label) that BasicSPMSolver uses.
+//
+// The file is built from a PGSolver game in two passes over it, keeping
+// about 17 bytes per vertex in memory while doing so. Vertex ids are 32 bit.
+class MappedArena {
+public:
+    class Edges {
+    private:
+        const uint32_t* first;
+        const uint32_t* last;
+
+    public:
+        Edges(const uint32_t* first, const uint32_t* last)
+            : first(first)
+            , last(last)
+        {
+        }
+
+        inline const uint32_t* begin() const { return first; }
+        inline const uint32_t* end() const { return last; }
+        inline size_t size() const { return last - first; }
+        inline bool empty() const { return first == last; }
+        inline size_t front() const { return *first; }
+        inline size_t operator[](size_t i) const { return first[i]; }
+    };
+
+    struct VertexView {
+        size_t id;
+        Player owner;
+        size_t priority;
+        Edges incoming;
+        Edges outgoing;
+    };
+
+    class VertexIterator {
+    private:
+        const MappedArena* arena;
+        size_t id;
+
+    public:
+        VertexIterator(const MappedArena* arena, size_t id)
+            : arena(arena)
+            , id(id)
+        {
+        }
+
+        inline VertexView operator*() const { return (*arena)[id]; }
+        inline VertexIterator& operator++()
+        {
+            id++;
+            return *this;
+        }
+        inline bool operator!=(const VertexIterator& other) const { return id != other.id; }
+    };
+
+    struct VertexRange {
+        const MappedArena* arena;
+
+        inline VertexIterator begin() const { return VertexIterator(arena, 0); }
+        inline VertexIterator end() const { return VertexIterator(arena, arena->getSize()); }
+    };
+
+private:
+    MappedFile file;
+
+    size_t numVertices;
+    size_t numEdges;
+    size_t maxPriority;
+
+    const uint8_t* owners;
+    const uint32_t* priorities;
+    const uint64_t* outgoingOffsets; // numVertices + 1 each
+    const uint64_t* incomingOffsets;
+    const uint32_t* outgoingEdges;
+    const uint32_t* incomingEdges;
+
+    explicit MappedArena(MappedFile file);
+
+    static MappedArena build(const std::string& gamePath, bool isTemporary, const std::string& location);
+
+public:
+    // builds the arena file for the PGSolver game at gamePath (which may be
+    // compressed) at arenaPath, and maps it
+    static MappedArena build(const std::string& gamePath, const std::string& arenaPath);
+
+    // the same in a file in directory that is removed right away, so it only lives as long as the arena
+    static MappedArena buildTemporary(const std::string& gamePath, const std::string& directory);
+
+    // maps an arena file built earlier
+    static MappedArena open(const std::string& arenaPath);
+
+    MappedArena(MappedArena&&) = default;
+
+    inline VertexView operator[](size_t id) const
+    {
+        return VertexView{ id, owners[id] ? Player::odd : Player::even, priorities[id],
+            Edges(incomingEdges + incomingOffsets[id], incomingEdges + incomingOffsets[id + 1]),
+            Edges(outgoingEdges + outgoingOffsets[id], outgoingEdges + outgoingOffsets[id + 1]) };
+    }
+    inline VertexRange getVertices() const { return VertexRange{ this }; }
+
+    inline size_t getSize() const { return numVertices; }
+    inline size_t getEdgeCount() const { return numEdges; }
+    inline size_t getMaxPriority() const { return maxPriority; }
+    inline size_t getFileSize() const { return file.getSize(); }
+
+    // hints that the data of vertices [begin, end) and their edges will be needed soon
+    void willNeed(size_t begin, size_t end) const;
+};
+
+} // PAPG
+
+#endif // MAPPEDARENA_HPP
@@ -0,0 +1,55 @@
+#ifndef MAPPEDFILE_HPP
+#define MAPPEDFILE_HPP
+
+#include <cstddef>
+#include <string>
+
+namespace PAPG {
+
+// A file mapped into memory in full, unmapped and closed on destruction.
+// Errors throw std::runtime_error.
+class MappedFile {
+private:
+    int descriptor;
+    char* data;
+    size_t size;
+
+    MappedFile(int descriptor, size_t size, bool isWritable);
+
+public:
+    MappedFile(); // no file
+
+    // creates (or truncates) the file at path with the given size, zero-filled and writable
+    static MappedFile create(const std::string& path, size_t size);
+
+    // like create(), but the file is removed right away and only lives as long as the mapping
+    static MappedFile createTemporary(const std::string& directory, size_t size);
+
+    // Zero-filled POSIX shared memory of the given size, writable. Its name
+    // is removed right away, so it lives as long as the mapping, and only
+    // processes forked after it was made share it.
+    static MappedFile createShared(size_t size);
+
+    // maps the existing file at path, read-only
+    static MappedFile open(const std::string& path);
+
+    MappedFile(MappedFile&& other);
+    MappedFile& operator=(MappedFile&& other);
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+
+    inline char* getData() { return data; }
+    inline const char* getData() const { return data; }
+    inline size_t getSize() const { return size; }
+
+    // madvise() for the pages overlapping [offset, offset + length), a hint so failures are ignored
+    void advise(size_t offset, size_t length, int advice) const;
+
+    // the directory for temporary files when none is given: TMPDIR, or /tmp
+    static std::string getTemporaryDirectory();
+};
+
+} // PAPG
+
+#endif // MAPPEDFILE_HPP
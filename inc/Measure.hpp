@@ -1,9 +1,11 @@
 #ifndef MEASURE_HPP
 #define MEASURE_HPP
 
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
 #include <string>
 #include <vector>
-#include <iostream>
 
 namespace PAPG {
 
@@ -29,6 +31,13 @@ public:
 
 	inline bool isTop() const { return isToppedOut; }
 	inline void makeTop() { isToppedOut = true; }
+	inline void clearTop() { isToppedOut = false; }
+
+	// the value of the i-th odd priority, for stores that keep the values
+	// elsewhere: unlike getValue() and setValue() nothing is checked
+	inline size_t getComponentCount() const { return oddValues.size(); }
+	inline unsigned getComponent(size_t i) const { return oddValues[i]; }
+	inline void setComponent(size_t i, unsigned value) { oddValues[i] = value; }
 
 	Measure & operator=(const Measure & rhs);
 
@@ -49,10 +58,101 @@ public:
 
 	inline size_t getSize() const { return size; }
 
+	size_t getHash() const; // equal measures (e.g. any two top measures) have equal hashes
+	size_t getMemoryUsage() const; // bytes, including the values
+
 	friend std::ostream & operator<<(std::ostream & stream, const Measure & measure);
 
 };
 
+// the operations lifting does all the time, here so they are inlined into it
+
+inline Measure& Measure::operator=(const Measure& rhs)
+{
+    this->oddValues = rhs.oddValues;
+    this->size = rhs.size;
+    this->maxValue = rhs.maxValue;
+    this->isToppedOut = rhs.isToppedOut;
+
+    return *this;
+}
+
+inline bool Measure::operator==(const Measure& rhs) const
+{
+    return (this == &rhs)
+        || (this->isTop() && rhs.isTop()) // if both are top, they are considered equal
+        || (!this->isTop() && !rhs.isTop() // if not both of them are top, neither should be
+               && this->oddValues == rhs.oddValues
+               && this->size == rhs.size);
+}
+
+inline bool Measure::operator!=(const Measure& rhs) const
+{
+    return !(*this == rhs);
+}
+
+inline bool Measure::operator<(const Measure& rhs) const
+{
+    if (rhs.isTop()) {
+        return true;
+    } else if (this->isTop()) {
+        return false;
+    }
+
+    return std::lexicographical_compare(this->oddValues.begin(), this->oddValues.end(), rhs.oddValues.begin(), rhs.oddValues.end());
+}
+
+inline bool Measure::operator>(const Measure& rhs) const
+{
+    if (this->isTop()) {
+        return true;
+    } else if (rhs.isTop()) {
+        return false;
+    }
+
+    return rhs < *this;
+}
+
+inline bool Measure::partialIncrementIfAble(size_t boundary)
+{
+    for (int i = convertIndex(boundary); i >= 0; i--) {
+        if (oddValues[i] < maxValue->oddValues[i]) {
+            // value lower than max, we can incremement it
+            oddValues[i]++;
+            return true;
+        }
+        // value at max, carry into the next more significant value
+        oddValues[i] = 0;
+    }
+
+    return false;
+}
+
+inline void Measure::makePartialEqualOf(size_t boundary, const Measure& other)
+{
+    if (boundary >= size || boundary >= other.size) {
+        throw std::out_of_range("makePartialEqualOf(): Measure boundary out of range!");
+    }
+
+    if (this == &other) {
+        // if this and other are equal it means we are trying to make ourselves equal to ourselves, do nothing and return.
+        return;
+    }
+
+    if (other.isTop()) {
+        makeTop();
+        return;
+    }
+
+    size_t i = 0;
+    for (; i < (boundary + 1) / 2; i++) {
+        oddValues[i] = other.oddValues[i];
+    }
+    for (; i < oddValues.size(); i++) {
+        oddValues[i] = 0;
+    }
+}
+
 } // PAPC
 
 #endif // MEASURE_HPP
@@ -0,0 +1,235 @@
+#ifndef MEASURESTORE_HPP
+#define MEASURESTORE_HPP
+
+#include "MappedFile.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace PAPG {
+
+// Where BasicSPMSolver keeps its measures, one per vertex. The solver reads
+// them through isTop(), get() (into a measure it owns), getPartial() (as
+// Measure::makePartialEqualOf() into one it owns) and isEqual(), so stores
+// that keep records rather than measures never have to make one, and only
+// changes them through set(), which returns whether the measure of the
+// vertex changed. Instantiated in MeasureStore.cpp.
+
+// A plain table with a measure of its own per vertex.
+template <typename MeasureType>
+class FlatMeasureStore {
+private:
+    std::vector<MeasureType> measures;
+
+public:
+    // size vertices, all with the bottom measure of the space of maxMeasure
+    void reset(size_t size, const MeasureType& maxMeasure);
+
+    inline size_t getSize() const { return measures.size(); }
+    inline const MeasureType& operator[](size_t vertex) const { return measures[vertex]; }
+
+    inline bool isTop(size_t vertex) const { return measures[vertex].isTop(); }
+    inline void get(size_t vertex, MeasureType& measure) const { measure = measures[vertex]; }
+    inline void getPartial(size_t vertex, size_t boundary, MeasureType& measure) const { measure.makePartialEqualOf(boundary, measures[vertex]); }
+    inline bool isEqual(size_t vertex, const MeasureType& value) const { return measures[vertex] == value; }
+
+    bool set(size_t vertex, const MeasureType& value);
+
+    size_t getMemoryUsage() const; // bytes, including the measures' own storage
+};
+
+// A deduplicated pool of measure values with a 32 bit handle per vertex, for
+// games where many vertices share few distinct measures. A lift giving a value
+// already in the pool only takes a reference to it, and whether a vertex's
+// measure changed comes down to comparing two handles. Values are reference
+// counted, a handle whose value no vertex holds anymore is reused for the
+// next new value, so the pool never holds more values than vertices.
+template <typename MeasureType>
+class InternedMeasureStore {
+private:
+    std::vector<uint32_t> handles; // per vertex
+    std::deque<MeasureType> values; // per handle, a deque as measures can't be moved around
+    std::vector<uint32_t> references; // per handle, zero for free handles
+    std::vector<uint32_t> freeHandles;
+    std::unordered_multimap<size_t, uint32_t> index; // hash of a value to its handle
+    size_t numValues; // values referenced by at least one vertex
+    size_t maxValues;
+
+    // the handle of value, added to the pool if it isn't in it yet
+    uint32_t intern(const MeasureType& value);
+    void release(uint32_t handle);
+
+public:
+    InternedMeasureStore();
+
+    void reset(size_t size, const MeasureType& maxMeasure);
+
+    inline size_t getSize() const { return handles.size(); }
+    inline const MeasureType& operator[](size_t vertex) const { return values[handles[vertex]]; }
+
+    inline bool isTop(size_t vertex) const { return (*this)[vertex].isTop(); }
+    inline void get(size_t vertex, MeasureType& measure) const { measure = (*this)[vertex]; }
+    inline void getPartial(size_t vertex, size_t boundary, MeasureType& measure) const { measure.makePartialEqualOf(boundary, (*this)[vertex]); }
+    inline bool isEqual(size_t vertex, const MeasureType& value) const { return (*this)[vertex] == value; }
+
+    bool set(size_t vertex, const MeasureType& value);
+
+    size_t getMemoryUsage() const; // bytes, including the values' own storage and the index
+
+    inline size_t getDistinctCount() const { return numValues; }
+    inline size_t getMaxDistinctCount() const { return maxValues; } // since the last reset()
+};
+
+// The measures as fixed-size records in a memory-mapped temporary file, for
+// games whose measure table doesn't fit in memory: a top flag and a 32 bit
+// value per odd priority. Measures are decoded from their record into the
+// caller's and compared to it in place. The solver keeps its other tables per
+// vertex in such files too, see VertexTableOf. Only for Measure.
+template <typename MeasureType>
+class MappedMeasureStore {
+private:
+    std::string directory;
+    MappedFile file;
+    const MeasureType* maxMeasure;
+    size_t numVertices;
+    size_t numComponents;
+
+    inline size_t getRecordSize() const { return (1 + numComponents) * sizeof(uint32_t); }
+    inline uint32_t* getRecord(size_t vertex) { return reinterpret_cast<uint32_t*>(file.getData() + vertex * getRecordSize()); }
+    inline const uint32_t* getRecord(size_t vertex) const { return reinterpret_cast<const uint32_t*>(file.getData() + vertex * getRecordSize()); }
+
+public:
+    MappedMeasureStore();
+
+    // where the file is made on reset(), MappedFile::getTemporaryDirectory() by default
+    inline void setDirectory(const std::string& newDirectory) { directory = newDirectory; }
+    inline const std::string& getDirectory() const { return directory; }
+
+    void reset(size_t size, const MeasureType& maxMeasure);
+
+    inline size_t getSize() const { return numVertices; }
+
+    inline bool isTop(size_t vertex) const { return getRecord(vertex)[0] != 0; }
+    void get(size_t vertex, MeasureType& measure) const;
+    void getPartial(size_t vertex, size_t boundary, MeasureType& measure) const;
+    bool isEqual(size_t vertex, const MeasureType& value) const;
+
+    bool set(size_t vertex, const MeasureType& value);
+
+    inline size_t getMemoryUsage() const { return file.getSize(); } // of the file, how much of it is in memory is up to the kernel
+
+    // hints that the measures of vertices [begin, end) will be needed soon
+    void willNeed(size_t begin, size_t end) const;
+};
+
+// The measures as fixed-size records in POSIX shared memory, for the worker
+// processes of ShardedSolver, which are forked after reset() and so all see
+// the same table. Every vertex is written by one process only, but read by
+// the others while it may be writing, so a record starts with a sequence
+// number that is odd during a write: readers retry until they read the same
+// even number before and after the values (a seqlock). Then a top flag and a
+// 32 bit value per odd priority, as in MappedMeasureStore. Like there, reads
+// decode into or compare with the caller's measure, which is why a retry
+// costs nothing but the reading. Only for Measure.
+template <typename MeasureType>
+class SharedMeasureStore {
+private:
+    MappedFile memory;
+    const MeasureType* maxMeasure;
+    size_t numVertices;
+    size_t numComponents;
+
+    inline size_t getRecordSize() const { return 2 + numComponents; } // in words
+    inline std::atomic<uint32_t>* getRecord(size_t vertex) { return reinterpret_cast<std::atomic<uint32_t>*>(memory.getData()) + vertex * getRecordSize(); }
+    inline const std::atomic<uint32_t>* getRecord(size_t vertex) const
+    {
+        return reinterpret_cast<const std::atomic<uint32_t>*>(memory.getData()) + vertex * getRecordSize();
+    }
+
+    // the sequence number of record once no write is under way
+    inline static uint32_t beginRead(const std::atomic<uint32_t>* record)
+    {
+        uint32_t sequence;
+        while ((sequence = record[0].load(std::memory_order_acquire)) % 2) {
+        }
+        return sequence;
+    }
+    // whether what was read of record since beginRead() gave sequence is of one write
+    inline static bool isReadValid(const std::atomic<uint32_t>* record, uint32_t sequence)
+    {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return record[0].load(std::memory_order_relaxed) == sequence;
+    }
+
+public:
+    SharedMeasureStore();
+
+    void reset(size_t size, const MeasureType& maxMeasure);
+
+    inline size_t getSize() const { return numVertices; }
+
+    // a single word, which a write sets only once the record is top
+    inline bool isTop(size_t vertex) const { return getRecord(vertex)[1].load(std::memory_order_acquire) != 0; }
+    void get(size_t vertex, MeasureType& measure) const;
+    void getPartial(size_t vertex, size_t boundary, MeasureType& measure) const;
+    bool isEqual(size_t vertex, const MeasureType& value) const;
+
+    // only from the process that owns vertex
+    bool set(size_t vertex, const MeasureType& value);
+
+    inline size_t getMemoryUsage() const { return memory.getSize(); }
+};
+
+// A table of trivially copyable values in a memory-mapped temporary file,
+// for what BasicSPMSolver keeps per vertex besides the measures of a
+// MappedMeasureStore, so none of it has to stay in memory either.
+template <typename T>
+class MappedTable {
+private:
+    MappedFile file;
+    size_t size;
+
+public:
+    MappedTable()
+        : file()
+        , size(0)
+    {
+    }
+
+    // newSize values, each value, in a new file in directory
+    void assign(size_t newSize, const T& value, const std::string& directory)
+    {
+        file = MappedFile();
+        file = MappedFile::createTemporary(directory, newSize * sizeof(T));
+        size = newSize;
+        if (size > 0 && value != T()) { // a new file reads as zeroes
+            std::fill(&(*this)[0], &(*this)[0] + size, value);
+        }
+    }
+
+    inline size_t getSize() const { return size; }
+    inline T& operator[](size_t i) { return reinterpret_cast<T*>(file.getData())[i]; }
+    inline const T& operator[](size_t i) const { return reinterpret_cast<const T*>(file.getData())[i]; }
+};
+
+// The type of the tables BasicSPMSolver keeps per vertex next to a store:
+// in memory, but mapped like the measures for MappedMeasureStore.
+template <typename StoreType, typename T>
+struct VertexTableOf {
+    typedef std::vector<T> type;
+};
+
+template <typename MeasureType, typename T>
+struct VertexTableOf<MappedMeasureStore<MeasureType>, T> {
+    typedef MappedTable<T> type;
+};
+
+} // PAPG
+
+#endif // MEASURESTORE_HPP
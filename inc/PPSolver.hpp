@@ -0,0 +1,71 @@
+#ifndef PPSOLVER_HPP
+#define PPSOLVER_HPP
+
+#include "Arena.hpp"
+#include "Attractor.hpp"
+#include "SolveControl.hpp"
+#include "VertexSet.hpp"
+
+#include <vector>
+
+namespace PAPG {
+
+// Priority promotion (Benerecetti, Dell'Erba & Mogavero). Searches for a
+// dominion by computing attractor regions top-down from the most significant
+// priority, promoting closed regions to the region their opponent escapes
+// to. Dominions that are found are attracted and removed from the game,
+// after which the search restarts on what is left.
+class PPSolver {
+public:
+    enum class Variant {
+        priorityPromotion, // PP: a promotion resets all regions below the target
+        priorityPromotionPlus, // PP+: a promotion only resets the opponent's regions below the target
+        regionRecovery // RR: nothing is reset on promotion, regions that became invalid are recovered when revisited
+    };
+
+private:
+    const Arena* arena;
+
+    Attractor attractor;
+
+    std::vector<size_t> region; // region priority of each vertex
+    std::vector<size_t> strategy; // successor chosen by the owner of a region, for that owner's vertices
+
+    SolveControl* control;
+
+    unsigned numPromotions;
+    unsigned numResets;
+    unsigned numRecoveries;
+    unsigned numDominions;
+
+    std::vector<Player> solve(Variant variant);
+
+    // finds a dominion in game and returns it, winner is set to the player winning it
+    VertexSet searchDominion(const VertexSet& game, Variant variant, Player& winner);
+
+    // whether the seeds of a region that was kept from before can be reused
+    bool isRecoverable(const VertexSet& subgame, const VertexSet& seeds, Player player) const;
+
+public:
+    explicit PPSolver(const Arena& arena);
+
+    // starts over on another arena, keeping the workspace's storage
+    void reset(const Arena& newArena);
+
+    // checked before every attractor computation of the search, may be nullptr
+    inline void setControl(SolveControl* newControl) { control = newControl; }
+
+    std::vector<Player> solvePriorityPromotion();
+    std::vector<Player> solvePriorityPromotionPlus();
+    std::vector<Player> solveRegionRecovery();
+
+    inline unsigned getPromotionCount() const { return numPromotions; }
+    inline unsigned getResetCount() const { return numResets; }
+    inline unsigned getRecoveryCount() const { return numRecoveries; }
+    inline unsigned getDominionCount() const { return numDominions; }
+    inline unsigned getAttractorCount() const { return attractor.getComputationCount(); }
+};
+
+} // PAPG
+
+#endif // PPSOLVER_HPP
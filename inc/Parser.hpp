@@ -1,14 +1,18 @@
 #ifndef PARSER_HPP
 #define PARSER_HPP
 
+#include <istream>
 #include <string>
 #include "Arena.hpp"
 
 namespace PAPG {
 namespace Parser {
 
+    // parses the PGSolver game at path, which may be gzip, bzip2 or xz compressed
     Arena parse(std::string path);
 
+    Arena parse(std::istream& file);
+
 } // Parser
 
 } // PAPC
@@ -0,0 +1,47 @@
+#ifndef PERFCOUNTERS_HPP
+#define PERFCOUNTERS_HPP
+
+#include "Strategies.hpp"
+
+#include <string>
+#include <vector>
+
+namespace PAPG {
+
+// Hardware and kernel counters of the calling thread, and of the threads it
+// starts while counting, through perf_event_open(): cycles, instructions,
+// cache misses, branch misses and page faults. Counters the kernel or the
+// hardware doesn't give (as in many virtual machines and containers, or with
+// a strict kernel.perf_event_paranoid) are left out, so on some systems only
+// some or none of them are available. Only user space is counted. Counts the
+// kernel had to multiplex are scaled up to the full time.
+class PerfCounters {
+private:
+    struct Event {
+        std::string name;
+        int descriptor;
+    };
+
+    std::vector<Event> events;
+    std::string error; // why the first counter that couldn't be opened couldn't
+
+public:
+    PerfCounters(); // opens every counter it can
+    ~PerfCounters();
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    inline bool isAvailable() const { return !events.empty(); }
+    inline bool isComplete() const { return error.empty(); } // all counters are available
+    inline const std::string& getError() const { return error; }
+
+    // resets the counters and starts counting
+    void start();
+
+    // stops counting and adds the counts since start() to counters
+    void stop(Counters& counters);
+};
+
+} // PAPG
+
+#endif // PERFCOUNTERS_HPP
@@ -0,0 +1,59 @@
+#ifndef PREPROCESSOR_HPP
+#define PREPROCESSOR_HPP
+
+#include "Arena.hpp"
+#include "VertexSet.hpp"
+
+#include <vector>
+
+namespace PAPG {
+
+// Decides the trivial part of a game before any solver runs on it. A vertex
+// with a self-loop and a priority of its owner's parity is won by its owner
+// (it just keeps taking the loop), as is a vertex whose only move is its
+// self-loop by the player of its priority. These self-loop dominions are
+// extended to their attractors and removed, repeating until nothing changes.
+// What remains is a subgame, given as a renumbered residual arena, whose
+// winners are those of the full game, so any solver can be run on it and its
+// results merged back.
+class Preprocessor {
+private:
+    const Arena& arena;
+
+    std::vector<Player> winners; // only valid for decided vertices
+    std::vector<size_t> strategy; // for decided vertices won by their owner, the successor that keeps them winning
+    VertexSet decided;
+
+    Arena residual;
+    std::vector<size_t> originalIds; // per residual vertex, its id in arena
+
+    unsigned numDominions;
+
+    bool isSelfLoopDominion(const VertexSet& game, size_t id, Player player) const;
+
+    void buildResidual();
+
+public:
+    explicit Preprocessor(const Arena& arena);
+
+    void run();
+
+    inline const Arena& getResidualArena() const { return residual; }
+
+    // combines the winners of the residual arena with the decided vertices,
+    // giving the winners of the full arena
+    std::vector<Player> mergeResults(const std::vector<Player>& residualResults) const;
+
+    // Same for a winning strategy on the residual arena, given as a successor
+    // per vertex. Entries that are no residual vertex id (like a "no
+    // successor" marker) are kept as they are, decided vertices not won by
+    // their owner get std::numeric_limits<size_t>::max().
+    std::vector<size_t> mergeStrategy(const std::vector<size_t>& residualStrategy) const;
+
+    inline size_t getRemovedCount() const { return arena.getSize() - residual.getSize(); }
+    inline unsigned getDominionCount() const { return numDominions; }
+};
+
+} // PAPG
+
+#endif // PREPROCESSOR_HPP
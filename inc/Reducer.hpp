@@ -0,0 +1,60 @@
+#ifndef REDUCER_HPP
+#define REDUCER_HPP
+
+#include "Arena.hpp"
+
+#include <vector>
+
+namespace PAPG {
+
+// Shrinks a game to a smaller one with the same winners, in two steps.
+// Chains of vertices, where every vertex but the last has a single move, to
+// the next one, which has no other predecessor, are collapsed into their last
+// vertex with the lowest priority on the chain: a play that passes one vertex
+// of a chain passes all of them. Then vertices with the same owner and
+// priority whose successors fall into the same classes are merged, refining
+// the classes until that holds for all of them (a bisimulation quotient), as
+// bisimilar vertices have the same winner. The solver is run on the reduced
+// arena and expandResults() maps its winners back.
+class Reducer {
+private:
+    const Arena& arena;
+
+    Arena reduced;
+    std::vector<size_t> reducedIds; // per arena vertex, the vertex of reduced it was merged into
+
+    size_t numChainVertices;
+    unsigned numRounds;
+    bool isRefined;
+
+    // The tail of every vertex's chain (the vertex itself if it is on none)
+    // and the lowest priority on each chain, at its tail.
+    void compressChains(std::vector<size_t>& tails, std::vector<size_t>& priorities);
+
+    // Splits the classes of the given tails until the successors of every
+    // tail in a class are in the same classes. Gives up and leaves every tail
+    // in a class of its own if they aren't stable after maxRounds.
+    void refine(const std::vector<size_t>& tails, const std::vector<size_t>& priorities, std::vector<size_t>& classes);
+
+public:
+    explicit Reducer(const Arena& arena);
+
+    void run();
+
+    inline const Arena& getReducedArena() const { return reduced; }
+
+    // the winners of the full arena from those of the reduced arena
+    std::vector<Player> expandResults(const std::vector<Player>& reducedResults) const;
+
+    inline size_t getRemovedCount() const { return arena.getSize() - reduced.getSize(); }
+    // vertices collapsed into the tail of their chain
+    inline size_t getChainVertexCount() const { return numChainVertices; }
+    // rounds of refinement until the classes were stable, or until it gave up
+    inline unsigned getRoundCount() const { return numRounds; }
+    // false if refinement gave up and only the chains were collapsed
+    inline bool isQuotient() const { return isRefined; }
+};
+
+} // PAPG
+
+#endif // REDUCER_HPP
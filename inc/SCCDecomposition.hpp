@@ -0,0 +1,149 @@
+#ifndef SCCDECOMPOSITION_HPP
+#define SCCDECOMPOSITION_HPP
+
+#include "Arena.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+namespace PAPG {
+
+// Strongly connected components of (parts of) an Arena or MappedArena, using
+// an iterative version of Tarjan's algorithm so large games don't overflow
+// the stack. Keeps its workspace between decompositions, not thread-safe.
+// Instantiated for both arena types in SCCDecomposition.cpp.
+template <typename ArenaType>
+class BasicSCCDecomposition {
+private:
+    struct Frame {
+        size_t vertex;
+        size_t nextEdge;
+    };
+
+    const ArenaType* arena;
+
+    std::vector<size_t> index;
+    std::vector<size_t> lowlink;
+    std::vector<unsigned> stamps; // index and lowlink are only valid where stamps matches generation
+    std::vector<bool> onStack;
+    unsigned generation;
+
+    std::vector<size_t> stack;
+    std::vector<Frame> callStack;
+
+    void nextGeneration();
+
+public:
+    explicit BasicSCCDecomposition(const ArenaType& arena);
+
+    // starts over on another arena, keeping the workspace's storage
+    void reset(const ArenaType& newArena);
+
+    // Decomposes the subgraph induced by the vertices for which isMember(id)
+    // holds, following only the edges for which followEdge(from, to) holds.
+    // Only vertices reachable from roots are visited. Components are returned
+    // in reverse topological order, i.e. bottom components first.
+    template <typename IsMember, typename FollowEdge>
+    std::vector<std::vector<size_t> > decompose(const std::vector<size_t>& roots, IsMember isMember, FollowEdge followEdge);
+
+    // The same without collecting the components: onComponent(first, last)
+    // gets each one as a range of vertex ids, in the same order. The range is
+    // only valid during the call.
+    template <typename IsMember, typename FollowEdge, typename OnComponent>
+    void forEachComponent(const std::vector<size_t>& roots, IsMember isMember, FollowEdge followEdge, OnComponent onComponent);
+
+    // whether the given component contains a cycle under followEdge, i.e.
+    // it has more than one vertex or its only vertex has a self-loop
+    template <typename FollowEdge>
+    bool isNontrivial(const std::vector<size_t>& component, FollowEdge followEdge) const
+    {
+        if (component.size() > 1) {
+            return true;
+        }
+        const size_t id = component.front();
+        const auto& outgoing = (*arena)[id].outgoing;
+        return std::find_if(outgoing.begin(), outgoing.end(), [&](size_t successor) {
+            return successor == id && followEdge(id, id);
+        }) != outgoing.end();
+    }
+};
+
+template <typename ArenaType>
+template <typename IsMember, typename FollowEdge>
+std::vector<std::vector<size_t> > BasicSCCDecomposition<ArenaType>::decompose(const std::vector<size_t>& roots, IsMember isMember, FollowEdge followEdge)
+{
+    std::vector<std::vector<size_t> > components;
+    forEachComponent(roots, isMember, followEdge, [&components](const size_t* first, const size_t* last) {
+        // in the order they were popped, as always
+        components.emplace_back(std::make_reverse_iterator(last), std::make_reverse_iterator(first));
+    });
+    return components;
+}
+
+template <typename ArenaType>
+template <typename IsMember, typename FollowEdge, typename OnComponent>
+void BasicSCCDecomposition<ArenaType>::forEachComponent(const std::vector<size_t>& roots, IsMember isMember, FollowEdge followEdge, OnComponent onComponent)
+{
+    nextGeneration();
+
+    size_t counter = 0;
+
+    for (const size_t root : roots) {
+        if (stamps[root] == generation || !isMember(root)) {
+            continue;
+        }
+
+        stamps[root] = generation;
+        index[root] = lowlink[root] = counter++;
+        stack.push_back(root);
+        onStack[root] = true;
+        callStack.push_back(Frame{ root, 0 });
+
+        while (!callStack.empty()) {
+            const size_t vertex = callStack.back().vertex;
+            const auto& outgoing = (*arena)[vertex].outgoing;
+
+            if (callStack.back().nextEdge < outgoing.size()) {
+                const size_t successor = outgoing[callStack.back().nextEdge++];
+
+                if (!isMember(successor) || !followEdge(vertex, successor)) {
+                    continue;
+                }
+
+                if (stamps[successor] != generation) {
+                    // not visited yet, descend
+                    stamps[successor] = generation;
+                    index[successor] = lowlink[successor] = counter++;
+                    stack.push_back(successor);
+                    onStack[successor] = true;
+                    callStack.push_back(Frame{ successor, 0 });
+                } else if (onStack[successor]) {
+                    lowlink[vertex] = std::min(lowlink[vertex], index[successor]);
+                }
+            } else {
+                if (lowlink[vertex] == index[vertex]) {
+                    // vertex is the root of a component, everything above it on the stack belongs to it
+                    size_t first = stack.size();
+                    do {
+                        onStack[stack[--first]] = false;
+                    } while (stack[first] != vertex);
+                    onComponent(stack.data() + first, stack.data() + stack.size());
+                    stack.resize(first);
+                }
+
+                callStack.pop_back();
+                if (!callStack.empty()) {
+                    const size_t parent = callStack.back().vertex;
+                    lowlink[parent] = std::min(lowlink[parent], lowlink[vertex]);
+                }
+            }
+        }
+    }
+}
+
+typedef BasicSCCDecomposition<Arena> SCCDecomposition;
+
+} // PAPG
+
+#endif // SCCDECOMPOSITION_HPP
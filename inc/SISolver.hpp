@@ -0,0 +1,80 @@
+#ifndef SISOLVER_HPP
+#define SISOLVER_HPP
+
+#include "Arena.hpp"
+#include "SolveControl.hpp"
+
+#include <vector>
+
+namespace PAPG {
+
+// Strategy improvement. Odd improves a positional strategy, which is
+// evaluated by solving the one-player game it leaves for Even: vertices Even
+// loses in it go to top directly, the rest are lifted to the least progress
+// measure of that game. Odd then switches to successors that are profitable
+// under these measures, until there are none left and the measures are the
+// least progress measure of the whole game.
+//
+// Evaluation rounds and the scan for profitable switches are spread over all
+// cores once there is enough work. Even's winning strategy follows from the
+// final measures, odd's from doing the same on the dual game (priorities
+// shifted by one and owners swapped).
+class SISolver {
+public:
+    enum class SwitchingRule {
+        allProfitable, // every vertex with a profitable successor switches, to the first one
+        locallyOptimal // every vertex with a profitable successor switches, to the most profitable one
+    };
+
+    static const size_t noSuccessor;
+
+private:
+    const Arena* arena;
+
+    unsigned maxThreads;
+    size_t parallelThreshold; // minimum number of vertices in a round worth spreading over threads
+
+    SolveControl* control;
+
+    std::vector<size_t> strategy;
+
+    unsigned numIterations;
+    unsigned numSwitches;
+    unsigned numRounds;
+    unsigned long long numLifts;
+
+    // Runs strategy improvement for odd on game, returns the winners and sets
+    // evenStrategy for the vertices won by even that even owns.
+    std::vector<Player> improve(const Arena& game, SwitchingRule rule, std::vector<size_t>& evenStrategy);
+
+    std::vector<Player> solve(SwitchingRule rule);
+
+public:
+    explicit SISolver(const Arena& arena);
+
+    // starts over on another arena, keeping the strategy's storage (the
+    // evaluation state is made per solve, for the game and its dual)
+    void reset(const Arena& newArena);
+
+    std::vector<Player> solveAllProfitable();
+    std::vector<Player> solveLocallyOptimal();
+
+    // After solving: for every vertex won by its owner the successor the
+    // owner's winning strategy picks, noSuccessor for all other vertices.
+    inline const std::vector<size_t>& getWinningStrategy() const { return strategy; }
+
+    inline void setMaxThreads(unsigned threads) { maxThreads = threads ? threads : 1; }
+    inline void setParallelThreshold(size_t threshold) { parallelThreshold = threshold; }
+
+    // checked every evaluation round, may be nullptr
+    inline void setControl(SolveControl* newControl) { control = newControl; }
+
+    inline unsigned getIterationCount() const { return numIterations; }
+    inline unsigned getSwitchCount() const { return numSwitches; }
+    inline unsigned getRoundCount() const { return numRounds; }
+    inline unsigned long long getLiftCount() const { return numLifts; }
+};
+
+} // PAPG
+
+#endif // SISOLVER_HPP
@@ -2,64 +2,205 @@
 #define SOLVER_HPP
 
 #include "Arena.hpp"
+#include "LiftingPolicies.hpp"
+#include "MappedArena.hpp"
 #include "Measure.hpp"
-
+#include "MeasureStore.hpp"
+#include "SolveControl.hpp"
+#include "SuccinctMeasure.hpp"
+#include "VertexSet.hpp"
+
+#include <deque>
+#include <memory>
+#include <numeric>
 #include <vector>
 
 namespace PAPG {
 
-class SPMSolver {
+// The max measures of a game that BasicSPMSolver::prog() increments against:
+// the one of the whole measure space and, for Measure, tighter ones per
+// region of the game (see makeRegionMaxMeasures() in SPMSolver.cpp), vertices
+// with the same bounds sharing one. Measures point at their max measure, so
+// these stay where they are for as long as a solver holds them. They only
+// depend on the game, so the solvers of one game can share them (see
+// Workspace::getShared()). Instantiated for the measure and arena types of
+// BasicSPMSolver in SPMSolver.cpp.
+template <typename MeasureType>
+class MaxMeasures {
 private:
-    const Arena& arena;
+    const MeasureType maxMeasure;
+    std::deque<MeasureType> regionMaxMeasures;
+    std::vector<const MeasureType*> maxMeasureOf; // empty without region bounds, e.g. for games too big to work them out
 
-    std::vector<Measure> measures;
-    const Measure maxMeasure;
+public:
+    template <typename ArenaType>
+    explicit MaxMeasures(const ArenaType& arena);
+    MaxMeasures(const MaxMeasures&) = delete;
+    MaxMeasures& operator=(const MaxMeasures&) = delete;
+
+    inline const MeasureType& get() const { return maxMeasure; }
+    inline const MeasureType& getOf(const size_t vertex) const { return maxMeasureOf.empty() ? maxMeasure : *maxMeasureOf[vertex]; }
+    inline size_t getRegionCount() const { return regionMaxMeasures.size(); }
+};
 
-    unsigned numLifts;
+// Small progress measures lifting, with the lifting strategies below, each
+// a combination of the policies in LiftingPolicies.hpp (see solveWith()). The
+// measure type decides the measure space: Measure gives the classic
+// (Jurdzinski) progress measures, SuccinctMeasure the succinct
+// (Jurdzinski-Lazic) ones. The store type decides how the measures are kept,
+// see MeasureStore.hpp, and the arena type is Arena or MappedArena.
+// Instantiated for both measure types with the flat store, and for Measure
+// with the interned store, with the mapped store on a mapped arena and with
+// the shared store (for ShardedSolver), in SPMSolver.cpp.
+template <typename MeasureType, typename StoreType = FlatMeasureStore<MeasureType>, typename ArenaType = Arena>
+class BasicSPMSolver {
+private:
+    // per vertex, in memory or next to the measures, see VertexTableOf
+    template <typename T>
+    using VertexTable = typename VertexTableOf<StoreType, T>::type;
+
+    const ArenaType* arena;
+
+    StoreType measures;
+    std::shared_ptr<const MaxMeasures<MeasureType> > maxMeasures;
+
+    // the measures lift() works in, kept so their storage is reused
+    MeasureType liftResult;
+    MeasureType liftCandidate;
+
+    // Measures only ever go up, which lift() uses to avoid recomputing prog
+    // for every successor. Per vertex it keeps the successor that decided its
+    // measure in the last lift (its witness, noWitness if it was never
+    // lifted) and how many measure changes there had been by then; every
+    // change of a measure is numbered, changedAt keeping the last one per
+    // vertex. For even's vertices the minimum can only move if the witness
+    // changed, for odd's the maximum only by the successors that changed.
+    static const size_t noWitness;
+    VertexTable<size_t> witnesses;
+    VertexTable<unsigned long long> seenChanges;
+    VertexTable<unsigned long long> changedAt;
+    unsigned long long numChanges;
+
+    unsigned long long numLifts;
+    unsigned long long numRescansAvoided; // lifts that didn't need prog of every successor
     unsigned maxRecursionDepth;
+    unsigned recursionDepth;
+    size_t numTop; // vertices with a top measure
 
-    Measure makeMaxMeasure() const;
+    VertexSet locked; // the vertices in the lockedVertices of the propagation strategies, for lookups, empty until they run
 
-    void initializeMeasures();
+    SolveControl* control;
 
     std::vector<Player> getResult() const;
 
+    // hands a copy of the measures to checkpointer, unless it is still writing the last one
+    void writeCheckpoint(Checkpointer& checkpointer);
+    // sets the measures to those of the checkpoint checkpointer loaded, if any
+    void restoreCheckpoint(Checkpointer& checkpointer);
+
+    Progress getProgress() const;
+
 
 public:
-    explicit SPMSolver(const Arena& arena);
+    typedef MaxMeasures<MeasureType> MaxMeasuresType;
+
+    // with the max measures of arena if they were worked out already, otherwise it does that itself
+    explicit BasicSPMSolver(const ArenaType& arena, std::shared_ptr<const MaxMeasuresType> sharedMaxMeasures = nullptr);
+    BasicSPMSolver(const BasicSPMSolver&) = delete; // the measures point at maxMeasures
+    BasicSPMSolver& operator=(const BasicSPMSolver&) = delete;
+
+    // starts over on another arena, as a new solver would but keeping the
+    // storage of the tables, which initializeMeasures() then refills
+    void reset(const ArenaType& newArena, std::shared_ptr<const MaxMeasuresType> sharedMaxMeasures = nullptr);
 
-    Measure prog(const size_t fromVertex, const size_t toVertex) const;
+    // sets every measure to bottom and forgets all witnesses, as every solve
+    // function does first, or to the measures of the checkpoint to resume
+    // from if the control has one
+    void initializeMeasures();
+
+    MeasureType prog(const size_t fromVertex, const size_t toVertex) const;
+    void prog(const size_t fromVertex, const size_t toVertex, MeasureType& result) const; // without allocating, if result has the storage
 
     bool lift(const size_t vertex);
     
-    inline unsigned getLiftCount() const { return numLifts; }
+    // checked every SolveControl::checkInterval lifts, may be nullptr
+    inline void setControl(SolveControl* newControl) { control = newControl; }
+
+    inline unsigned long long getLiftCount() const { return numLifts; }
     inline void resetLiftCount() { numLifts = 0; }
+    inline unsigned long long getRescansAvoidedCount() const { return numRescansAvoided; }
+    inline size_t getRegionMaxMeasureCount() const { return maxMeasures->getRegionCount(); }
+    inline const StoreType& getMeasureStore() const { return measures; }
+    inline StoreType& getMeasureStore() { return measures; }
+
+    // Lifts every vertex to its least fixed point with the given policies:
+    // the vertices are put in Order, Seeding settles what it can, and
+    // Schedule lifts the rest, calling back into the public functions below.
+    template <typename Order, typename Schedule, typename Seeding = NoSeeding>
+    std::vector<Player> solveWith()
+    {
+        initializeMeasures(); // set all measures to (0,..,0)
+
+        std::vector<size_t> vertices(arena->getSize());
+        std::iota(vertices.begin(), vertices.end(), 0);
+        Order::sort(*arena, vertices);
+
+        Seeding seeding;
+        seeding.seed(*this, vertices);
+        Schedule::run(*this, vertices, seeding);
+
+        return getResult(); // get results from measures table
+    }
 
     std::vector<Player> solveInputOrder();
     std::vector<Player> solveRandomOrder();
     std::vector<Player> solvePriorityOrder();
     std::vector<Player> solveIncomingOrder();
+    std::vector<Player> solveWorklist();
 
+    // Worklist on blocks of blockSize consecutive vertices at a time, for
+    // mapped arenas and stores: lifts a block's queued vertices as far as they
+    // go, then moves on to the next block with vertices queued by a change.
+    std::vector<Player> solveBlockOrder(size_t blockSize);
 
-    void liftRecursive(const std::vector<size_t> & subset);
     std::vector<Player> solveRecursive();
     std::vector<Player> solveRecursivePriorityOrder();
     std::vector<Player> solveRecursiveIncomingOrder();
 
-
-    bool checkForSelfLoop(const Vertex & vertex) const;
-    void lockPredecessorsIfAble(const size_t vertex, std::vector<size_t> & lockedVertices);
     std::vector<Player> solvePropagation();
-
-    void liftPropagationRecursiveHybrid(std::vector<size_t> & subset, std::vector<size_t> & lockedVertices);
     std::vector<Player> solvePropagationRecursiveHybrid();
+    std::vector<Player> solvePropagationWorklist();
 
-    inline unsigned getMaxRecursionDepth() const { return maxRecursionDepth; }
-    inline void resetMaxRecursionDepth() { maxRecursionDepth = 0; }
+    // for the policies
+
+    inline const ArenaType& getArena() const { return *arena; }
+    inline bool isTop(const size_t vertex) const { return measures.isTop(vertex); }
 
+    // around a recursive call of a schedule, for the recursion depth
+    inline void enterRecursion() { maxRecursionDepth = std::max(maxRecursionDepth, ++recursionDepth); }
+    inline void leaveRecursion() { recursionDepth--; }
 
+    // for a measure that changed other than by lift(), e.g. in another process
+    // sharing the store, so lift() doesn't take its old value for granted
+    inline void noteChanged(const size_t vertex) { changedAt[vertex] = ++numChanges; }
+
+    bool checkForSelfLoop(const size_t vertex) const;
+    inline bool isLocked(const size_t vertex) const { return locked.contains(vertex); }
+    // adds vertex to lockedVertices, unless it is already locked
+    void lock(const size_t vertex, std::vector<size_t> & lockedVertices);
+    void lockPredecessorsIfAble(const size_t vertex, std::vector<size_t> & lockedVertices);
+    std::vector<size_t> lockSelfLoopVertices(); // seeds of the propagation strategies, locked with all they propagate to
+
+    inline unsigned getMaxRecursionDepth() const { return maxRecursionDepth; }
+    inline void resetMaxRecursionDepth() { maxRecursionDepth = 0; }
 };
 
+typedef BasicSPMSolver<Measure> SPMSolver;
+typedef BasicSPMSolver<SuccinctMeasure> SuccinctSPMSolver;
+typedef BasicSPMSolver<Measure, InternedMeasureStore<Measure> > InternedSPMSolver;
+typedef BasicSPMSolver<Measure, MappedMeasureStore<Measure>, MappedArena> MappedSPMSolver;
+typedef BasicSPMSolver<Measure, SharedMeasureStore<Measure> > SharedSPMSolver;
+
 } // PAPG
 
 #endif // SOLVER_HPP
@@ -0,0 +1,104 @@
+#ifndef SERVER_HPP
+#define SERVER_HPP
+
+#include "papg.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace PAPG {
+
+// Long-running solver for papg serve. Reads solve requests from a connection
+// and answers each with the winners and counters, see the protocol below.
+// Connections on a Unix domain socket are handled by a fixed pool of worker
+// threads. Every worker keeps its solvers (one per strategy asked for, each
+// with its engine's tables and its result buffers, see PAPG::Workspace in
+// Strategies.hpp) and its request and response buffers between requests and
+// connections, so these are only allocated again for larger games.
+//
+// Request: a line "<format> <length> <strategy or engine name>" followed by
+// length bytes of arena, the format being text (PGSolver) or binary:
+//   u32 number of vertices, then per vertex
+//   u8 owner (0 even, 1 odd), u32 priority, u32 number of successors,
+//   u32 per successor
+// all little-endian. "quit" ends the connection, as does the end of input.
+//
+// Response: "ok <vertices> <solve time in µS> <number of counters>", a line
+// "<name>=<value>" per counter and a line with the winner of every vertex as
+// a '0' (even) or '1' (odd) per vertex. Or on failure a single line
+// "error <message>", after which the connection is closed if the request
+// couldn't be read. Requests longer than Options::maxRequestSize are refused
+// before anything is allocated for them.
+class Server {
+public:
+    struct Options {
+        unsigned numThreads = 0; // zero for one per hardware thread
+        bool isPreprocessing = true;
+        double timeLimit = 0; // seconds, zero for no limit
+        unsigned long long liftBudget = 0;
+        size_t maxRequestSize = size_t(1) << 30; // bytes of arena
+    };
+
+private:
+    struct Connection;
+
+    // what a worker keeps between requests and connections
+    struct WorkerState {
+        std::map<std::string, papg_solver*> solvers;
+        std::vector<char> request;
+        std::string response;
+
+        // binary arenas, decoded into the arrays papg_arena_create() takes
+        std::vector<uint8_t> owners;
+        std::vector<uint32_t> priorities;
+        std::vector<size_t> successorOffsets;
+        std::vector<size_t> successors;
+
+        WorkerState() = default;
+        ~WorkerState();
+        WorkerState(const WorkerState&) = delete;
+        WorkerState& operator=(const WorkerState&) = delete;
+    };
+
+    const Options options;
+
+    std::atomic<bool> isStopping;
+
+    std::deque<int> pending; // accepted connections not yet taken by a worker
+    std::set<int> active; // connections being handled, shut down when stopping
+    std::mutex mutex;
+    std::condition_variable changed;
+
+    papg_solver* getSolver(WorkerState& state, const std::string& name);
+
+    // reads and answers one request, returns false when the connection should be closed
+    bool handleRequest(WorkerState& state, Connection& connection);
+
+    // builds the arena of a binary request, returns false if it is malformed
+    static bool decodeBinary(WorkerState& state, papg_arena** arena);
+
+    void work();
+
+public:
+    explicit Server(const Options& options);
+
+    // serves requests from input on the calling thread until it ends
+    void serve(int input, int output);
+
+    // serves connections on a Unix domain socket at path until stop()
+    void listen(const std::string& path);
+
+    // lets listen() return, can be called from a signal handler
+    inline void stop() { isStopping = true; }
+};
+
+} // PAPG
+
+#endif // SERVER_HPP
@@ -0,0 +1,78 @@
+#ifndef SHARDEDSOLVER_HPP
+#define SHARDEDSOLVER_HPP
+
+#include "Arena.hpp"
+#include "MappedFile.hpp"
+#include "SPMSolver.hpp"
+#include "SolveControl.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace PAPG {
+
+// Small progress measures lifting split over worker processes on one machine.
+// The vertices are cut into a shard per worker, ranges of consecutive ids
+// with about the same number of vertices and edges each. Every worker lifts
+// the vertices of its shard with a worklist and only ever writes their
+// measures, in a table in shared memory (SharedMeasureStore) that it reads
+// the measures of the other shards from. Measures only go up, so a lift that
+// read an old measure of another shard is at most too low, and it is redone
+// once word of the change comes in: a worker that changed a vertex with
+// predecessors in other shards sends its id to each of those shards, through
+// a lock-free single-producer single-consumer ring per pair of workers (also
+// in shared memory). The solve is over once no worker has anything left to
+// lift and no id is on its way, which one shared counter tells: the workers
+// that are busy in its high half and the ids sent but not yet taken in in its
+// low half. A worker only goes idle with nothing left to do, and only turns
+// busy again, before taking any id in, while the ids it takes count, so the
+// counter is never zero while anything is left to lift.
+class ShardedSolver {
+public:
+    struct WorkerStats {
+        size_t vertices; // in its shard
+        unsigned long long lifts;
+        unsigned long long idsSent;
+        unsigned long long idsReceived;
+    };
+
+    static const size_t ringCapacity = 1 << 14; // ids per ring
+
+private:
+    const Arena& arena;
+    const unsigned numWorkers;
+
+    std::vector<size_t> shardBegins; // per worker the first vertex of its shard, and the end of the last
+    std::vector<unsigned> shardOf; // per vertex
+
+    // per vertex the shards (other than its own) with one of its predecessors, one after the other
+    std::vector<unsigned> remoteShards;
+    std::vector<size_t> remoteShardOffsets;
+
+    SharedSPMSolver solver;
+    MappedFile sharedState; // the counter, stop flag, rings and stats of a solve
+    std::vector<WorkerStats> stats;
+
+    void makeShards();
+
+    // the loop of worker in its own process, until the solve is over or stopped
+    void work(unsigned worker);
+
+public:
+    // numWorkers must be at least one
+    ShardedSolver(const Arena& arena, unsigned numWorkers);
+
+    // Forks the workers and waits for them, checking control (if given) for
+    // timeouts, lift budgets and cancellation in the meantime, which stop all
+    // workers and throw SolveInterrupted. Throws std::runtime_error if a
+    // worker can't be started or fails.
+    std::vector<Player> solve(SolveControl* control);
+
+    inline unsigned getWorkerCount() const { return numWorkers; }
+    // of the last solve
+    inline const std::vector<WorkerStats>& getWorkerStats() const { return stats; }
+};
+
+} // PAPG
+
+#endif // SHARDEDSOLVER_HPP
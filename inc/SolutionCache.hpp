@@ -0,0 +1,67 @@
+#ifndef SOLUTIONCACHE_HPP
+#define SOLUTIONCACHE_HPP
+
+#include "Arena.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace PAPG {
+
+// Solutions kept on disk between runs, one file per game and strategy in a
+// cache directory, named after a 128 bit hash of the game (its owners,
+// priorities and sorted successors, so the order edges were given in doesn't
+// matter) and the strategy. A file holds the winners, a bit per vertex. When
+// the files together grow past the size limit, the least recently used ones
+// (by modification time, which a hit updates) are removed. Several processes may share a directory: files
+// are written under a temporary name and renamed into place. Errors opening
+// the directory throw std::runtime_error, a file that can't be read or
+// written is treated as a miss.
+class SolutionCache {
+public:
+    struct Key {
+        uint64_t high;
+        uint64_t low;
+
+        std::string toString() const; // 32 hex digits
+    };
+
+    struct Entry {
+        std::vector<Player> winners;
+    };
+
+    struct Stats {
+        unsigned long long hits = 0;
+        unsigned long long misses = 0;
+        unsigned long long stores = 0;
+        unsigned long long evictions = 0;
+    };
+
+private:
+    std::string directory;
+    uint64_t maxBytes;
+    Stats stats;
+
+    std::string getPath(const Key& key) const;
+
+    // removes the least recently used files until they fit in maxBytes again
+    void evict();
+
+public:
+    // the directory is made if it doesn't exist yet
+    SolutionCache(const std::string& directory, uint64_t maxBytes);
+
+    static Key makeKey(const Arena& arena, const std::string& strategyName);
+
+    // true on a hit, entry then has the solution of the numVertices vertices of the game
+    bool load(const Key& key, size_t numVertices, Entry& entry);
+
+    void store(const Key& key, const Entry& entry);
+
+    inline const Stats& getStats() const { return stats; }
+};
+
+} // PAPG
+
+#endif // SOLUTIONCACHE_HPP
@@ -0,0 +1,100 @@
+#ifndef SOLVECONTROL_HPP
+#define SOLVECONTROL_HPP
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+namespace PAPG {
+
+class Checkpointer;
+
+// Snapshot of a running solve, solvers fill in what they keep track of and
+// leave the rest at 0.
+struct Progress {
+    unsigned long long lifts = 0;
+    size_t verticesAtTop = 0;
+    unsigned recursionDepth = 0;
+    double seconds = 0; // since the solve started, filled in by SolveControl
+};
+
+// Budgets and cancellation for one solve at a time. Solvers that are given a
+// SolveControl call check() regularly from their main loops (the lifting ones
+// every checkInterval lifts). check() throws SolveInterrupted once the solve
+// ran out of time or lifts or was cancelled, and calls the progress callback
+// periodically or when a report was requested. cancel() and requestReport()
+// only set flags, so they can be called from signal handlers and other
+// threads; check() itself is safe to call from several solver threads. The
+// small progress measures solvers also write checkpoints to the given
+// Checkpointer, if any, and resume from it.
+class SolveControl {
+public:
+    enum class Reason {
+        timeout,
+        liftBudget,
+        cancelled
+    };
+
+    typedef std::function<void(const Progress&)> ProgressCallback;
+
+    static const unsigned long long checkInterval = 1024;
+
+private:
+    std::chrono::steady_clock::duration timeLimit; // zero for no limit
+    unsigned long long liftBudget; // zero for no budget
+    std::chrono::steady_clock::duration progressInterval; // zero for no periodic progress
+
+    ProgressCallback progressCallback;
+
+    Checkpointer* checkpointer;
+
+    std::atomic<bool> isCancelRequested;
+    std::atomic<bool> isReportRequested;
+
+    std::chrono::steady_clock::time_point startTime;
+    std::chrono::steady_clock::time_point nextReport; // guarded by reportMutex during a solve
+    std::mutex reportMutex;
+
+    // calls the progress callback, reportMutex must be held
+    void report(Progress progress, std::chrono::steady_clock::time_point now);
+
+public:
+    SolveControl();
+
+    inline void setTimeLimit(std::chrono::steady_clock::duration limit) { timeLimit = limit; }
+    inline void setLiftBudget(unsigned long long budget) { liftBudget = budget; }
+    inline void setProgressCallback(ProgressCallback callback) { progressCallback = callback; }
+    inline void setProgressInterval(std::chrono::steady_clock::duration interval) { progressInterval = interval; }
+    inline void setCheckpointer(Checkpointer* newCheckpointer) { checkpointer = newCheckpointer; }
+    inline Checkpointer* getCheckpointer() const { return checkpointer; }
+
+    // restarts the clock for the next solve, a cancellation stays in effect
+    void start();
+
+    inline void cancel() { isCancelRequested = true; }
+    inline bool isCancelled() const { return isCancelRequested; }
+    inline void requestReport() { isReportRequested = true; }
+
+    void check(const Progress& progress);
+};
+
+class SolveInterrupted : public std::runtime_error {
+private:
+    SolveControl::Reason reason;
+    Progress progress;
+
+public:
+    SolveInterrupted(SolveControl::Reason reason, const Progress& progress);
+
+    inline SolveControl::Reason getReason() const { return reason; }
+    inline const Progress& getProgress() const { return progress; }
+};
+
+std::string toString(SolveControl::Reason reason);
+
+} // PAPG
+
+#endif // SOLVECONTROL_HPP
@@ -0,0 +1,104 @@
+#ifndef STRATEGIES_HPP
+#define STRATEGIES_HPP
+
+#include "Arena.hpp"
+#include "SolveControl.hpp"
+#include "StrategySelector.hpp"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <typeindex>
+#include <typeinfo>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace PAPG {
+
+// named counters reported by a strategy or engine, in the order they should be printed
+typedef std::vector<std::pair<std::string, unsigned long long> > Counters;
+
+// The solvers kept between solves, e.g. by a server thread: one per solver
+// type, made by the first solve that needs it and rebound to the arena of
+// every later one with its reset(), so its tables keep their storage. Not
+// thread-safe, use one per thread.
+class Workspace {
+private:
+    std::unordered_map<std::type_index, std::shared_ptr<void> > solvers;
+
+    const Arena* sharedArena; // the arena of what getShared() made so far
+    std::unordered_map<std::type_index, std::shared_ptr<const void> > shared;
+
+public:
+    Workspace()
+        : solvers()
+        , sharedArena(nullptr)
+        , shared()
+    {
+    }
+
+    // The Solver of this workspace, set to start over on arena. Any further
+    // arguments go to its constructor or reset().
+    template <typename Solver, typename... Args>
+    Solver& get(const Arena& arena, Args&&... args)
+    {
+        std::shared_ptr<void>& solver = solvers[std::type_index(typeid(Solver))];
+        if (!solver) {
+            solver = std::make_shared<Solver>(arena, std::forward<Args>(args)...);
+        } else {
+            static_cast<Solver*>(solver.get())->reset(arena, std::forward<Args>(args)...);
+        }
+        return *static_cast<Solver*>(solver.get());
+    }
+
+    // A T worked out from arena alone, e.g. BasicSPMSolver's max measures,
+    // made once and shared by the solves of arena until another arena comes
+    // along or startGame() is called.
+    template <typename T>
+    std::shared_ptr<const T> getShared(const Arena& arena)
+    {
+        if (&arena != sharedArena) {
+            shared.clear();
+            sharedArena = &arena;
+        }
+        std::shared_ptr<const void>& value = shared[std::type_index(typeid(T))];
+        if (!value) {
+            value = std::make_shared<const T>(arena);
+        }
+        return std::static_pointer_cast<const T>(value);
+    }
+
+    // forgets what getShared() made, as an arena can be made where an earlier one was freed
+    inline void startGame()
+    {
+        shared.clear();
+        sharedArena = nullptr;
+    }
+};
+
+// A way to solve a game: one of the engines, possibly with a particular
+// lifting strategy or variant. solve() returns the winner of every vertex
+// and adds its counters, using the solver of its engine in the workspace.
+// If winningStrategy is given and the engine computes winning strategies, it
+// is set to the successor the winner picks for every vertex won by its owner
+// (SISolver::noSuccessor elsewhere), otherwise it is left alone.
+struct Strategy {
+    std::string name;
+    std::string engine;
+    std::function<std::vector<Player>(const Arena&, Workspace&, SolveControl&, Counters&, std::vector<size_t>* winningStrategy)> solve;
+};
+
+// all strategies, in the order they are run by default
+std::vector<Strategy> makeStrategies();
+
+// The "auto" strategy: runs the one of makeStrategies() that selector chooses
+// for each game, after handing the choice to onChoice, and adds the counters
+// of that strategy and "auto choice", its position in makeStrategies() from
+// 1. Throws std::invalid_argument if selector can choose a strategy that
+// doesn't exist.
+Strategy makeAutoStrategy(const StrategySelector& selector, std::function<void(const StrategySelector::Choice&)> onChoice);
+
+} // PAPG
+
+#endif // STRATEGIES_HPP
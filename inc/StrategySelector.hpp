@@ -0,0 +1,82 @@
+#ifndef STRATEGYSELECTOR_HPP
+#define STRATEGYSELECTOR_HPP
+
+#include "Arena.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace PAPG {
+
+// Picks the strategy to solve a game with from cheap features of the game
+// (see featureNames), with a decision tree. Each inner node compares one
+// feature to a threshold and each leaf names a strategy, so the path to a
+// leaf explains the choice. A tree is trained from benchmark runs: it is
+// grown to pick the strategies that were the least slower than the fastest
+// one on the games it was trained on, in total. Models are kept as text, see
+// write(); makeDefault() gives the one papg was shipped with.
+class StrategySelector {
+public:
+    typedef std::vector<double> Features; // in the order of featureNames
+
+    // vertices, edges per vertex, priorities (the highest plus one), distinct
+    // priorities, the share of vertices with an odd priority, the share with
+    // the most common priority, the share with a self-loop, the share in the
+    // largest strongly connected component, and the share in a component
+    // with a cycle
+    static const std::vector<std::string> featureNames;
+
+    // a game the candidates were run on, with the time of every candidate in
+    // µS, negative if it didn't finish
+    struct Sample {
+        Features features;
+        std::vector<double> times;
+    };
+
+    struct Choice {
+        std::string strategy;
+        std::string reason;
+    };
+
+private:
+    // a leaf if strategy isn't empty
+    struct Node {
+        size_t feature;
+        double threshold;
+        size_t below; // the child for values up to threshold
+        size_t above;
+        std::string strategy;
+        size_t numSamples; // training games that ended up here
+        double slowdown; // the geometric mean of how many times the fastest time strategy took on them
+    };
+
+    std::vector<Node> nodes; // the root first
+
+    size_t grow(const std::vector<std::string>& candidates, const std::vector<std::vector<double> >& costs, const std::vector<Features>& features,
+        std::vector<size_t>& subset, size_t depth, size_t maxDepth);
+
+public:
+    static Features computeFeatures(const Arena& arena);
+
+    static StrategySelector makeDefault();
+
+    // the model as write() gives it, throws std::runtime_error if it isn't one
+    static StrategySelector read(std::istream& model);
+
+    // Grows a tree of at most maxDepth levels over the given samples, whose
+    // times are of the candidates in the given order. Samples without any
+    // finished run are skipped, throws std::invalid_argument if none are left.
+    static StrategySelector train(const std::vector<std::string>& candidates, const std::vector<Sample>& samples, size_t maxDepth);
+
+    void write(std::ostream& model) const;
+
+    Choice choose(const Features& features) const;
+
+    // every strategy a leaf names, once each
+    std::vector<std::string> getStrategies() const;
+};
+
+} // PAPG
+
+#endif // STRATEGYSELECTOR_HPP
@@ -0,0 +1,67 @@
+#ifndef SUCCINCTMEASURE_HPP
+#define SUCCINCTMEASURE_HPP
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace PAPG {
+
+// Succinct progress measure (Jurdzinski & Lazic). Like Measure there is one
+// component per odd priority, but each component is a bit string, and the
+// total length of all strings is bounded by the bit length of the number of
+// vertices with an odd priority. Strings are ordered as 0u < (empty) < 1u,
+// which keeps the measure space quasi-polynomial in size.
+//
+// A component holds its string left-aligned in a 64 bit word followed by a
+// single marker bit, which makes the order above plain integer order.
+//
+// There is no separate max value: the measure the solver keeps as its max
+// measure is a bottom measure carrying the dimensions of the measure space,
+// so copying it gives a fresh bottom measure, as Measure(maxValue) does.
+class SuccinctMeasure
+{
+private:
+	std::vector<uint64_t> components;
+	size_t size;
+	unsigned budget; // maximum total length of the components' strings
+	bool isToppedOut;
+
+	inline static size_t convertIndex(size_t index) {
+		if(index == 0) return 0;
+		return (index - 1) / 2;
+	}
+
+	inline static uint64_t makeZeroes(unsigned length) { return uint64_t(1) << (63 - length); }
+	inline static unsigned getLength(uint64_t component) { return 63 - __builtin_ctzll(component); }
+
+	// sets the components from index on to the least value that fits in what is left of the budget
+	void makeMinimalFrom(size_t index, unsigned used);
+
+public:
+	SuccinctMeasure(size_t size, size_t numOddVertices); // creates the bottom measure
+
+	inline bool isTop() const { return isToppedOut; }
+	inline void makeTop() { isToppedOut = true; }
+
+	bool operator==(const SuccinctMeasure & rhs) const;
+	bool operator!=(const SuccinctMeasure & rhs) const;
+
+	bool operator<(const SuccinctMeasure & rhs) const;
+	bool operator>(const SuccinctMeasure & rhs) const;
+
+	bool partialIncrementIfAble(size_t boundary);
+
+	void makePartialEqualOf(size_t boundary, const SuccinctMeasure & other);
+
+	inline size_t getSize() const { return size; }
+	inline unsigned getBudget() const { return budget; }
+
+	size_t getMemoryUsage() const; // bytes, including the components
+
+	friend std::ostream & operator<<(std::ostream & stream, const SuccinctMeasure & measure);
+};
+
+} // PAPG
+
+#endif // SUCCINCTMEASURE_HPP
@@ -0,0 +1,102 @@
+#ifndef TLSOLVER_HPP
+#define TLSOLVER_HPP
+
+#include "Arena.hpp"
+#include "SCCDecomposition.hpp"
+#include "SolveControl.hpp"
+#include "VertexSet.hpp"
+
+#include <vector>
+
+namespace PAPG {
+
+// Tangle learning (van Dijk). Decomposes the game into attractor regions
+// top-down from the most significant priority like priority promotion, but
+// instead of promoting closed regions it learns the tangles in them: strongly
+// connected parts where the region's owner wins every cycle under its
+// strategy. Learned tangles are attracted as a whole in later attractor
+// computations once all of the opponent's escapes from them are in the
+// region, so the same attraction work isn't repeated. A tangle without
+// escapes is a dominion, it is attracted and removed from the game.
+class TLSolver {
+private:
+    struct Tangle {
+        Player player;
+        std::vector<size_t> vertices;
+        std::vector<size_t> strategy; // per vertex in vertices, player's successor or noStrategy for the opponent's
+        std::vector<size_t> escapes; // distinct vertices outside the tangle the opponent can move to
+        bool isAlive; // dead once part of it has been removed from the game
+    };
+
+    const Arena* arena;
+
+    std::vector<Tangle> tangles;
+    std::vector<std::vector<size_t> > escapingTangles; // per vertex, the tangles that have it as an escape
+    std::vector<std::vector<size_t> > vertexTangles; // per vertex, the tangles it is part of
+
+    // per tangle, its escapes still in the game, and per player the tangles
+    // none are left of (some may be dead by now)
+    std::vector<size_t> escapesInGame;
+    std::vector<size_t> unescapableInGame[2];
+
+    // the same for the subgame of the current search iteration, the counters
+    // are only valid where the stamps match numIterations
+    std::vector<size_t> escapesInSubgame;
+    std::vector<unsigned> subgameStamps;
+    std::vector<size_t> unescapableInSubgame[2];
+
+    // attractor workspace, counters are only valid where the stamps match generation
+    std::vector<size_t> remainingSuccessors;
+    std::vector<unsigned> stamps;
+    std::vector<size_t> remainingEscapes;
+    std::vector<unsigned> tangleStamps;
+    unsigned generation;
+    std::vector<size_t> queue;
+
+    SCCDecomposition sccs;
+
+    SolveControl* control;
+
+    unsigned numIterations;
+    unsigned numAttractors;
+    unsigned numDominions;
+
+    // Extends region to its attractor for player within subgame, attracting
+    // learned tangles of player as well. strategy is set for the attracted
+    // vertices of player. unescapable holds the tangles of player without
+    // escapes in subgame, the ones that are dead or not in subgame are dropped.
+    void attract(const VertexSet& subgame, VertexSet& region, Player player, std::vector<size_t>& strategy, std::vector<size_t>& unescapable);
+
+    // keeps the escape counters up to date with id leaving the subgame, or the game as well
+    void leaveSubgame(size_t id);
+    void leaveGame(size_t id);
+
+    // Learns the tangles in region (an attractor for player in subgame), returns
+    // the index of one without escapes in game if there is one, or tangles.size().
+    size_t learnTangles(const VertexSet& game, const VertexSet& subgame, const VertexSet& region, Player player, const std::vector<size_t>& strategy);
+
+    // Finds a dominion in game, returns the index of its tangle.
+    size_t searchDominion(const VertexSet& game, std::vector<size_t>& strategy);
+
+    size_t findDominion();
+
+public:
+    explicit TLSolver(const Arena& arena);
+
+    // starts over on another arena, keeping the workspace's storage
+    void reset(const Arena& newArena);
+
+    std::vector<Player> solve();
+
+    // checked on every attractor computation, may be nullptr
+    inline void setControl(SolveControl* newControl) { control = newControl; }
+
+    inline unsigned getTangleCount() const { return tangles.size(); }
+    inline unsigned getIterationCount() const { return numIterations; }
+    inline unsigned getAttractorCount() const { return numAttractors; }
+    inline unsigned getDominionCount() const { return numDominions; }
+};
+
+} // PAPG
+
+#endif // TLSOLVER_HPP
@@ -0,0 +1,101 @@
+#ifndef VERTEXSET_HPP
+#define VERTEXSET_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace PAPG {
+
+// Dense bitset over vertex ids, used to describe regions and subgames
+// without copying the arena.
+class VertexSet {
+private:
+    std::vector<uint64_t> words;
+    size_t size;
+
+    static constexpr size_t bitsPerWord = 64;
+
+    inline static size_t wordIndex(size_t id) { return id / bitsPerWord; }
+    inline static uint64_t bitMask(size_t id) { return uint64_t(1) << (id % bitsPerWord); }
+
+    void clearPadding();
+
+public:
+    VertexSet() = delete; // always needs a size
+
+    explicit VertexSet(size_t size, bool filled = false);
+
+    inline size_t getSize() const { return size; }
+
+    inline bool contains(size_t id) const { return words[wordIndex(id)] & bitMask(id); }
+    inline void insert(size_t id) { words[wordIndex(id)] |= bitMask(id); }
+    inline void erase(size_t id) { words[wordIndex(id)] &= ~bitMask(id); }
+
+    // Atomic versions of contains() and insert(), for filling a set from
+    // several threads at once. Any other access must not overlap with them.
+    // insertConcurrent() returns whether id was not in the set yet.
+    inline bool containsConcurrent(size_t id) const { return __atomic_load_n(&words[wordIndex(id)], __ATOMIC_RELAXED) & bitMask(id); }
+    inline bool insertConcurrent(size_t id) { return !(__atomic_fetch_or(&words[wordIndex(id)], bitMask(id), __ATOMIC_RELAXED) & bitMask(id)); }
+
+    size_t count() const;
+    bool empty() const;
+    // the first id in the set from from on, or getSize() if there is none
+    size_t findNext(size_t from) const;
+
+    void clear();
+    void fill();
+    // makes it a set of size ids, empty or filled, keeping the storage it has
+    void assign(size_t newSize, bool filled = false);
+
+    VertexSet& operator|=(const VertexSet& rhs);
+    VertexSet& operator&=(const VertexSet& rhs);
+    VertexSet& operator-=(const VertexSet& rhs); // set difference
+
+    VertexSet operator|(const VertexSet& rhs) const;
+    VertexSet operator&(const VertexSet& rhs) const;
+    VertexSet operator-(const VertexSet& rhs) const;
+
+    bool operator==(const VertexSet& rhs) const;
+    bool operator!=(const VertexSet& rhs) const;
+
+    // calls f(id) for every id in the set, in ascending order
+    template <typename Function>
+    void forEach(Function f) const
+    {
+        for (size_t w = 0; w < words.size(); w++) {
+            uint64_t word = words[w];
+            while (word) {
+                f(w * bitsPerWord + __builtin_ctzll(word));
+                word &= word - 1; // clear lowest set bit
+            }
+        }
+    }
+
+    // the same for the ids from begin up to end only
+    template <typename Function>
+    void forEachIn(size_t begin, size_t end, Function f) const
+    {
+        if (begin >= end) {
+            return;
+        }
+        const size_t last = wordIndex(end - 1);
+        for (size_t w = wordIndex(begin); w <= last; w++) {
+            uint64_t word = words[w];
+            if (w == wordIndex(begin)) {
+                word &= ~uint64_t(0) << (begin % bitsPerWord);
+            }
+            if (w == last && end % bitsPerWord != 0) {
+                word &= ~(~uint64_t(0) << (end % bitsPerWord));
+            }
+            while (word) {
+                f(w * bitsPerWord + __builtin_ctzll(word));
+                word &= word - 1;
+            }
+        }
+    }
+};
+
+} // PAPG
+
+#endif // VERTEXSET_HPP
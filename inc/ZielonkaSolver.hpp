@@ -0,0 +1,67 @@
+#ifndef ZIELONKASOLVER_HPP
+#define ZIELONKASOLVER_HPP
+
+#include "Arena.hpp"
+#include "Attractor.hpp"
+#include "SolveControl.hpp"
+#include "VertexSet.hpp"
+
+#include <atomic>
+#include <vector>
+
+namespace PAPG {
+
+// Zielonka's recursive algorithm. Subgames are VertexSet views on the arena,
+// the arena itself is never copied. Subgames that fall apart into several
+// independent (weakly connected) components have those components solved in
+// parallel.
+class ZielonkaSolver {
+private:
+    const Arena* arena;
+
+    Attractor attractor; // of the calling thread, threads solving components get their own
+
+    unsigned maxThreads;
+    size_t parallelThreshold; // minimum component size worth a thread of its own
+
+    SolveControl* control;
+
+    std::atomic<unsigned> numRecursiveCalls;
+    std::atomic<unsigned> numAttractors;
+    std::atomic<unsigned> numParallelCalls;
+    std::atomic<unsigned> maxRecursionDepth;
+    std::atomic<unsigned> numActiveThreads;
+
+    // returns the part of subgame that is won by odd
+    VertexSet solveSubgame(const VertexSet& subgame, Attractor& attractor, unsigned depth);
+
+    // splits subgame into its large weakly connected components and one set
+    // holding all small ones, returns an empty vector if there is nothing to split
+    std::vector<VertexSet> splitComponents(const VertexSet& subgame) const;
+    VertexSet solveComponents(const std::vector<VertexSet>& components, Attractor& attractor, unsigned depth);
+
+    void updateMaxRecursionDepth(unsigned depth);
+
+public:
+    explicit ZielonkaSolver(const Arena& arena);
+
+    // starts over on another arena, keeping the attractor's workspace
+    void reset(const Arena& newArena);
+
+    std::vector<Player> solve();
+
+    inline void setMaxThreads(unsigned threads) { maxThreads = threads ? threads : 1; }
+    inline void setParallelThreshold(size_t threshold) { parallelThreshold = threshold; }
+
+    // checked on every recursive call, may be nullptr
+    inline void setControl(SolveControl* newControl) { control = newControl; }
+
+    inline unsigned getRecursiveCallCount() const { return numRecursiveCalls; }
+    inline unsigned getAttractorCount() const { return numAttractors; }
+    inline unsigned getParallelCallCount() const { return numParallelCalls; }
+    inline unsigned getMaxRecursionDepth() const { return maxRecursionDepth; }
+};
+
+} // PAPG
+
+#endif // ZIELONKASOLVER_HPP
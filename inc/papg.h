@@ -0,0 +1,135 @@
+#ifndef PAPG_H
+#define PAPG_H
+
+/*
+ * C interface of libpapg, for solving parity games in-process.
+ *
+ * An arena is built directly from arrays (or parsed from a PGSolver file) and
+ * solved by a solver, which is created for one strategy or engine and can be
+ * reused for any number of solves. Results are read from buffers owned by the
+ * solver, which stay valid until the next solve or until the solver is
+ * destroyed; their memory, and the working memory of the solver itself, is
+ * reused between solves.
+ *
+ * Functions return PAPG_OK or an error status, papg_solver_error() gives a
+ * description of the last error of a solver. Arenas and solvers may be used
+ * from different threads, but each one from a single thread at a time, with
+ * the exception of papg_solver_cancel().
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PAPG_API __attribute__((visibility("default")))
+
+#define PAPG_VERSION_MAJOR 1
+#define PAPG_VERSION_MINOR 0
+
+/* vertices are won by, and owned by, even (0) or odd (1) */
+#define PAPG_EVEN 0
+#define PAPG_ODD 1
+
+/* strategy entry of vertices that are not won by their owner */
+#define PAPG_NO_SUCCESSOR SIZE_MAX
+
+typedef enum papg_status {
+    PAPG_OK = 0,
+    PAPG_INVALID_ARGUMENT, /* bad arena description, file or value */
+    PAPG_UNKNOWN_STRATEGY, /* no strategy or engine by that name */
+    PAPG_INTERRUPTED, /* stopped by the time limit, the lift budget or papg_solver_cancel() */
+    PAPG_INTERNAL_ERROR
+} papg_status;
+
+typedef struct papg_arena papg_arena;
+typedef struct papg_solver papg_solver;
+
+PAPG_API const char* papg_version(void);
+
+/* ------------------------------------------------------------------
+ * arenas
+ */
+
+/*
+ * Creates an arena of num_vertices vertices with the given owners (PAPG_EVEN
+ * or PAPG_ODD) and priorities. The successors of vertex v are
+ * successors[successor_offsets[v]] up to successors[successor_offsets[v + 1]],
+ * so successor_offsets has num_vertices + 1 entries. Every vertex needs at
+ * least one successor. The arrays are copied, they can be freed afterwards.
+ */
+PAPG_API papg_status papg_arena_create(size_t num_vertices, const uint8_t* owners, const uint32_t* priorities,
+    const size_t* successor_offsets, const size_t* successors, papg_arena** arena);
+
+/*
+ * parses a PGSolver game, which may be gzip, bzip2 or xz compressed; like
+ * papg_arena_create() every vertex needs at least one successor
+ */
+PAPG_API papg_status papg_arena_parse(const char* path, papg_arena** arena);
+
+/* parses a PGSolver game of length bytes from memory (uncompressed), as above */
+PAPG_API papg_status papg_arena_parse_text(const char* text, size_t length, papg_arena** arena);
+
+PAPG_API void papg_arena_destroy(papg_arena* arena);
+
+PAPG_API size_t papg_arena_size(const papg_arena* arena);
+
+/* ------------------------------------------------------------------
+ * strategies
+ */
+
+/* number of strategies and their names and engines, in the order papg lists them */
+PAPG_API size_t papg_strategy_count(void);
+PAPG_API const char* papg_strategy_name(size_t index);
+PAPG_API const char* papg_strategy_engine(size_t index);
+
+/* ------------------------------------------------------------------
+ * solvers
+ */
+
+/*
+ * Creates a solver for the strategy with the given name (see
+ * papg_strategy_name()), or for the first strategy of the engine with the
+ * given name (e.g. "zielonka"). Preprocessing is on by default.
+ */
+PAPG_API papg_status papg_solver_create(const char* name, papg_solver** solver);
+
+PAPG_API void papg_solver_destroy(papg_solver* solver);
+
+/* limits per solve, zero for no limit */
+PAPG_API void papg_solver_set_time_limit(papg_solver* solver, double seconds);
+PAPG_API void papg_solver_set_lift_budget(papg_solver* solver, unsigned long long lifts);
+
+/* whether self-loop dominions and their attractors are removed before solving */
+PAPG_API void papg_solver_set_preprocessing(papg_solver* solver, int enabled);
+
+/* stops the running solve (which returns PAPG_INTERRUPTED) and all later ones, may be called from any thread */
+PAPG_API void papg_solver_cancel(papg_solver* solver);
+
+PAPG_API papg_status papg_solve(papg_solver* solver, const papg_arena* arena);
+
+/* the winner of every vertex (PAPG_EVEN or PAPG_ODD), after a successful solve */
+PAPG_API const uint8_t* papg_solver_winners(const papg_solver* solver);
+
+/*
+ * The successor every vertex won by its owner moves to in a winning strategy,
+ * PAPG_NO_SUCCESSOR for the other vertices. NULL if the strategy's engine does
+ * not compute winning strategies (only the "si" engine does).
+ */
+PAPG_API const size_t* papg_solver_strategy(const papg_solver* solver);
+
+/* counters of the last solve, as papg reports them */
+PAPG_API size_t papg_solver_counter_count(const papg_solver* solver);
+PAPG_API const char* papg_solver_counter_name(const papg_solver* solver, size_t index);
+PAPG_API unsigned long long papg_solver_counter_value(const papg_solver* solver, size_t index);
+
+/* description of the last error, empty if there was none */
+PAPG_API const char* papg_solver_error(const papg_solver* solver);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PAPG_H */
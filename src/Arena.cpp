@@ -61,6 +61,30 @@ bool Arena::setVertexLabel(size_t id, std::string label)
     return true;
 }
 
+bool Arena::clearVertex(size_t id)
+{
+    if (id >= vertices.size()) {
+        return false;
+    }
+
+    // if the vertex was declared before, its old edges have to go from the incoming lists of its successors
+    for (const size_t successor : vertices[id].outgoing) {
+        auto& incoming = vertices[successor].incoming;
+        auto edge = std::find(incoming.begin(), incoming.end(), id);
+        if (edge != incoming.end()) {
+            incoming.erase(edge);
+        }
+    }
+
+    // incoming edges were added by the declarations of other vertices, keep them
+    std::vector<size_t> incoming;
+    incoming.swap(vertices[id].incoming);
+    vertices[id] = Vertex(id);
+    vertices[id].incoming.swap(incoming);
+
+    return true;
+}
+
 bool Arena::addEdge(size_t from, size_t to){
     if(from >= vertices.size() || to >= vertices.size()){
         return false;
@@ -0,0 +1,210 @@
+#include "Attractor.hpp"
+
+#include <algorithm>
+#include <thread>
+
+namespace PAPG {
+
+const size_t Attractor::parallelMinArenaSize;
+const size_t Attractor::parallelMinLevelSize;
+
+namespace {
+    void markOwnedByOdd(const Arena& arena, VertexSet& result)
+    {
+        result.assign(arena.getSize());
+        for (size_t id = 0; id < arena.getSize(); id++) {
+            if (arena[id].owner == Player::odd) {
+                result.insert(id);
+            }
+        }
+    }
+
+    // calls f(thread, begin, end) for numThreads parts of [0, size), on as many threads
+    template <typename Function>
+    void parallelFor(unsigned numThreads, size_t size, Function f)
+    {
+        std::vector<std::thread> threads;
+        const size_t partSize = (size + numThreads - 1) / numThreads;
+        for (unsigned thread = 1; thread < numThreads; thread++) {
+            const size_t begin = std::min(size, thread * partSize);
+            threads.emplace_back(f, thread, begin, std::min(size, begin + partSize));
+        }
+        f(0, 0, std::min(size, partSize));
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+}
+
+Attractor::Attractor(const Arena& arena)
+    : arena(nullptr)
+    , ownedByOdd(0)
+    , maxThreads(1)
+    , remainingSuccessors()
+    , stamps()
+    , generation(0)
+    , queue()
+    , nextLevel()
+    , numComputations(0)
+    , numEdges(0)
+{
+    reset(arena);
+}
+
+void Attractor::reset(const Arena& newArena)
+{
+    arena = &newArena;
+    markOwnedByOdd(newArena, ownedByOdd);
+    remainingSuccessors.assign(newArena.getSize(), 0);
+    stamps.assign(newArena.getSize(), 0);
+    generation = 0;
+    queue.reserve(newArena.getSize());
+    numComputations = 0;
+    numEdges = 0;
+}
+
+void Attractor::attract(const VertexSet& subgame, VertexSet& region, Player player, std::vector<size_t>* strategy)
+{
+    numComputations++;
+
+    if (maxThreads > 1 && arena->getSize() >= parallelMinArenaSize) {
+        attractParallel(subgame, region, player, strategy);
+    } else {
+        attractSequential(subgame, region, player, strategy);
+    }
+}
+
+void Attractor::attractSequential(const VertexSet& subgame, VertexSet& region, Player player, std::vector<size_t>* strategy)
+{
+    if (++generation == 0) {
+        // generation counter wrapped around, stale stamps could match again
+        std::fill(stamps.begin(), stamps.end(), 0);
+        generation = 1;
+    }
+
+    queue.clear();
+    region.forEach([this](size_t id) { queue.push_back(id); });
+
+    // queue is used as a plain worklist, order does not matter for the result
+    while (!queue.empty()) {
+        const size_t current = queue.back();
+        queue.pop_back();
+        numEdges += (*arena)[current].incoming.size();
+
+        for (const size_t predecessor : (*arena)[current].incoming) {
+            if (!subgame.contains(predecessor) || region.contains(predecessor)) {
+                continue;
+            }
+
+            const Vertex& vertex = (*arena)[predecessor];
+
+            if (vertex.owner == player) {
+                // player can simply choose to move into the region
+                if (strategy) {
+                    (*strategy)[predecessor] = current;
+                }
+            } else {
+                if (stamps[predecessor] != generation) {
+                    // first time we see this vertex, count its successors in the subgame
+                    size_t numSuccessors = 0;
+                    for (const size_t successor : vertex.outgoing) {
+                        if (subgame.contains(successor)) {
+                            numSuccessors++;
+                        }
+                    }
+                    remainingSuccessors[predecessor] = numSuccessors;
+                    stamps[predecessor] = generation;
+                }
+
+                // opponent is forced into the region only once all its escapes are gone
+                if (--remainingSuccessors[predecessor] > 0) {
+                    continue;
+                }
+            }
+
+            region.insert(predecessor);
+            queue.push_back(predecessor);
+        }
+    }
+}
+
+void Attractor::attractParallel(const VertexSet& subgame, VertexSet& region, Player player, std::vector<size_t>* strategy)
+{
+    // the opponent vertices that could still be attracted, found a word at a time
+    VertexSet candidates = subgame - region;
+    if (player == Player::odd) {
+        candidates -= ownedByOdd;
+    } else {
+        candidates &= ownedByOdd;
+    }
+
+    // counters of all candidates up front, the lazy stamps of the sequential
+    // version would race; the stamps are left alone and stay valid for it
+    std::vector<size_t> candidateIds;
+    candidates.forEach([&](size_t id) { candidateIds.push_back(id); });
+    parallelFor(maxThreads, candidateIds.size(), [&](unsigned, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const size_t id = candidateIds[i];
+            remainingSuccessors[id] = std::count_if((*arena)[id].outgoing.begin(), (*arena)[id].outgoing.end(), [&](size_t successor) {
+                return subgame.contains(successor);
+            });
+        }
+    });
+
+    // attracts the predecessors of level[begin, end) into next, only with atomic updates
+    auto expand = [&](const std::vector<size_t>& level, size_t begin, size_t end, std::vector<size_t>& next, unsigned long long& edges) {
+        for (size_t i = begin; i < end; i++) {
+            const size_t current = level[i];
+            edges += (*arena)[current].incoming.size();
+
+            for (const size_t predecessor : (*arena)[current].incoming) {
+                if (!subgame.contains(predecessor)) {
+                    continue;
+                }
+
+                if ((*arena)[predecessor].owner == player) {
+                    // the first thread to get here gets to set the strategy
+                    if (region.insertConcurrent(predecessor)) {
+                        if (strategy) {
+                            (*strategy)[predecessor] = current;
+                        }
+                        next.push_back(predecessor);
+                    }
+                } else if (!region.containsConcurrent(predecessor)
+                    && __atomic_sub_fetch(&remainingSuccessors[predecessor], 1, __ATOMIC_RELAXED) == 0) {
+                    // the last escape is gone, only one thread sees the counter reach zero
+                    region.insertConcurrent(predecessor);
+                    next.push_back(predecessor);
+                }
+            }
+        }
+    };
+
+    queue.clear();
+    region.forEach([this](size_t id) { queue.push_back(id); });
+
+    std::vector<std::vector<size_t> > threadNext(maxThreads);
+    std::vector<unsigned long long> threadEdges(maxThreads, 0);
+
+    while (!queue.empty()) {
+        nextLevel.clear();
+
+        if (queue.size() < parallelMinLevelSize) {
+            expand(queue, 0, queue.size(), nextLevel, numEdges);
+        } else {
+            parallelFor(maxThreads, queue.size(), [&](unsigned thread, size_t begin, size_t end) {
+                threadNext[thread].clear();
+                expand(queue, begin, end, threadNext[thread], threadEdges[thread]);
+            });
+            for (unsigned thread = 0; thread < maxThreads; thread++) {
+                nextLevel.insert(nextLevel.end(), threadNext[thread].begin(), threadNext[thread].end());
+                numEdges += threadEdges[thread];
+                threadEdges[thread] = 0;
+            }
+        }
+
+        queue.swap(nextLevel);
+    }
+}
+
+} // PAPG
@@ -0,0 +1,193 @@
+#include "Checkpoint.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <unistd.h>
+
+namespace PAPG {
+
+namespace {
+    const char magic[8] = { 'P', 'A', 'P', 'G', 'C', 'K', 'P', '1' };
+
+    struct Header {
+        char magic[8];
+        uint64_t keyHigh;
+        uint64_t keyLow;
+        uint64_t lifts;
+        uint64_t recordSize;
+        uint64_t numWords;
+        uint64_t strategyLength;
+    };
+}
+
+Checkpointer::Checkpointer(const std::string& path, Clock::duration interval)
+    : path(path)
+    , interval(interval)
+    , nextDue(Clock::now() + interval)
+    , key{ 0, 0 }
+    , strategy()
+    , resume()
+    , resumedLifts(0)
+    , pending()
+    , isWriting(false)
+    , isStopped(false)
+    , numWritten(0)
+    , error()
+    , mutex()
+    , changed()
+    , writer()
+{
+    writer = std::thread(&Checkpointer::writeAll, this);
+}
+
+Checkpointer::~Checkpointer()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        isStopped = true;
+    }
+    changed.notify_all();
+    writer.join();
+}
+
+void Checkpointer::writeAll()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        changed.wait(lock, [this]() { return pending || isStopped; });
+        if (!pending) {
+            return;
+        }
+
+        std::unique_ptr<CheckpointData> data = std::move(pending);
+        isWriting = true;
+        lock.unlock();
+
+        writeFile(*data);
+
+        lock.lock();
+        isWriting = false;
+        changed.notify_all();
+    }
+}
+
+void Checkpointer::writeFile(const CheckpointData& data)
+{
+    Header header;
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.keyHigh = data.key.high;
+    header.keyLow = data.key.low;
+    header.lifts = data.lifts;
+    header.recordSize = data.recordSize;
+    header.numWords = data.words.size();
+    header.strategyLength = data.strategy.size();
+
+    const std::string temporaryPath = path + ".tmp";
+    std::FILE* file = std::fopen(temporaryPath.c_str(), "wb");
+    bool isWritten = file != nullptr
+        && std::fwrite(&header, sizeof(header), 1, file) == 1
+        && std::fwrite(data.strategy.data(), 1, data.strategy.size(), file) == data.strategy.size()
+        && std::fwrite(data.words.data(), sizeof(uint32_t), data.words.size(), file) == data.words.size()
+        && std::fflush(file) == 0
+        && ::fsync(::fileno(file)) == 0; // on disk before it replaces the last checkpoint
+    const std::string reason = std::strerror(errno);
+    isWritten = (file != nullptr && std::fclose(file) == 0) && isWritten;
+    isWritten = isWritten && std::rename(temporaryPath.c_str(), path.c_str()) == 0;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (isWritten) {
+        numWritten++;
+    } else {
+        std::remove(temporaryPath.c_str());
+        error = "ERR: failed to write checkpoint " + path + ": " + reason;
+    }
+}
+
+void Checkpointer::loadResume()
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("ERR: Failed to open checkpoint " + path);
+    }
+
+    Header header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || std::memcmp(header.magic, magic, sizeof(magic)) != 0
+        || header.recordSize == 0 || header.numWords % header.recordSize != 0) {
+        throw std::runtime_error("ERR: " + path + " is not a checkpoint.");
+    }
+
+    std::unique_ptr<CheckpointData> data(new CheckpointData());
+    data->key = SolutionCache::Key{ header.keyHigh, header.keyLow };
+    data->lifts = header.lifts;
+    data->recordSize = header.recordSize;
+    data->strategy.resize(header.strategyLength);
+    data->words.resize(header.numWords);
+    if (!file.read(&data->strategy[0], data->strategy.size())
+        || !file.read(reinterpret_cast<char*>(data->words.data()), data->words.size() * sizeof(uint32_t))) {
+        throw std::runtime_error("ERR: checkpoint " + path + " is cut short.");
+    }
+
+    resume = std::move(data);
+}
+
+bool Checkpointer::begin(const SolutionCache::Key& gameKey, const std::string& strategyName)
+{
+    key = gameKey;
+    strategy = strategyName;
+    resumedLifts = 0;
+    nextDue = Clock::now() + interval;
+
+    if (resume && (resume->key.high != key.high || resume->key.low != key.low)) {
+        resume.reset();
+        return false;
+    }
+    return true;
+}
+
+std::unique_ptr<CheckpointData> Checkpointer::takeResume()
+{
+    if (resume) {
+        resumedLifts = resume->lifts;
+    }
+    return std::move(resume);
+}
+
+bool Checkpointer::isReady()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return !pending && !isWriting;
+}
+
+void Checkpointer::write(std::unique_ptr<CheckpointData> data)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending = std::move(data);
+    }
+    changed.notify_all();
+    nextDue = Clock::now() + interval;
+}
+
+void Checkpointer::flush()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [this]() { return !pending && !isWriting; });
+}
+
+unsigned long long Checkpointer::getWrittenCount()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return numWritten;
+}
+
+std::string Checkpointer::getError()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return error;
+}
+
+} // PAPG
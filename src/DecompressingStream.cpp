@@ -0,0 +1,300 @@
+#include "DecompressingStream.hpp"
+
+#include <bzlib.h>
+#include <lzma.h>
+#include <zlib.h>
+
+#include <cstring>
+#include <stdexcept>
+
+namespace PAPG {
+
+const size_t DecompressingStreamBuffer::blockSize;
+const size_t DecompressingStreamBuffer::maxQueuedBlocks;
+
+Compression detectCompression(const std::string& path)
+{
+    unsigned char magic[6] = { 0 };
+
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        return Compression::none;
+    }
+    const size_t length = std::fread(magic, 1, sizeof(magic), file);
+    std::fclose(file);
+
+    if (length >= 2 && magic[0] == 0x1f && magic[1] == 0x8b) {
+        return Compression::gzip;
+    }
+    if (length >= 3 && std::memcmp(magic, "BZh", 3) == 0) {
+        return Compression::bzip2;
+    }
+    if (length >= 6 && std::memcmp(magic, "\xfd" "7zXZ\0", 6) == 0) {
+        return Compression::xz;
+    }
+    return Compression::none;
+}
+
+DecompressingStreamBuffer::DecompressingStreamBuffer(const std::string& path, Compression compression)
+    : file(std::fopen(path.c_str(), "rb"))
+    , compression(compression)
+    , blocks()
+    , current()
+    , isFinished(false)
+    , isStopped(false)
+    , error()
+    , mutex()
+    , changed()
+    , decompressor()
+{
+    if (file == nullptr) {
+        throw std::runtime_error("ERR: Failed to open file.");
+    }
+
+    decompressor = std::thread(&DecompressingStreamBuffer::decompress, this);
+}
+
+DecompressingStreamBuffer::~DecompressingStreamBuffer()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        isStopped = true;
+    }
+    changed.notify_all();
+
+    decompressor.join();
+    std::fclose(file);
+}
+
+bool DecompressingStreamBuffer::push(std::vector<char>& block)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [this]() { return blocks.size() < maxQueuedBlocks || isStopped; });
+
+    if (isStopped) {
+        return false;
+    }
+
+    blocks.push_back(std::move(block));
+    lock.unlock();
+    changed.notify_all();
+
+    block.assign(blockSize, 0);
+    return true;
+}
+
+void DecompressingStreamBuffer::decompress()
+{
+    try {
+        switch (compression) {
+        case Compression::gzip:
+            decompressGzip();
+            break;
+        case Compression::bzip2:
+            decompressBzip2();
+            break;
+        case Compression::xz:
+            decompressXz();
+            break;
+        case Compression::none:
+            throw std::invalid_argument("DecompressingStreamBuffer: file is not compressed!");
+        }
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex);
+        error = std::current_exception();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        isFinished = true;
+    }
+    changed.notify_all();
+}
+
+void DecompressingStreamBuffer::decompressGzip()
+{
+    struct Stream : z_stream {
+        Stream() : z_stream() {}
+        ~Stream() { inflateEnd(this); }
+    } stream;
+
+    // 15 + 32: maximum window size, detect the gzip or zlib header
+    if (inflateInit2(&stream, 15 + 32) != Z_OK) {
+        throw std::runtime_error("ERR: failed to initialize gzip decompression.");
+    }
+
+    std::vector<unsigned char> input(blockSize);
+    std::vector<char> block(blockSize);
+    bool isInMember = false; // a member was started but has not ended yet
+
+    while (true) {
+        if (stream.avail_in == 0) {
+            stream.avail_in = std::fread(input.data(), 1, input.size(), file);
+            stream.next_in = input.data();
+            if (stream.avail_in == 0) {
+                break;
+            }
+        }
+
+        stream.next_out = reinterpret_cast<unsigned char*>(block.data());
+        stream.avail_out = block.size();
+
+        const int result = inflate(&stream, Z_NO_FLUSH);
+        if (result == Z_STREAM_END) {
+            inflateReset(&stream); // there can be more members after this one
+            isInMember = false;
+        } else if (result == Z_OK || result == Z_BUF_ERROR) {
+            isInMember = true;
+        } else {
+            throw std::runtime_error("ERR: bad gzip input.");
+        }
+
+        block.resize(block.size() - stream.avail_out);
+        if (!block.empty() && !push(block)) {
+            return;
+        }
+        block.resize(blockSize);
+    }
+
+    if (std::ferror(file) || isInMember) {
+        throw std::runtime_error("ERR: gzip input is truncated or unreadable.");
+    }
+}
+
+void DecompressingStreamBuffer::decompressBzip2()
+{
+    struct Stream : bz_stream {
+        bool isInitialized = false;
+        Stream() : bz_stream() {}
+        ~Stream() { if (isInitialized) BZ2_bzDecompressEnd(this); }
+    } stream;
+
+    std::vector<char> input(blockSize);
+    std::vector<char> block(blockSize);
+    bool isInMember = false;
+
+    while (true) {
+        if (stream.avail_in == 0) {
+            stream.avail_in = std::fread(input.data(), 1, input.size(), file);
+            stream.next_in = input.data();
+            if (stream.avail_in == 0) {
+                break;
+            }
+        }
+
+        if (!stream.isInitialized) {
+            if (BZ2_bzDecompressInit(&stream, 0, 0) != BZ_OK) {
+                throw std::runtime_error("ERR: failed to initialize bzip2 decompression.");
+            }
+            stream.isInitialized = true;
+        }
+
+        stream.next_out = block.data();
+        stream.avail_out = block.size();
+
+        const int result = BZ2_bzDecompress(&stream);
+        if (result == BZ_STREAM_END) {
+            // there can be more streams after this one, start over for those
+            BZ2_bzDecompressEnd(&stream);
+            stream.isInitialized = false;
+            isInMember = false;
+        } else if (result == BZ_OK) {
+            isInMember = true;
+        } else {
+            throw std::runtime_error("ERR: bad bzip2 input.");
+        }
+
+        block.resize(block.size() - stream.avail_out);
+        if (!block.empty() && !push(block)) {
+            return;
+        }
+        block.resize(blockSize);
+    }
+
+    if (std::ferror(file) || isInMember) {
+        throw std::runtime_error("ERR: bzip2 input is truncated or unreadable.");
+    }
+}
+
+void DecompressingStreamBuffer::decompressXz()
+{
+    struct Stream : lzma_stream {
+        Stream() : lzma_stream(LZMA_STREAM_INIT) {}
+        ~Stream() { lzma_end(this); }
+    } stream;
+
+    if (lzma_stream_decoder(&stream, UINT64_MAX, LZMA_CONCATENATED) != LZMA_OK) {
+        throw std::runtime_error("ERR: failed to initialize xz decompression.");
+    }
+
+    std::vector<uint8_t> input(blockSize);
+    std::vector<char> block(blockSize);
+    lzma_action action = LZMA_RUN;
+
+    while (true) {
+        if (stream.avail_in == 0 && action == LZMA_RUN) {
+            stream.avail_in = std::fread(input.data(), 1, input.size(), file);
+            stream.next_in = input.data();
+            if (stream.avail_in == 0) {
+                action = LZMA_FINISH; // with LZMA_CONCATENATED the decoder needs to be told the input ended
+            }
+        }
+
+        stream.next_out = reinterpret_cast<uint8_t*>(block.data());
+        stream.avail_out = block.size();
+
+        const lzma_ret result = lzma_code(&stream, action);
+        if (result != LZMA_OK && result != LZMA_STREAM_END) {
+            throw std::runtime_error("ERR: bad or truncated xz input.");
+        }
+
+        block.resize(block.size() - stream.avail_out);
+        if (!block.empty() && !push(block)) {
+            return;
+        }
+        block.resize(blockSize);
+
+        if (result == LZMA_STREAM_END) {
+            break;
+        }
+    }
+
+    if (std::ferror(file)) {
+        throw std::runtime_error("ERR: xz input is unreadable.");
+    }
+}
+
+DecompressingStreamBuffer::int_type DecompressingStreamBuffer::underflow()
+{
+    if (gptr() < egptr()) {
+        return traits_type::to_int_type(*gptr());
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [this]() { return !blocks.empty() || isFinished; });
+
+    if (blocks.empty()) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return traits_type::eof();
+    }
+
+    current = std::move(blocks.front());
+    blocks.pop_front();
+    lock.unlock();
+    changed.notify_all();
+
+    setg(current.data(), current.data(), current.data() + current.size());
+    return traits_type::to_int_type(*gptr());
+}
+
+DecompressingStream::DecompressingStream(const std::string& path, Compression compression)
+    : std::istream(nullptr)
+    , buffer(path, compression)
+{
+    rdbuf(&buffer);
+    exceptions(std::ios::badbit); // so decompression errors reach the caller instead of looking like the end of the file
+}
+
+} // PAPG
@@ -0,0 +1,283 @@
+#include "LiftTrace.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace PAPG {
+
+const char* toString(LiftPhase phase)
+{
+    switch (phase) {
+    case LiftPhase::sweep:
+        return "sweep";
+    case LiftPhase::recursive:
+        return "recursive";
+    case LiftPhase::seeds:
+        return "seeds";
+    case LiftPhase::propagation:
+        return "propagation";
+    case LiftPhase::hybrid:
+        return "hybrid";
+    case LiftPhase::worklist:
+        return "worklist";
+    }
+    return "unknown";
+}
+
+namespace {
+    const size_t bufferSize = 1 << 16; // records, 1 MiB
+    const size_t maxQueuedChunks = 8;
+
+    struct Chunk {
+        ChunkHeader header;
+        std::vector<LiftRecord> records;
+        std::string name;
+    };
+
+    // Owns the file and the thread writing the chunks handed to it, in the
+    // order they were handed over.
+    class Writer {
+    private:
+        std::FILE* file;
+        std::deque<Chunk> chunks;
+        std::vector<std::vector<LiftRecord> > spareBuffers; // written out, to be filled again
+        bool isStopped;
+        bool isFailed;
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::thread thread;
+
+        void write()
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (true) {
+                changed.wait(lock, [this]() { return !chunks.empty() || isStopped; });
+                if (chunks.empty()) {
+                    return;
+                }
+
+                Chunk chunk = std::move(chunks.front());
+                chunks.pop_front();
+                lock.unlock();
+                changed.notify_all();
+
+                bool isWritten = std::fwrite(&chunk.header, sizeof(ChunkHeader), 1, file) == 1;
+                if (chunk.header.kind == ChunkHeader::records) {
+                    isWritten = isWritten && std::fwrite(chunk.records.data(), sizeof(LiftRecord), chunk.records.size(), file) == chunk.records.size();
+                } else {
+                    isWritten = isWritten && std::fwrite(chunk.name.data(), 1, chunk.name.size(), file) == chunk.name.size();
+                }
+
+                lock.lock();
+                isFailed = isFailed || !isWritten;
+                if (chunk.header.kind == ChunkHeader::records) {
+                    chunk.records.clear();
+                    spareBuffers.push_back(std::move(chunk.records));
+                }
+            }
+        }
+
+    public:
+        Writer()
+            : file(nullptr)
+            , chunks()
+            , spareBuffers()
+            , isStopped(false)
+            , isFailed(false)
+            , mutex()
+            , changed()
+            , thread()
+        {
+        }
+
+        ~Writer() { stop(); }
+
+        void start(const std::string& path)
+        {
+            file = std::fopen(path.c_str(), "wb");
+            if (file == nullptr || std::fwrite(traceMagic, sizeof(traceMagic), 1, file) != 1) {
+                if (file != nullptr) {
+                    std::fclose(file);
+                    file = nullptr;
+                }
+                throw std::runtime_error("ERR: Failed to write trace file " + path);
+            }
+            isStopped = false;
+            isFailed = false;
+            thread = std::thread(&Writer::write, this);
+        }
+
+        // waits for everything handed over to be written, returns false if any of it failed
+        bool stop()
+        {
+            if (!thread.joinable()) {
+                return true;
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                isStopped = true;
+            }
+            changed.notify_all();
+            thread.join();
+
+            const bool isClosed = std::fclose(file) == 0;
+            file = nullptr;
+            return isClosed && !isFailed;
+        }
+
+        // hands a chunk over, waiting while too many are queued
+        void push(Chunk chunk)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [this]() { return chunks.size() < maxQueuedChunks; });
+            chunks.push_back(std::move(chunk));
+            lock.unlock();
+            changed.notify_all();
+        }
+
+        // a written out buffer, or a new one if there is none
+        std::vector<LiftRecord> getBuffer()
+        {
+            std::vector<LiftRecord> buffer;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!spareBuffers.empty()) {
+                    buffer = std::move(spareBuffers.back());
+                    spareBuffers.pop_back();
+                }
+            }
+            buffer.reserve(bufferSize);
+            return buffer;
+        }
+    };
+
+    Writer writer;
+    std::mutex openMutex; // serializes open() and close()
+    std::atomic<bool> isRecording(false);
+    std::atomic<unsigned> generation(0); // open() count, so records from an earlier file are dropped
+    std::atomic<uint32_t> numThreads(0);
+    std::atomic<uint32_t> currentRun(0);
+
+    void submit(std::vector<LiftRecord>& records, uint32_t thread)
+    {
+        Chunk chunk;
+        chunk.header = ChunkHeader{ ChunkHeader::records, thread, records.size() };
+        chunk.records = std::move(records);
+        writer.push(std::move(chunk));
+        records = writer.getBuffer();
+    }
+
+    struct ThreadBuffer {
+        std::vector<LiftRecord> records;
+        uint32_t thread;
+        unsigned generation;
+        LiftPhase phase;
+
+        ThreadBuffer()
+            : records()
+            , thread(numThreads++)
+            , generation(0)
+            , phase(LiftPhase::sweep)
+        {
+        }
+
+        ~ThreadBuffer()
+        {
+            // a thread ending while recording hands over what it has left
+            std::lock_guard<std::mutex> lock(openMutex);
+            if (isRecording && generation == PAPG::generation && !records.empty()) {
+                submit(records, thread);
+            }
+        }
+    };
+
+    thread_local ThreadBuffer threadBuffer;
+}
+
+namespace LiftTrace {
+    void open(const std::string& path)
+    {
+        std::lock_guard<std::mutex> lock(openMutex);
+        if (isRecording) {
+            throw std::logic_error("ERR: a trace file is already open.");
+        }
+        writer.start(path);
+        generation++;
+        currentRun = 0;
+        isRecording = true;
+    }
+
+    void close()
+    {
+        std::lock_guard<std::mutex> lock(openMutex);
+        if (!isRecording) {
+            return;
+        }
+        isRecording = false;
+
+        ThreadBuffer& buffer = threadBuffer;
+        if (buffer.generation == generation && !buffer.records.empty()) {
+            submit(buffer.records, buffer.thread);
+        }
+        if (!writer.stop()) {
+            throw std::runtime_error("ERR: Failed to write trace file.");
+        }
+    }
+
+    bool isOpen()
+    {
+        return isRecording;
+    }
+
+    void beginRun(const std::string& name)
+    {
+        if (!isRecording) {
+            return;
+        }
+
+        Chunk chunk;
+        chunk.header = ChunkHeader{ ChunkHeader::run, static_cast<uint16_t>(++currentRun), name.size() };
+        chunk.name = name;
+        writer.push(std::move(chunk));
+    }
+
+    void record(size_t vertex, bool isLifted, bool isTop, unsigned recursionDepth)
+    {
+        if (!isRecording.load(std::memory_order_relaxed)) {
+            return;
+        }
+
+        ThreadBuffer& buffer = threadBuffer;
+        if (buffer.generation != generation) {
+            buffer.generation = generation;
+            buffer.records.clear();
+            buffer.records.reserve(bufferSize);
+        }
+
+        const uint8_t flags = (isLifted ? LiftRecord::isLiftedFlag : 0) | (isTop ? LiftRecord::isTopFlag : 0);
+        buffer.records.push_back(LiftRecord{ vertex, recursionDepth, static_cast<uint16_t>(currentRun.load(std::memory_order_relaxed)),
+            static_cast<uint8_t>(buffer.phase), flags });
+        if (buffer.records.size() == bufferSize) {
+            submit(buffer.records, buffer.thread);
+        }
+    }
+
+    PhaseScope::PhaseScope(LiftPhase phase)
+        : previous(threadBuffer.phase)
+    {
+        threadBuffer.phase = phase;
+    }
+
+    PhaseScope::~PhaseScope()
+    {
+        threadBuffer.phase = previous;
+    }
+} // LiftTrace
+
+} // PAPG
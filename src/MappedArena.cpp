@@ -0,0 +1,321 @@
+#include "MappedArena.hpp"
+#include "DecompressingStream.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include <sys/mman.h>
+
+namespace PAPG {
+
+namespace {
+    const char magic[8] = { 'P', 'A', 'P', 'G', 'C', 'S', 'R', '1' };
+
+    struct Header {
+        char magic[8];
+        uint64_t numVertices;
+        uint64_t numEdges;
+        uint64_t maxPriority;
+    };
+
+    // offsets of the arrays in the file, each 8 byte aligned
+    struct Layout {
+        size_t owners;
+        size_t priorities;
+        size_t outgoingOffsets;
+        size_t incomingOffsets;
+        size_t outgoingEdges;
+        size_t incomingEdges;
+        size_t size;
+
+        Layout(size_t numVertices, size_t numEdges)
+        {
+            auto align = [](size_t offset) { return (offset + 7) / 8 * 8; };
+            owners = sizeof(Header);
+            priorities = align(owners + numVertices);
+            outgoingOffsets = align(priorities + numVertices * sizeof(uint32_t));
+            incomingOffsets = outgoingOffsets + (numVertices + 1) * sizeof(uint64_t);
+            outgoingEdges = incomingOffsets + (numVertices + 1) * sizeof(uint64_t);
+            incomingEdges = outgoingEdges + numEdges * sizeof(uint32_t);
+            size = incomingEdges + numEdges * sizeof(uint32_t);
+        }
+    };
+
+    struct VertexLine {
+        uint64_t id = 0;
+        uint64_t priority = 0;
+        uint64_t owner = 0;
+        std::vector<uint32_t> successors;
+    };
+
+    // Reads a PGSolver game (which may be compressed) a vertex at a time,
+    // without the regular expressions of Parser as games here are large.
+    class GameReader {
+    private:
+        std::unique_ptr<std::istream> input;
+        std::string line;
+        size_t numVertices;
+
+        std::invalid_argument badLine() const
+        {
+            return std::invalid_argument("ERR: bad input file; malformed line: " + line);
+        }
+
+        // "<id> <priority> <owner> <successor>,...[ "<label>"];", the label is skipped
+        void parseVertexLine(VertexLine& vertex) const
+        {
+            const char* position = line.c_str();
+            auto next = [&](uint64_t& value) {
+                while (*position == ' ') {
+                    position++;
+                }
+                if (*position < '0' || *position > '9') {
+                    return false;
+                }
+                char* end = nullptr;
+                value = std::strtoull(position, &end, 10);
+                position = end;
+                return true;
+            };
+
+            if (!next(vertex.id) || !next(vertex.priority) || !next(vertex.owner)
+                || vertex.id >= numVertices || vertex.owner > 1 || vertex.priority > std::numeric_limits<uint32_t>::max()) {
+                throw badLine();
+            }
+
+            vertex.successors.clear();
+            uint64_t successor = 0;
+            while (next(successor)) {
+                if (successor >= numVertices) {
+                    throw badLine();
+                }
+                vertex.successors.push_back(static_cast<uint32_t>(successor));
+                if (*position != ',') {
+                    break;
+                }
+                position++;
+            }
+            if (vertex.successors.empty()) {
+                throw badLine();
+            }
+        }
+
+    public:
+        explicit GameReader(const std::string& path)
+            : numVertices(0)
+        {
+            const Compression compression = detectCompression(path);
+            if (compression != Compression::none) {
+                input.reset(new DecompressingStream(path, compression));
+            } else {
+                std::unique_ptr<std::ifstream> file(new std::ifstream(path));
+                if (!file->is_open()) {
+                    throw std::runtime_error("ERR: Failed to open file " + path);
+                }
+                input.reset(file.release());
+            }
+
+            const size_t digits = std::getline(*input, line) ? line.find_first_of("0123456789") : std::string::npos;
+            if (line.compare(0, 6, "parity") != 0 || digits == std::string::npos) {
+                throw std::invalid_argument("ERR: bad input file, missing or malformed header.");
+            }
+            numVertices = std::strtoull(line.c_str() + digits, nullptr, 10) + 1;
+            if (numVertices > std::numeric_limits<uint32_t>::max()) {
+                throw std::invalid_argument("ERR: too many vertices for a mapped arena.");
+            }
+        }
+
+        inline size_t getSize() const { return numVertices; }
+
+        // reads the next vertex, returns false at the end of the game
+        bool next(VertexLine& vertex)
+        {
+            while (std::getline(*input, line)) {
+                if (line.find_first_not_of(" \t\r") != std::string::npos) {
+                    parseVertexLine(vertex);
+                    return true;
+                }
+            }
+            return false;
+        }
+    };
+
+    template <typename T>
+    T* at(MappedFile& file, size_t offset)
+    {
+        return reinterpret_cast<T*>(file.getData() + offset);
+    }
+}
+
+MappedArena::MappedArena(MappedFile mappedFile)
+    : file(std::move(mappedFile))
+    , numVertices(0)
+    , numEdges(0)
+    , maxPriority(0)
+{
+    Header header;
+    if (file.getSize() < sizeof(Header)) {
+        throw std::invalid_argument("ERR: not a mapped arena file.");
+    }
+    std::memcpy(&header, file.getData(), sizeof(Header));
+    if (std::memcmp(header.magic, magic, sizeof(magic)) != 0
+        || Layout(header.numVertices, header.numEdges).size != file.getSize()) {
+        throw std::invalid_argument("ERR: not a mapped arena file.");
+    }
+
+    numVertices = header.numVertices;
+    numEdges = header.numEdges;
+    maxPriority = header.maxPriority;
+
+    const Layout layout(numVertices, numEdges);
+    owners = at<const uint8_t>(file, layout.owners);
+    priorities = at<const uint32_t>(file, layout.priorities);
+    outgoingOffsets = at<const uint64_t>(file, layout.outgoingOffsets);
+    incomingOffsets = at<const uint64_t>(file, layout.incomingOffsets);
+    outgoingEdges = at<const uint32_t>(file, layout.outgoingEdges);
+    incomingEdges = at<const uint32_t>(file, layout.incomingEdges);
+
+    // successors point anywhere, read-ahead would mostly fetch pages that aren't needed
+    file.advise(0, file.getSize(), MADV_RANDOM);
+}
+
+MappedArena MappedArena::build(const std::string& gamePath, bool isTemporary, const std::string& location)
+{
+    // first pass: everything but the edges, and the degrees to place them
+    GameReader firstPass(gamePath);
+    const size_t size = firstPass.getSize();
+
+    std::vector<uint8_t> vertexOwners(size, 0);
+    std::vector<uint32_t> vertexPriorities(size, 0);
+    std::vector<uint32_t> outDegrees(size, 0);
+    std::vector<uint64_t> inDegrees(size, 0);
+    std::vector<bool> isSeen(size, false);
+    // a vertex declared more than once is what its last declaration says, as
+    // with Parser; how often every vertex is declared is only kept once one is
+    std::vector<uint32_t> declarations;
+
+    VertexLine vertex;
+    while (firstPass.next(vertex)) {
+        if (!declarations.empty()) {
+            declarations[vertex.id]++;
+        } else if (isSeen[vertex.id]) {
+            declarations.assign(isSeen.begin(), isSeen.end());
+            declarations[vertex.id]++;
+        }
+        isSeen[vertex.id] = true;
+        vertexOwners[vertex.id] = static_cast<uint8_t>(vertex.owner);
+        vertexPriorities[vertex.id] = static_cast<uint32_t>(vertex.priority);
+        outDegrees[vertex.id] = vertex.successors.size();
+        for (const uint32_t successor : vertex.successors) {
+            inDegrees[successor]++;
+        }
+    }
+    std::vector<bool>().swap(isSeen);
+
+    // the in-degrees counted the edges of overridden declarations as well, count them again without
+    if (!declarations.empty()) {
+        std::fill(inDegrees.begin(), inDegrees.end(), 0);
+        std::vector<uint32_t> remaining(declarations);
+        GameReader recount(gamePath);
+        while (recount.next(vertex)) {
+            if (--remaining[vertex.id] == 0) {
+                for (const uint32_t successor : vertex.successors) {
+                    inDegrees[successor]++;
+                }
+            }
+        }
+    }
+
+    size_t edgeCount = 0;
+    for (const uint32_t degree : outDegrees) {
+        edgeCount += degree;
+    }
+    const size_t maxVertexPriority = vertexPriorities.empty() ? 0 : *std::max_element(vertexPriorities.begin(), vertexPriorities.end());
+
+    const Layout layout(size, edgeCount);
+    MappedFile mappedFile = isTemporary ? MappedFile::createTemporary(location, layout.size) : MappedFile::create(location, layout.size);
+
+    Header header;
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.numVertices = size;
+    header.numEdges = edgeCount;
+    header.maxPriority = maxVertexPriority;
+    std::memcpy(mappedFile.getData(), &header, sizeof(Header));
+
+    std::copy(vertexOwners.begin(), vertexOwners.end(), at<uint8_t>(mappedFile, layout.owners));
+    std::copy(vertexPriorities.begin(), vertexPriorities.end(), at<uint32_t>(mappedFile, layout.priorities));
+    std::vector<uint8_t>().swap(vertexOwners);
+    std::vector<uint32_t>().swap(vertexPriorities);
+
+    // the degrees become the offsets, the in-degrees the positions the predecessors are filled in at
+    uint64_t* outOffsets = at<uint64_t>(mappedFile, layout.outgoingOffsets);
+    uint64_t* inOffsets = at<uint64_t>(mappedFile, layout.incomingOffsets);
+    std::vector<uint64_t>& inPositions = inDegrees;
+    outOffsets[0] = 0;
+    inOffsets[0] = 0;
+    for (size_t id = 0; id < size; id++) {
+        outOffsets[id + 1] = outOffsets[id] + outDegrees[id];
+        inOffsets[id + 1] = inOffsets[id] + inDegrees[id];
+        inPositions[id] = inOffsets[id];
+    }
+    std::vector<uint32_t>().swap(outDegrees);
+
+    // second pass: the edges, in both directions
+    uint32_t* outEdges = at<uint32_t>(mappedFile, layout.outgoingEdges);
+    uint32_t* inEdges = at<uint32_t>(mappedFile, layout.incomingEdges);
+    GameReader secondPass(gamePath);
+    while (secondPass.next(vertex)) {
+        if (!declarations.empty() && --declarations[vertex.id] > 0) {
+            continue; // declared again further on
+        }
+        if (outOffsets[vertex.id + 1] - outOffsets[vertex.id] != vertex.successors.size()) {
+            throw std::runtime_error("ERR: " + gamePath + " changed while it was read.");
+        }
+        std::copy(vertex.successors.begin(), vertex.successors.end(), outEdges + outOffsets[vertex.id]);
+        for (const uint32_t successor : vertex.successors) {
+            inEdges[inPositions[successor]++] = static_cast<uint32_t>(vertex.id);
+        }
+    }
+
+    return MappedArena(std::move(mappedFile));
+}
+
+MappedArena MappedArena::build(const std::string& gamePath, const std::string& arenaPath)
+{
+    return build(gamePath, false, arenaPath);
+}
+
+MappedArena MappedArena::buildTemporary(const std::string& gamePath, const std::string& directory)
+{
+    return build(gamePath, true, directory);
+}
+
+MappedArena MappedArena::open(const std::string& arenaPath)
+{
+    return MappedArena(MappedFile::open(arenaPath));
+}
+
+void MappedArena::willNeed(size_t begin, size_t end) const
+{
+    if (begin >= end) {
+        return;
+    }
+
+    const Layout layout(numVertices, numEdges);
+    file.advise(layout.owners + begin, end - begin, MADV_WILLNEED);
+    file.advise(layout.priorities + begin * sizeof(uint32_t), (end - begin) * sizeof(uint32_t), MADV_WILLNEED);
+    file.advise(layout.outgoingOffsets + begin * sizeof(uint64_t), (end - begin + 1) * sizeof(uint64_t), MADV_WILLNEED);
+    file.advise(layout.incomingOffsets + begin * sizeof(uint64_t), (end - begin + 1) * sizeof(uint64_t), MADV_WILLNEED);
+    file.advise(layout.outgoingEdges + outgoingOffsets[begin] * sizeof(uint32_t),
+        (outgoingOffsets[end] - outgoingOffsets[begin]) * sizeof(uint32_t), MADV_WILLNEED);
+    file.advise(layout.incomingEdges + incomingOffsets[begin] * sizeof(uint32_t),
+        (incomingOffsets[end] - incomingOffsets[begin]) * sizeof(uint32_t), MADV_WILLNEED);
+}
+
+} // PAPG
@@ -0,0 +1,168 @@
+#include "MappedFile.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace PAPG {
+
+namespace {
+    std::string describeError(const std::string& what, const std::string& path)
+    {
+        return "ERR: failed to " + what + " " + path + ": " + std::strerror(errno);
+    }
+
+    // grows the file behind descriptor to size, it reads back as zeroes
+    void resizeFile(int descriptor, size_t size, const std::string& path)
+    {
+        if (::ftruncate(descriptor, static_cast<off_t>(size)) != 0) {
+            const std::string message = describeError("resize", path);
+            ::close(descriptor);
+            throw std::runtime_error(message);
+        }
+    }
+}
+
+MappedFile::MappedFile()
+    : descriptor(-1)
+    , data(nullptr)
+    , size(0)
+{
+}
+
+MappedFile::MappedFile(int descriptor, size_t size, bool isWritable)
+    : descriptor(descriptor)
+    , data(nullptr)
+    , size(size)
+{
+    if (size == 0) {
+        return; // nothing to map, mmap() doesn't take empty mappings
+    }
+
+    void* mapping = ::mmap(nullptr, size, isWritable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, descriptor, 0);
+    if (mapping == MAP_FAILED) {
+        const std::string message = std::string("ERR: failed to map file: ") + std::strerror(errno);
+        ::close(descriptor);
+        throw std::runtime_error(message);
+    }
+    data = static_cast<char*>(mapping);
+}
+
+MappedFile MappedFile::create(const std::string& path, size_t size)
+{
+    const int descriptor = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (descriptor < 0) {
+        throw std::runtime_error(describeError("create", path));
+    }
+    resizeFile(descriptor, size, path);
+    return MappedFile(descriptor, size, true);
+}
+
+MappedFile MappedFile::createTemporary(const std::string& directory, size_t size)
+{
+    const std::string pattern = directory + "/papg-XXXXXX";
+    std::vector<char> path(pattern.begin(), pattern.end());
+    path.push_back('\0');
+
+    const int descriptor = ::mkstemp(path.data());
+    if (descriptor < 0) {
+        throw std::runtime_error(describeError("create a file in", directory));
+    }
+    ::unlink(path.data());
+    resizeFile(descriptor, size, path.data());
+    return MappedFile(descriptor, size, true);
+}
+
+MappedFile MappedFile::createShared(size_t size)
+{
+    // unique within the machine while it exists, which is only until shm_unlink()
+    static std::atomic<unsigned> numCreated(0);
+    const std::string name = "/papg-" + std::to_string(::getpid()) + "-" + std::to_string(numCreated++);
+
+    const int descriptor = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (descriptor < 0) {
+        throw std::runtime_error(describeError("create shared memory", name));
+    }
+    ::shm_unlink(name.c_str());
+    resizeFile(descriptor, size, name);
+    return MappedFile(descriptor, size, true);
+}
+
+MappedFile MappedFile::open(const std::string& path)
+{
+    const int descriptor = ::open(path.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+        throw std::runtime_error(describeError("open", path));
+    }
+
+    struct stat status;
+    if (::fstat(descriptor, &status) != 0) {
+        const std::string message = describeError("stat", path);
+        ::close(descriptor);
+        throw std::runtime_error(message);
+    }
+    return MappedFile(descriptor, status.st_size, false);
+}
+
+MappedFile::MappedFile(MappedFile&& other)
+    : descriptor(other.descriptor)
+    , data(other.data)
+    , size(other.size)
+{
+    other.descriptor = -1;
+    other.data = nullptr;
+    other.size = 0;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other)
+{
+    if (this != &other) {
+        this->~MappedFile();
+        descriptor = other.descriptor;
+        data = other.data;
+        size = other.size;
+        other.descriptor = -1;
+        other.data = nullptr;
+        other.size = 0;
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile()
+{
+    if (data != nullptr) {
+        ::munmap(data, size);
+    }
+    if (descriptor >= 0) {
+        ::close(descriptor);
+    }
+}
+
+void MappedFile::advise(size_t offset, size_t length, int advice) const
+{
+    if (data == nullptr || offset >= size || length == 0) {
+        return;
+    }
+
+    static const size_t pageSize = ::sysconf(_SC_PAGESIZE);
+    const size_t begin = offset / pageSize * pageSize;
+    const size_t end = std::min(size, offset + length);
+    ::madvise(data + begin, end - begin, advice);
+}
+
+std::string MappedFile::getTemporaryDirectory()
+{
+    const char* directory = std::getenv("TMPDIR");
+    return (directory != nullptr && *directory != '\0') ? directory : "/tmp";
+}
+
+} // PAPG
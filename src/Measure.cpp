@@ -48,52 +48,6 @@ unsigned Measure::getValue(size_t index) const
     return oddValues[convertIndex(index)];
 }
 
-Measure& Measure::operator=(const Measure& rhs)
-{
-    this->oddValues = rhs.oddValues;
-    this->size = rhs.size;
-    this->maxValue = rhs.maxValue;
-    this->isToppedOut = rhs.isToppedOut;
-
-    return *this;
-}
-
-bool Measure::operator==(const Measure& rhs) const
-{
-    return (this == &rhs)
-        || (this->isTop() && rhs.isTop()) // if both are top, they are considered equal
-        || (!this->isTop() && !rhs.isTop() // if not both of them are top, neither should be
-               && this->oddValues == rhs.oddValues
-               && this->size == rhs.size);
-}
-
-bool Measure::operator!=(const Measure& rhs) const
-{
-    return !(*this == rhs);
-}
-
-bool Measure::operator<(const Measure& rhs) const
-{
-    if (rhs.isTop()) {
-        return true;
-    } else if (this->isTop()) {
-        return false;
-    }
-
-    return std::lexicographical_compare(this->oddValues.begin(), this->oddValues.end(), rhs.oddValues.begin(), rhs.oddValues.end());
-}
-
-bool Measure::operator>(const Measure& rhs) const
-{
-    if (this->isTop()) {
-        return true;
-    } else if (rhs.isTop()) {
-        return false;
-    }
-
-    return rhs < *this;
-}
-
 bool Measure::operator<=(const Measure& rhs) const
 {
     if (rhs.isTop()) {
@@ -142,42 +96,22 @@ bool Measure::partialGreaterOrEqual(size_t boundary, const Measure& rhs) const
     return !(rhs.partialGreater(boundary, *this));
 }
 
-bool Measure::partialIncrementIfAble(size_t boundary)
+size_t Measure::getHash() const
 {
-    for (int i = convertIndex(boundary); i >= 0; i--) {
-        if (oddValues[i] < maxValue->oddValues[i]) {
-            // value lower than max, we can incremement it
-            oddValues[i]++;
-            return true;
-        }
+    if (isTop()) {
+        return 0;
     }
 
-    return false;
+    size_t hash = size;
+    for (const unsigned value : oddValues) {
+        hash ^= value + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2);
+    }
+    return hash;
 }
 
-void Measure::makePartialEqualOf(size_t boundary, const Measure& other)
+size_t Measure::getMemoryUsage() const
 {
-    if (boundary >= size || boundary >= other.size) {
-        throw std::out_of_range("makePartialEqualOf(): Measure boundary out of range!");
-    }
-
-    if (this == &other) {
-        // if this and other are equal it means we are trying to make ourselves equal to ourselves, do nothing and return.
-        return;
-    }
-
-    if (other.isTop()) {
-        makeTop();
-        return;
-    }
-
-    size_t i = 0;
-    for (; i < (boundary + 1) / 2; i++) {
-        oddValues[i] = other.oddValues[i];
-    }
-    for (; i < oddValues.size(); i++) {
-        oddValues[i] = 0;
-    }
+    return sizeof(Measure) + oddValues.capacity() * sizeof(unsigned);
 }
 
 std::ostream& operator<<(std::ostream& stream, const Measure& measure)
@@ -0,0 +1,391 @@
+#include "MeasureStore.hpp"
+#include "Measure.hpp"
+#include "SuccinctMeasure.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include <sys/mman.h>
+
+namespace PAPG {
+
+template <typename MeasureType>
+void FlatMeasureStore<MeasureType>::reset(size_t size, const MeasureType& maxMeasure)
+{
+    // measures can't be moved around, the table must not reallocate while it
+    // holds any; those already there are set to bottom, keeping their storage
+    if (size > measures.capacity()) {
+        measures.clear();
+        measures.reserve(size);
+    }
+    if (measures.size() > size) {
+        measures.erase(measures.begin() + size, measures.end());
+    }
+
+    const MeasureType bottom(maxMeasure);
+    for (auto& measure : measures) {
+        measure = bottom;
+    }
+    while (measures.size() < size) {
+        measures.emplace_back(MeasureType(maxMeasure));
+    }
+}
+
+template <typename MeasureType>
+bool FlatMeasureStore<MeasureType>::set(size_t vertex, const MeasureType& value)
+{
+    if (value == measures[vertex]) {
+        return false;
+    }
+    measures[vertex] = value;
+    return true;
+}
+
+template <typename MeasureType>
+size_t FlatMeasureStore<MeasureType>::getMemoryUsage() const
+{
+    size_t bytes = (measures.capacity() - measures.size()) * sizeof(MeasureType);
+    for (const auto& measure : measures) {
+        bytes += measure.getMemoryUsage();
+    }
+    return bytes;
+}
+
+template <typename MeasureType>
+InternedMeasureStore<MeasureType>::InternedMeasureStore()
+    : numValues(0)
+    , maxValues(0)
+{
+}
+
+template <typename MeasureType>
+void InternedMeasureStore<MeasureType>::reset(size_t size, const MeasureType& maxMeasure)
+{
+    if (size > std::numeric_limits<uint32_t>::max()) {
+        throw std::length_error("InternedMeasureStore: too many vertices for 32 bit handles!");
+    }
+
+    values.clear();
+    references.clear();
+    freeHandles.clear();
+    index.clear();
+
+    // everything starts out at the bottom measure, handle 0
+    values.emplace_back(maxMeasure);
+    references.push_back(size);
+    index.emplace(values.front().getHash(), 0);
+    handles.assign(size, 0);
+
+    numValues = (size > 0) ? 1 : 0;
+    maxValues = numValues;
+}
+
+template <typename MeasureType>
+uint32_t InternedMeasureStore<MeasureType>::intern(const MeasureType& value)
+{
+    const size_t hash = value.getHash();
+
+    const auto range = index.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (values[it->second] == value) {
+            return it->second;
+        }
+    }
+
+    uint32_t handle;
+    if (!freeHandles.empty()) {
+        handle = freeHandles.back();
+        freeHandles.pop_back();
+        values[handle] = value;
+    } else {
+        handle = values.size();
+        values.emplace_back(value); // a Measure constructed from another is the bottom of its space,
+        values.back() = value; // only assigning copies the value
+        references.push_back(0);
+    }
+    index.emplace(hash, handle);
+    return handle;
+}
+
+template <typename MeasureType>
+void InternedMeasureStore<MeasureType>::release(uint32_t handle)
+{
+    if (--references[handle] > 0) {
+        return;
+    }
+
+    const auto range = index.equal_range(values[handle].getHash());
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == handle) {
+            index.erase(it);
+            break;
+        }
+    }
+    freeHandles.push_back(handle);
+    numValues--;
+}
+
+template <typename MeasureType>
+bool InternedMeasureStore<MeasureType>::set(size_t vertex, const MeasureType& value)
+{
+    const uint32_t handle = intern(value);
+    const uint32_t oldHandle = handles[vertex];
+    if (handle == oldHandle) {
+        return false;
+    }
+
+    if (references[handle]++ == 0) {
+        numValues++;
+        maxValues = std::max(maxValues, numValues);
+    }
+    handles[vertex] = handle;
+    release(oldHandle);
+    return true;
+}
+
+template <typename MeasureType>
+size_t InternedMeasureStore<MeasureType>::getMemoryUsage() const
+{
+    size_t bytes = handles.capacity() * sizeof(uint32_t)
+        + references.capacity() * sizeof(uint32_t)
+        + freeHandles.capacity() * sizeof(uint32_t);
+
+    for (const auto& value : values) {
+        bytes += value.getMemoryUsage();
+    }
+
+    // a node per entry holding the entry and the next pointer, and the buckets
+    bytes += index.size() * (sizeof(void*) + sizeof(std::pair<const size_t, uint32_t>))
+        + index.bucket_count() * sizeof(void*);
+
+    return bytes;
+}
+
+template <typename MeasureType>
+MappedMeasureStore<MeasureType>::MappedMeasureStore()
+    : directory(MappedFile::getTemporaryDirectory())
+    , file()
+    , maxMeasure(nullptr)
+    , numVertices(0)
+    , numComponents(0)
+{
+}
+
+template <typename MeasureType>
+void MappedMeasureStore<MeasureType>::reset(size_t size, const MeasureType& newMaxMeasure)
+{
+    maxMeasure = &newMaxMeasure;
+    numVertices = size;
+    numComponents = newMaxMeasure.getSize() / 2;
+
+    // a new file reads as zeroes, which is the bottom measure everywhere
+    file = MappedFile();
+    file = MappedFile::createTemporary(directory, size * getRecordSize());
+}
+
+template <typename MeasureType>
+void MappedMeasureStore<MeasureType>::get(size_t vertex, MeasureType& measure) const
+{
+    const uint32_t* record = getRecord(vertex);
+
+    if (record[0]) {
+        measure.makeTop();
+        return;
+    }
+    measure.clearTop();
+    for (size_t i = 0; i < numComponents; i++) {
+        measure.setComponent(i, record[1 + i]);
+    }
+}
+
+template <typename MeasureType>
+void MappedMeasureStore<MeasureType>::getPartial(size_t vertex, size_t boundary, MeasureType& measure) const
+{
+    const uint32_t* record = getRecord(vertex);
+
+    if (record[0]) {
+        measure.makeTop();
+        return;
+    }
+    const size_t numCopied = (boundary + 1) / 2;
+    for (size_t i = 0; i < numComponents; i++) {
+        measure.setComponent(i, (i < numCopied) ? record[1 + i] : 0);
+    }
+}
+
+template <typename MeasureType>
+bool MappedMeasureStore<MeasureType>::isEqual(size_t vertex, const MeasureType& value) const
+{
+    const uint32_t* record = getRecord(vertex);
+
+    if (record[0] || value.isTop()) {
+        return record[0] && value.isTop(); // all top measures are equal, whatever their values
+    }
+    for (size_t i = 0; i < numComponents; i++) {
+        if (record[1 + i] != value.getComponent(i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename MeasureType>
+bool MappedMeasureStore<MeasureType>::set(size_t vertex, const MeasureType& value)
+{
+    uint32_t* record = getRecord(vertex);
+    const uint32_t isTop = value.isTop();
+
+    if (record[0] && isTop) {
+        return false; // all top measures are equal, whatever their values
+    }
+    bool isChanged = (record[0] != isTop);
+    record[0] = isTop;
+    if (isTop) {
+        return true;
+    }
+
+    for (size_t i = 0; i < numComponents; i++) {
+        const uint32_t component = value.getComponent(i);
+        if (record[1 + i] != component) {
+            record[1 + i] = component;
+            isChanged = true;
+        }
+    }
+    return isChanged;
+}
+
+template <typename MeasureType>
+void MappedMeasureStore<MeasureType>::willNeed(size_t begin, size_t end) const
+{
+    if (begin < end) {
+        file.advise(begin * getRecordSize(), (end - begin) * getRecordSize(), MADV_WILLNEED);
+    }
+}
+
+// a record is read and written word by word, by processes that share nothing but the memory
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t) && ATOMIC_INT_LOCK_FREE == 2, "shared measures need lock-free 32 bit atomics");
+
+template <typename MeasureType>
+SharedMeasureStore<MeasureType>::SharedMeasureStore()
+    : memory()
+    , maxMeasure(nullptr)
+    , numVertices(0)
+    , numComponents(0)
+{
+}
+
+template <typename MeasureType>
+void SharedMeasureStore<MeasureType>::reset(size_t size, const MeasureType& newMaxMeasure)
+{
+    maxMeasure = &newMaxMeasure;
+    numVertices = size;
+    numComponents = newMaxMeasure.getSize() / 2;
+
+    // new shared memory reads as zeroes: sequence 0 and the bottom measure everywhere
+    memory = MappedFile();
+    memory = MappedFile::createShared(size * getRecordSize() * sizeof(uint32_t));
+}
+
+template <typename MeasureType>
+void SharedMeasureStore<MeasureType>::get(size_t vertex, MeasureType& measure) const
+{
+    const std::atomic<uint32_t>* record = getRecord(vertex);
+
+    bool isTop;
+    uint32_t sequence;
+    do {
+        sequence = beginRead(record);
+        isTop = record[1].load(std::memory_order_relaxed);
+        for (size_t i = 0; i < numComponents && !isTop; i++) {
+            measure.setComponent(i, record[2 + i].load(std::memory_order_relaxed));
+        }
+    } while (!isReadValid(record, sequence));
+
+    if (isTop) {
+        measure.makeTop();
+    } else {
+        measure.clearTop();
+    }
+}
+
+template <typename MeasureType>
+void SharedMeasureStore<MeasureType>::getPartial(size_t vertex, size_t boundary, MeasureType& measure) const
+{
+    const std::atomic<uint32_t>* record = getRecord(vertex);
+    const size_t numCopied = std::min((boundary + 1) / 2, numComponents);
+
+    bool isTop;
+    uint32_t sequence;
+    do {
+        sequence = beginRead(record);
+        isTop = record[1].load(std::memory_order_relaxed);
+        for (size_t i = 0; i < numCopied && !isTop; i++) {
+            measure.setComponent(i, record[2 + i].load(std::memory_order_relaxed));
+        }
+    } while (!isReadValid(record, sequence));
+
+    if (isTop) {
+        measure.makeTop();
+        return;
+    }
+    for (size_t i = numCopied; i < numComponents; i++) {
+        measure.setComponent(i, 0);
+    }
+}
+
+template <typename MeasureType>
+bool SharedMeasureStore<MeasureType>::isEqual(size_t vertex, const MeasureType& value) const
+{
+    const std::atomic<uint32_t>* record = getRecord(vertex);
+
+    bool isSame;
+    uint32_t sequence;
+    do {
+        sequence = beginRead(record);
+        const bool isTop = record[1].load(std::memory_order_relaxed);
+        isSame = isTop == value.isTop(); // all top measures are equal, whatever their values
+        for (size_t i = 0; i < numComponents && isSame && !isTop; i++) {
+            isSame = record[2 + i].load(std::memory_order_relaxed) == value.getComponent(i);
+        }
+    } while (!isReadValid(record, sequence));
+
+    return isSame;
+}
+
+template <typename MeasureType>
+bool SharedMeasureStore<MeasureType>::set(size_t vertex, const MeasureType& value)
+{
+    std::atomic<uint32_t>* record = getRecord(vertex);
+    const uint32_t isTop = value.isTop();
+    const uint32_t wasTop = record[1].load(std::memory_order_relaxed);
+
+    // only this process writes the record, so it can read it without retrying
+    bool isChanged = wasTop != isTop;
+    for (size_t i = 0; i < numComponents && !isChanged && !isTop; i++) {
+        isChanged = record[2 + i].load(std::memory_order_relaxed) != value.getComponent(i);
+    }
+    if (!isChanged) {
+        return false; // all top measures are equal, whatever their values
+    }
+
+    const uint32_t sequence = record[0].load(std::memory_order_relaxed);
+    record[0].store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    record[1].store(isTop, std::memory_order_relaxed);
+    if (!isTop) {
+        for (size_t i = 0; i < numComponents; i++) {
+            record[2 + i].store(value.getComponent(i), std::memory_order_relaxed);
+        }
+    }
+    record[0].store(sequence + 2, std::memory_order_release);
+    return true;
+}
+
+template class FlatMeasureStore<Measure>;
+template class FlatMeasureStore<SuccinctMeasure>;
+template class InternedMeasureStore<Measure>;
+template class MappedMeasureStore<Measure>;
+template class SharedMeasureStore<Measure>;
+
+} // PAPG
@@ -0,0 +1,237 @@
+#include "PPSolver.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace PAPG {
+
+namespace {
+    const size_t noStrategy = std::numeric_limits<size_t>::max();
+
+    inline Player playerOf(size_t priority) { return (priority % 2) ? Player::odd : Player::even; }
+}
+
+PPSolver::PPSolver(const Arena& arena)
+    : arena(&arena)
+    , attractor(arena)
+    , region(arena.getSize(), 0)
+    , strategy(arena.getSize(), noStrategy)
+    , control(nullptr)
+    , numPromotions(0)
+    , numResets(0)
+    , numRecoveries(0)
+    , numDominions(0)
+{
+}
+
+void PPSolver::reset(const Arena& newArena)
+{
+    arena = &newArena;
+    attractor.reset(newArena);
+    region.assign(newArena.getSize(), 0);
+    strategy.assign(newArena.getSize(), noStrategy);
+    numPromotions = 0;
+    numResets = 0;
+    numRecoveries = 0;
+    numDominions = 0;
+}
+
+bool PPSolver::isRecoverable(const VertexSet& subgame, const VertexSet& seeds, Player player) const
+{
+    // A region kept from before can only be reused as a whole if the opponent
+    // can't leave its kept part downwards and player's strategy still stays
+    // in it. Otherwise a new attractor could let the opponent go around in
+    // a cycle through the kept part that player doesn't win. Vertices that
+    // have the region's priority themselves are fine either way.
+    bool recoverable = true;
+
+    seeds.forEach([&](size_t id) {
+        const Vertex& vertex = (*arena)[id];
+        if (!recoverable || vertex.priority == region[id]) {
+            return;
+        }
+
+        if (vertex.owner == player) {
+            recoverable = strategy[id] != noStrategy && seeds.contains(strategy[id]);
+        } else {
+            recoverable = std::none_of(vertex.outgoing.begin(), vertex.outgoing.end(), [&](size_t successor) {
+                return subgame.contains(successor) && !seeds.contains(successor);
+            });
+        }
+    });
+
+    return recoverable;
+}
+
+VertexSet PPSolver::searchDominion(const VertexSet& game, Variant variant, Player& winner)
+{
+    size_t priority = std::numeric_limits<size_t>::max();
+    game.forEach([&](size_t id) {
+        region[id] = (*arena)[id].priority;
+        strategy[id] = noStrategy;
+        priority = std::min(priority, (*arena)[id].priority);
+    });
+
+    std::vector<bool> isReset(arena->getMaxPriority() + 1, false);
+    bool isPromoted = false; // whether we got to the current priority by promotion rather than by moving down
+
+    while (true) {
+        const Player player = playerOf(priority);
+
+        // the subgame consists of everything that is not in a more significant region
+        VertexSet subgame(arena->getSize());
+        VertexSet current(arena->getSize());
+        game.forEach([&](size_t id) {
+            if (region[id] >= priority) {
+                subgame.insert(id);
+            }
+            if (region[id] == priority) {
+                current.insert(id);
+            }
+        });
+
+        if (!isPromoted && !isRecoverable(subgame, current, player)) {
+            // what is left of the region that was kept no longer holds up,
+            // start over from the vertices that have this priority themselves
+            numRecoveries++;
+            current.forEach([&](size_t id) {
+                if ((*arena)[id].priority != priority) {
+                    region[id] = (*arena)[id].priority;
+                    strategy[id] = noStrategy;
+                    current.erase(id);
+                }
+            });
+        }
+
+        if (control != nullptr) {
+            control->check(Progress());
+        }
+
+        attractor.attract(subgame, current, player, &strategy);
+
+        // Check whether the region is closed in the subgame, meaning the
+        // opponent can't leave it other than to more significant regions and
+        // player can always stay in it. For the opponent's escapes, remember
+        // the least significant region they lead to.
+        bool isClosed = !current.empty(); // a recovery can leave nothing at this priority
+        bool hasEscape = false;
+        size_t escapePriority = 0;
+
+        current.forEach([&](size_t id) {
+            region[id] = priority;
+            const Vertex& vertex = (*arena)[id];
+
+            if (vertex.owner == player) {
+                if (strategy[id] == noStrategy || !current.contains(strategy[id])) {
+                    auto successor = std::find_if(vertex.outgoing.begin(), vertex.outgoing.end(), [&](size_t s) { return current.contains(s); });
+                    if (successor != vertex.outgoing.end()) {
+                        strategy[id] = *successor;
+                    } else {
+                        strategy[id] = noStrategy;
+                        isClosed = false;
+                    }
+                }
+            } else {
+                for (const size_t successor : vertex.outgoing) {
+                    if (!game.contains(successor) || current.contains(successor)) {
+                        continue;
+                    }
+                    if (subgame.contains(successor)) {
+                        isClosed = false;
+                    } else {
+                        escapePriority = hasEscape ? std::max(escapePriority, region[successor]) : region[successor];
+                        hasEscape = true;
+                    }
+                }
+            }
+        });
+
+        if (!isClosed) {
+            // move on to the next region down
+            size_t next = std::numeric_limits<size_t>::max();
+            (subgame - current).forEach([&](size_t id) {
+                next = std::min(next, region[id]);
+            });
+
+            if (next == std::numeric_limits<size_t>::max()) {
+                throw std::logic_error("searchDominion(): open region without a subgame below it!");
+            }
+
+            priority = next;
+            isPromoted = false;
+            continue;
+        }
+
+        if (!hasEscape) {
+            winner = player;
+            return current;
+        }
+
+        // promote the region to the region the opponent escapes to, and reset
+        // (some of) the regions in between
+        numPromotions++;
+
+        current.forEach([&](size_t id) {
+            region[id] = escapePriority;
+        });
+
+        std::fill(isReset.begin(), isReset.end(), false);
+        game.forEach([&](size_t id) {
+            if (region[id] <= escapePriority || region[id] == (*arena)[id].priority) {
+                return;
+            }
+
+            const bool reset = variant == Variant::priorityPromotion
+                || (variant == Variant::priorityPromotionPlus && playerOf(region[id]) != player);
+
+            if (reset) {
+                isReset[region[id]] = true;
+                region[id] = (*arena)[id].priority;
+                strategy[id] = noStrategy;
+            }
+        });
+        numResets += std::count(isReset.begin(), isReset.end(), true);
+
+        priority = escapePriority;
+        isPromoted = true;
+    }
+}
+
+std::vector<Player> PPSolver::solve(Variant variant)
+{
+    std::vector<Player> result(arena->getSize(), Player::even);
+    VertexSet game(arena->getSize(), true);
+
+    while (!game.empty()) {
+        Player winner = Player::even;
+        VertexSet dominion = searchDominion(game, variant, winner);
+        numDominions++;
+
+        attractor.attract(game, dominion, winner);
+
+        dominion.forEach([&](size_t id) {
+            result[id] = winner;
+        });
+        game -= dominion;
+    }
+
+    return result;
+}
+
+std::vector<Player> PPSolver::solvePriorityPromotion()
+{
+    return solve(Variant::priorityPromotion);
+}
+
+std::vector<Player> PPSolver::solvePriorityPromotionPlus()
+{
+    return solve(Variant::priorityPromotionPlus);
+}
+
+std::vector<Player> PPSolver::solveRegionRecovery()
+{
+    return solve(Variant::regionRecovery);
+}
+
+} // PAPG
@@ -0,0 +1,121 @@
+#include "PerfCounters.hpp"
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace PAPG {
+
+#ifdef __linux__
+
+namespace {
+    struct EventType {
+        const char* name;
+        uint32_t type;
+        uint64_t config;
+    };
+
+    const EventType eventTypes[] = {
+        { "cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+        { "instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+        { "cache misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+        { "branch misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+        { "page faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS },
+    };
+
+    // the value and how long the counter was enabled and actually counting, as read() gives them
+    struct Reading {
+        uint64_t value;
+        uint64_t timeEnabled;
+        uint64_t timeRunning;
+    };
+}
+
+PerfCounters::PerfCounters()
+    : events()
+    , error()
+{
+    for (const EventType& eventType : eventTypes) {
+        perf_event_attr attributes;
+        std::memset(&attributes, 0, sizeof(attributes));
+        attributes.size = sizeof(attributes);
+        attributes.type = eventType.type;
+        attributes.config = eventType.config;
+        attributes.disabled = 1;
+        attributes.inherit = 1; // threads started while counting, like those of the attractor
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        const int descriptor = static_cast<int>(::syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+        if (descriptor < 0) {
+            if (error.empty()) {
+                error = std::string(eventType.name) + ": " + std::strerror(errno);
+            }
+            continue;
+        }
+        events.push_back(Event{ eventType.name, descriptor });
+    }
+}
+
+PerfCounters::~PerfCounters()
+{
+    for (const Event& event : events) {
+        ::close(event.descriptor);
+    }
+}
+
+void PerfCounters::start()
+{
+    for (const Event& event : events) {
+        ::ioctl(event.descriptor, PERF_EVENT_IOC_RESET, 0);
+        ::ioctl(event.descriptor, PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+void PerfCounters::stop(Counters& counters)
+{
+    for (const Event& event : events) {
+        ::ioctl(event.descriptor, PERF_EVENT_IOC_DISABLE, 0);
+    }
+
+    for (const Event& event : events) {
+        Reading reading;
+        if (::read(event.descriptor, &reading, sizeof(reading)) != sizeof(reading) || reading.timeRunning == 0) {
+            continue; // never got on the hardware, there is nothing to scale
+        }
+        const double scale = static_cast<double>(reading.timeEnabled) / reading.timeRunning;
+        counters.emplace_back(event.name, static_cast<unsigned long long>(reading.value * scale + 0.5));
+    }
+}
+
+#else
+
+PerfCounters::PerfCounters()
+    : events()
+    , error("perf_event_open() is only available on Linux")
+{
+}
+
+PerfCounters::~PerfCounters()
+{
+}
+
+void PerfCounters::start()
+{
+}
+
+void PerfCounters::stop(Counters&)
+{
+}
+
+#endif
+
+} // PAPG
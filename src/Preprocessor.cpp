@@ -0,0 +1,153 @@
+#include "Preprocessor.hpp"
+#include "Attractor.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+namespace PAPG {
+
+namespace {
+    const size_t notInResidual = std::numeric_limits<size_t>::max();
+}
+
+Preprocessor::Preprocessor(const Arena& arena)
+    : arena(arena)
+    , winners(arena.getSize(), Player::even)
+    , strategy(arena.getSize(), notInResidual)
+    , decided(arena.getSize())
+    , residual(0)
+    , originalIds()
+    , numDominions(0)
+{
+}
+
+bool Preprocessor::isSelfLoopDominion(const VertexSet& game, size_t id, Player player) const
+{
+    const Vertex& vertex = arena[id];
+
+    if ((vertex.isPriorityEven() ? Player::even : Player::odd) != player) {
+        return false;
+    }
+
+    if (std::find(vertex.outgoing.begin(), vertex.outgoing.end(), id) == vertex.outgoing.end()) {
+        return false;
+    }
+
+    // the owner picks the loop itself, the opponent only when it has no way out
+    return vertex.owner == player || std::all_of(vertex.outgoing.begin(), vertex.outgoing.end(), [&](size_t successor) {
+        return successor == id || !game.contains(successor);
+    });
+}
+
+void Preprocessor::run()
+{
+    VertexSet game(arena.getSize(), true);
+    VertexSet candidates(arena.getSize(), true);
+    Attractor attractor(arena);
+    attractor.setMaxThreads(std::thread::hardware_concurrency());
+
+    while (!candidates.empty()) {
+        VertexSet removed(arena.getSize());
+
+        for (const Player player : { Player::even, Player::odd }) {
+            VertexSet region(arena.getSize());
+            candidates.forEach([&](size_t id) {
+                if (game.contains(id) && isSelfLoopDominion(game, id, player)) {
+                    region.insert(id);
+                    numDominions++;
+                    if (arena[id].owner == player) {
+                        strategy[id] = id;
+                    }
+                }
+            });
+
+            if (region.empty()) {
+                continue;
+            }
+
+            attractor.attract(game, region, player, &strategy);
+
+            region.forEach([&](size_t id) {
+                winners[id] = player;
+            });
+            game -= region;
+            removed |= region;
+        }
+
+        // only the opponent's vertices next to a removed part can have lost
+        // their last way out of a self-loop
+        candidates.clear();
+        removed.forEach([&](size_t id) {
+            for (const size_t predecessor : arena[id].incoming) {
+                if (game.contains(predecessor)) {
+                    candidates.insert(predecessor);
+                }
+            }
+        });
+    }
+
+    decided = VertexSet(arena.getSize(), true);
+    decided -= game;
+
+    buildResidual();
+}
+
+void Preprocessor::buildResidual()
+{
+    std::vector<size_t> residualIds(arena.getSize(), notInResidual);
+
+    originalIds.clear();
+    for (size_t id = 0; id < arena.getSize(); id++) {
+        if (!decided.contains(id)) {
+            residualIds[id] = originalIds.size();
+            originalIds.push_back(id);
+        }
+    }
+
+    residual = Arena(originalIds.size());
+    for (size_t i = 0; i < originalIds.size(); i++) {
+        const Vertex& vertex = arena[originalIds[i]];
+
+        residual.setVertexOwner(i, vertex.owner);
+        residual.setVertexPriority(i, vertex.priority);
+        residual.setVertexLabel(i, vertex.label);
+
+        // the residual is a trap for both players, every vertex keeps a successor
+        for (const size_t successor : vertex.outgoing) {
+            if (residualIds[successor] != notInResidual) {
+                residual.addEdge(i, residualIds[successor]);
+            }
+        }
+    }
+}
+
+std::vector<Player> Preprocessor::mergeResults(const std::vector<Player>& residualResults) const
+{
+    if (residualResults.size() != originalIds.size()) {
+        throw std::invalid_argument("mergeResults(): results don't match the residual arena!");
+    }
+
+    std::vector<Player> results = winners;
+    for (size_t i = 0; i < originalIds.size(); i++) {
+        results[originalIds[i]] = residualResults[i];
+    }
+    return results;
+}
+
+std::vector<size_t> Preprocessor::mergeStrategy(const std::vector<size_t>& residualStrategy) const
+{
+    if (residualStrategy.size() != originalIds.size()) {
+        throw std::invalid_argument("mergeStrategy(): strategy doesn't match the residual arena!");
+    }
+
+    std::vector<size_t> result = strategy;
+    for (size_t i = 0; i < originalIds.size(); i++) {
+        const size_t successor = residualStrategy[i];
+        result[originalIds[i]] = (successor < originalIds.size()) ? originalIds[successor] : successor;
+    }
+    return result;
+}
+
+} // PAPG
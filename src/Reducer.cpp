@@ -0,0 +1,265 @@
+#include "Reducer.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+namespace PAPG {
+
+namespace {
+    const size_t noVertex = std::numeric_limits<size_t>::max();
+
+    // Most games are stable after a handful of rounds, a game that isn't after
+    // this many is left unrefined rather than paying a round per vertex.
+    const unsigned maxRounds = 32;
+}
+
+Reducer::Reducer(const Arena& arena)
+    : arena(arena)
+    , reduced(0)
+    , reducedIds()
+    , numChainVertices(0)
+    , numRounds(0)
+    , isRefined(false)
+{
+}
+
+void Reducer::compressChains(std::vector<size_t>& tails, std::vector<size_t>& priorities)
+{
+    const size_t numVertices = arena.getSize();
+
+    // the next vertex on the chain, if any, and whether there is a previous one
+    std::vector<size_t> next(numVertices, noVertex);
+    std::vector<bool> hasPrevious(numVertices, false);
+    for (const Vertex& vertex : arena.getVertices()) {
+        if (vertex.outgoing.size() == 1 && vertex.outgoing[0] != vertex.id && arena[vertex.outgoing[0]].incoming.size() == 1) {
+            next[vertex.id] = vertex.outgoing[0];
+            hasPrevious[vertex.outgoing[0]] = true;
+        }
+    }
+
+    tails.assign(numVertices, noVertex);
+    priorities.assign(numVertices, 0);
+
+    // Every vertex has at most one next and one previous vertex, so the chains
+    // are paths, each walked from its head, or cycles nothing else leads into,
+    // which are left after that and collapse into a vertex with a self-loop.
+    auto collapse = [&](size_t head, bool isCycle) {
+        size_t tail = head;
+        size_t priority = arena[head].priority;
+        while (next[tail] != noVertex && !(isCycle && next[tail] == head)) {
+            tail = next[tail];
+            priority = std::min(priority, arena[tail].priority);
+        }
+
+        for (size_t id = head; id != tail; id = next[id]) {
+            tails[id] = tail;
+            numChainVertices++;
+        }
+        tails[tail] = tail;
+        priorities[tail] = priority;
+    };
+
+    for (size_t id = 0; id < numVertices; id++) {
+        if (!hasPrevious[id]) {
+            collapse(id, false);
+        }
+    }
+    for (size_t id = 0; id < numVertices; id++) {
+        if (tails[id] == noVertex) {
+            collapse(id, true);
+        }
+    }
+}
+
+void Reducer::refine(const std::vector<size_t>& tails, const std::vector<size_t>& priorities, std::vector<size_t>& classes)
+{
+    // the tails, numbered from 0 with their successors once each (as numbers
+    // too) one after the other, so a round reads them in order
+    std::vector<size_t> nodes;
+    std::vector<size_t> nodeIds(tails.size(), noVertex);
+    for (size_t id = 0; id < tails.size(); id++) {
+        if (tails[id] == id) {
+            nodeIds[id] = nodes.size();
+            nodes.push_back(id);
+        }
+    }
+    std::vector<size_t> successors;
+    std::vector<size_t> successorOffsets{ 0 };
+    for (const size_t id : nodes) {
+        for (const size_t successor : arena[id].outgoing) {
+            successors.push_back(nodeIds[tails[successor]]);
+        }
+        std::sort(successors.begin() + successorOffsets.back(), successors.end());
+        successors.erase(std::unique(successors.begin() + successorOffsets.back(), successors.end()), successors.end());
+        successorOffsets.push_back(successors.size());
+    }
+
+    // per node its class, the nodes in classes of more than one are the
+    // candidates, only those can still be split
+    std::vector<size_t> nodeClasses(nodes.size(), 0);
+    std::vector<size_t> candidates(nodes.size());
+    std::iota(candidates.begin(), candidates.end(), 0);
+    size_t numClasses = candidates.empty() ? 0 : 1;
+
+    // per candidate its signature, sorted and once each
+    std::vector<size_t> signatures;
+    std::vector<size_t> offsets;
+
+    struct Entry {
+        size_t oldClass;
+        uint64_t hash; // of the signature
+        size_t candidate;
+    };
+    std::vector<Entry> entries;
+
+    // Splits the class of every candidate by signature: the first part keeps
+    // the class, the others get new ones. Returns false if nothing was split.
+    auto split = [&]() {
+        entries.clear();
+        for (size_t i = 0; i < candidates.size(); i++) {
+            uint64_t hash = 14695981039346656037ull;
+            for (size_t j = offsets[i]; j < offsets[i + 1]; j++) {
+                hash = (hash ^ signatures[j]) * 1099511628211ull;
+            }
+            entries.push_back(Entry{ nodeClasses[candidates[i]], hash, i });
+        }
+
+        auto isSame = [&](const Entry& a, const Entry& b) {
+            return a.oldClass == b.oldClass && a.hash == b.hash && offsets[a.candidate + 1] - offsets[a.candidate] == offsets[b.candidate + 1] - offsets[b.candidate]
+                && std::equal(signatures.begin() + offsets[a.candidate], signatures.begin() + offsets[a.candidate + 1], signatures.begin() + offsets[b.candidate]);
+        };
+
+        // by class, then by hash, so only equal hashes look at the signatures
+        std::sort(entries.begin(), entries.end(), [&](const Entry& a, const Entry& b) {
+            if (a.oldClass != b.oldClass) {
+                return a.oldClass < b.oldClass;
+            }
+            if (a.hash != b.hash) {
+                return a.hash < b.hash;
+            }
+            return std::lexicographical_compare(signatures.begin() + offsets[a.candidate], signatures.begin() + offsets[a.candidate + 1],
+                signatures.begin() + offsets[b.candidate], signatures.begin() + offsets[b.candidate + 1]);
+        });
+
+        bool isSplit = false;
+        std::vector<size_t> remaining;
+        size_t previousClass = noVertex;
+        for (size_t begin = 0; begin < entries.size();) {
+            size_t end = begin + 1;
+            while (end < entries.size() && isSame(entries[begin], entries[end])) {
+                end++;
+            }
+
+            const size_t oldClass = entries[begin].oldClass;
+            const bool isFirstPart = oldClass != previousClass;
+            const size_t newClass = isFirstPart ? oldClass : numClasses++;
+            isSplit = isSplit || !isFirstPart;
+            previousClass = oldClass;
+            for (size_t i = begin; i < end; i++) {
+                const size_t node = candidates[entries[i].candidate];
+                nodeClasses[node] = newClass;
+                if (end - begin > 1) {
+                    remaining.push_back(node);
+                }
+            }
+            begin = end;
+        }
+
+        candidates.swap(remaining);
+        return isSplit;
+    };
+
+    // to begin with, the classes are owner and priority
+    for (const size_t node : candidates) {
+        offsets.push_back(signatures.size());
+        signatures.push_back(priorities[nodes[node]] * 2 + arena[nodes[node]].isOwnerOdd());
+    }
+    offsets.push_back(signatures.size());
+    split();
+
+    isRefined = candidates.empty();
+    for (numRounds = 0; numRounds < maxRounds && !isRefined;) {
+        numRounds++;
+
+        signatures.clear();
+        offsets.clear();
+        for (const size_t node : candidates) {
+            offsets.push_back(signatures.size());
+            for (size_t i = successorOffsets[node]; i < successorOffsets[node + 1]; i++) {
+                signatures.push_back(nodeClasses[successors[i]]);
+            }
+            std::sort(signatures.begin() + offsets.back(), signatures.end());
+            signatures.erase(std::unique(signatures.begin() + offsets.back(), signatures.end()), signatures.end());
+        }
+        offsets.push_back(signatures.size());
+
+        isRefined = !split() || candidates.empty();
+    }
+
+    for (size_t node = 0; node < nodes.size(); node++) {
+        classes[nodes[node]] = isRefined ? nodeClasses[node] : node;
+    }
+}
+
+void Reducer::run()
+{
+    std::vector<size_t> tails;
+    std::vector<size_t> priorities;
+    compressChains(tails, priorities);
+
+    std::vector<size_t> classes(arena.getSize(), noVertex);
+    refine(tails, priorities, classes);
+
+    // one vertex per class, numbered in the order of their first vertex
+    std::vector<size_t> classIds(arena.getSize(), noVertex);
+    std::vector<size_t> representatives;
+    reducedIds.assign(arena.getSize(), noVertex);
+    for (size_t id = 0; id < arena.getSize(); id++) {
+        const size_t tail = tails[id];
+        size_t& classId = classIds[classes[tail]];
+        if (classId == noVertex) {
+            classId = representatives.size();
+            representatives.push_back(tail);
+        }
+        reducedIds[id] = classId;
+    }
+
+    reduced = Arena(representatives.size());
+    std::vector<size_t> successors;
+    for (size_t i = 0; i < representatives.size(); i++) {
+        const Vertex& vertex = arena[representatives[i]];
+
+        reduced.setVertexOwner(i, vertex.owner);
+        reduced.setVertexPriority(i, priorities[vertex.id]);
+        reduced.setVertexLabel(i, vertex.label);
+
+        // the successors of every vertex of the class are in the same classes
+        successors.clear();
+        for (const size_t successor : vertex.outgoing) {
+            successors.push_back(reducedIds[successor]);
+        }
+        std::sort(successors.begin(), successors.end());
+        successors.erase(std::unique(successors.begin(), successors.end()), successors.end());
+        for (const size_t successor : successors) {
+            reduced.addEdge(i, successor);
+        }
+    }
+}
+
+std::vector<Player> Reducer::expandResults(const std::vector<Player>& reducedResults) const
+{
+    if (reducedResults.size() != reduced.getSize()) {
+        throw std::invalid_argument("expandResults(): results don't match the reduced arena!");
+    }
+
+    std::vector<Player> results(arena.getSize());
+    for (size_t id = 0; id < arena.getSize(); id++) {
+        results[id] = reducedResults[reducedIds[id]];
+    }
+    return results;
+}
+
+} // PAPG
@@ -0,0 +1,46 @@
+#include "SCCDecomposition.hpp"
+#include "MappedArena.hpp"
+
+namespace PAPG {
+
+template <typename ArenaType>
+BasicSCCDecomposition<ArenaType>::BasicSCCDecomposition(const ArenaType& arena)
+    : arena(nullptr)
+    , index()
+    , lowlink()
+    , stamps()
+    , onStack()
+    , generation(0)
+    , stack()
+    , callStack()
+{
+    reset(arena);
+}
+
+template <typename ArenaType>
+void BasicSCCDecomposition<ArenaType>::reset(const ArenaType& newArena)
+{
+    arena = &newArena;
+    index.assign(newArena.getSize(), 0);
+    lowlink.assign(newArena.getSize(), 0);
+    stamps.assign(newArena.getSize(), 0);
+    onStack.assign(newArena.getSize(), false);
+    generation = 0;
+    stack.clear();
+    callStack.clear();
+}
+
+template <typename ArenaType>
+void BasicSCCDecomposition<ArenaType>::nextGeneration()
+{
+    if (++generation == 0) {
+        // generation counter wrapped around, stale stamps could match again
+        std::fill(stamps.begin(), stamps.end(), 0);
+        generation = 1;
+    }
+}
+
+template class BasicSCCDecomposition<Arena>;
+template class BasicSCCDecomposition<MappedArena>;
+
+} // PAPG
@@ -0,0 +1,445 @@
+#include "SISolver.hpp"
+#include "Measure.hpp"
+#include "SCCDecomposition.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <thread>
+
+namespace PAPG {
+
+const size_t SISolver::noSuccessor = std::numeric_limits<size_t>::max();
+
+namespace {
+    // Calls f(begin, end) on consecutive chunks of [0, count), spread over up
+    // to maxThreads threads, or on the whole range at once if count is small.
+    template <typename Function>
+    void parallelFor(size_t count, unsigned maxThreads, size_t threshold, Function f)
+    {
+        if (maxThreads < 2 || count < threshold) {
+            f(0, count);
+            return;
+        }
+
+        const size_t chunk = (count + maxThreads - 1) / maxThreads;
+        std::vector<std::thread> threads;
+        for (size_t begin = chunk; begin < count; begin += chunk) {
+            threads.emplace_back(f, begin, std::min(count, begin + chunk));
+        }
+        f(0, std::min(count, chunk));
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    // the same game with the roles of the players swapped
+    Arena makeDual(const Arena& arena)
+    {
+        Arena dual(arena.getSize());
+
+        for (const auto& vertex : arena.getVertices()) {
+            dual.setVertexOwner(vertex.id, vertex.owner == Player::even ? Player::odd : Player::even);
+            dual.setVertexPriority(vertex.id, vertex.priority + 1);
+            for (const size_t successor : vertex.outgoing) {
+                dual.addEdge(vertex.id, successor);
+            }
+        }
+
+        return dual;
+    }
+
+    Measure makeMaxMeasure(const Arena& game)
+    {
+        std::vector<unsigned> priorityOccurences(game.getMaxPriority() + 1, 0);
+
+        for (const auto& vertex : game.getVertices()) {
+            if (vertex.priority % 2) { // priority is odd
+                priorityOccurences[vertex.priority]++;
+            }
+        }
+
+        return Measure(priorityOccurences);
+    }
+
+    // The state of strategy improvement on one game: odd's current strategy and
+    // the progress measures that evaluate it.
+    class Improvement {
+    private:
+        const Arena& game;
+        const unsigned maxThreads;
+        const size_t parallelThreshold;
+        SolveControl* const control;
+
+        const Measure maxMeasure;
+        std::vector<Measure> measures;
+        std::vector<Measure> lifted; // results of the current round, only valid where isLifted is set
+        std::vector<char> isLifted;
+
+        std::vector<size_t> strategy; // odd's current strategy
+        std::vector<size_t> switchTo; // profitable switches found in the current scan
+
+        std::vector<size_t> dirty; // vertices to lift in the next round
+        std::vector<char> isDirty;
+
+        SCCDecomposition sccs;
+        std::vector<unsigned> labels; // workspace for markLosing
+        unsigned nextLabel;
+
+        Measure prog(size_t fromVertex, size_t toVertex) const
+        {
+            const size_t priority = game[fromVertex].priority;
+            Measure result(maxMeasure);
+
+            result.makePartialEqualOf(priority, measures[toVertex]);
+
+            if (!result.isTop() && (priority % 2) && !result.partialIncrementIfAble(priority)) {
+                result.makeTop();
+            }
+
+            return result;
+        }
+
+        inline bool isFollowed(size_t from, size_t to) const
+        {
+            return game[from].owner == Player::even || strategy[from] == to;
+        }
+
+        void markDirty(size_t id)
+        {
+            if (!isDirty[id] && !measures[id].isTop()) {
+                isDirty[id] = true;
+                dirty.push_back(id);
+            }
+        }
+
+        void markPredecessorsDirty(size_t id)
+        {
+            for (const size_t predecessor : game[id].incoming) {
+                if (isFollowed(predecessor, id)) {
+                    markDirty(predecessor);
+                }
+            }
+        }
+
+        void markLosing();
+
+    public:
+        Improvement(const Arena& game, unsigned maxThreads, size_t parallelThreshold, SolveControl* control)
+            : game(game)
+            , maxThreads(maxThreads)
+            , parallelThreshold(parallelThreshold)
+            , control(control)
+            , maxMeasure(makeMaxMeasure(game))
+            , measures()
+            , lifted()
+            , isLifted(game.getSize(), false)
+            , strategy(game.getSize(), SISolver::noSuccessor)
+            , switchTo(game.getSize(), SISolver::noSuccessor)
+            , dirty()
+            , isDirty(game.getSize(), false)
+            , sccs(game)
+            , labels(game.getSize(), 0)
+            , nextLabel(1)
+        {
+            measures.reserve(game.getSize());
+            lifted.reserve(game.getSize());
+            for (const auto& vertex : game.getVertices()) {
+                measures.emplace_back(maxMeasure);
+                lifted.emplace_back(maxMeasure);
+
+                if (vertex.owner == Player::odd && !vertex.outgoing.empty()) {
+                    strategy[vertex.id] = vertex.outgoing.front();
+                }
+                markDirty(vertex.id);
+            }
+        }
+
+        unsigned evaluate(unsigned long long& numLifts);
+        unsigned improve(SISolver::SwitchingRule rule);
+
+        std::vector<Player> getWinners() const;
+        void getEvenStrategy(std::vector<size_t>& evenStrategy) const;
+    };
+
+    // Sends the vertices even loses in the one-player game left by odd's
+    // strategy to top. Even wins there exactly from the vertices that can
+    // reach a cycle with an even least priority, top vertices count as lost.
+    // Cycles are found by decomposing into SCCs, taking the least priority of
+    // each nontrivial one and, if that is odd, decomposing what is left
+    // without the vertices that have it.
+    void Improvement::markLosing()
+    {
+        std::vector<size_t> winning;
+        std::vector<char> isWinning(game.getSize(), false);
+
+        std::vector<std::vector<size_t> > pieces(1);
+        for (size_t id = 0; id < game.getSize(); id++) {
+            if (!measures[id].isTop()) {
+                pieces.back().push_back(id);
+            }
+        }
+
+        while (!pieces.empty()) {
+            std::vector<size_t> piece;
+            piece.swap(pieces.back());
+            pieces.pop_back();
+
+            const unsigned label = nextLabel++;
+            for (const size_t id : piece) {
+                labels[id] = label;
+            }
+
+            auto isMember = [&](size_t id) { return labels[id] == label; };
+            auto followEdge = [&](size_t from, size_t to) { return isFollowed(from, to); };
+
+            for (auto& component : sccs.decompose(piece, isMember, followEdge)) {
+                if (!sccs.isNontrivial(component, followEdge)) {
+                    continue;
+                }
+
+                size_t leastPriority = std::numeric_limits<size_t>::max();
+                for (const size_t id : component) {
+                    leastPriority = std::min(leastPriority, game[id].priority);
+                }
+
+                if (leastPriority % 2 == 0) {
+                    for (const size_t id : component) {
+                        isWinning[id] = true;
+                        winning.push_back(id);
+                    }
+                } else {
+                    pieces.emplace_back();
+                    for (const size_t id : component) {
+                        if (game[id].priority != leastPriority) {
+                            pieces.back().push_back(id);
+                        }
+                    }
+                }
+            }
+        }
+
+        // everything that can reach a winning cycle is won as well
+        for (size_t i = 0; i < winning.size(); i++) {
+            for (const size_t predecessor : game[winning[i]].incoming) {
+                if (!isWinning[predecessor] && !measures[predecessor].isTop() && isFollowed(predecessor, winning[i])) {
+                    isWinning[predecessor] = true;
+                    winning.push_back(predecessor);
+                }
+            }
+        }
+
+        for (size_t id = 0; id < game.getSize(); id++) {
+            if (!isWinning[id] && !measures[id].isTop()) {
+                measures[id].makeTop();
+                markPredecessorsDirty(id);
+            }
+        }
+    }
+
+    // Lifts the dirty vertices in rounds until the measures are the least
+    // progress measure (above the current ones) of the one-player game. Within
+    // a round every vertex is lifted against the measures of the previous
+    // round, so the vertices of a round can be lifted in parallel. Returns the
+    // number of rounds.
+    unsigned Improvement::evaluate(unsigned long long& numLifts)
+    {
+        markLosing();
+
+        unsigned numRounds = 0;
+        std::atomic<unsigned long long> lifts(0);
+        std::vector<size_t> round;
+
+        while (!dirty.empty()) {
+            numRounds++;
+
+            if (control != nullptr) {
+                Progress progress;
+                progress.lifts = numLifts + lifts;
+                control->check(progress);
+            }
+            round.clear();
+            for (const size_t id : dirty) {
+                isDirty[id] = false;
+                if (!measures[id].isTop()) { // could have gone to top after being marked
+                    round.push_back(id);
+                }
+            }
+            dirty.clear();
+
+            parallelFor(round.size(), maxThreads, parallelThreshold, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++) {
+                    const size_t id = round[i];
+                    const Vertex& vertex = game[id];
+
+                    Measure result(maxMeasure);
+                    if (vertex.owner == Player::even) {
+                        result.makeTop();
+                        for (const size_t successor : vertex.outgoing) {
+                            auto intermediateResult = prog(id, successor);
+                            if (intermediateResult < result) {
+                                result = intermediateResult;
+                            }
+                        }
+                    } else {
+                        result = prog(id, strategy[id]);
+                    }
+
+                    if (result > measures[id]) {
+                        lifted[id] = result;
+                        isLifted[id] = true;
+                    }
+                }
+                lifts += end - begin;
+            });
+
+            for (const size_t id : round) {
+                if (isLifted[id]) {
+                    isLifted[id] = false;
+                    measures[id] = lifted[id];
+                    markPredecessorsDirty(id);
+                }
+            }
+        }
+
+        numLifts += lifts;
+        return numRounds;
+    }
+
+    // Scans odd's vertices for profitable switches and makes them, returns the
+    // number of switches made.
+    unsigned Improvement::improve(SISolver::SwitchingRule rule)
+    {
+        parallelFor(game.getSize(), maxThreads, parallelThreshold, [&](size_t begin, size_t end) {
+            for (size_t id = begin; id < end; id++) {
+                switchTo[id] = SISolver::noSuccessor;
+                if (game[id].owner != Player::odd || measures[id].isTop()) {
+                    continue;
+                }
+
+                Measure best(maxMeasure);
+                best = measures[id];
+                for (const size_t successor : game[id].outgoing) {
+                    auto intermediateResult = prog(id, successor);
+                    if (intermediateResult > best) {
+                        best = intermediateResult;
+                        switchTo[id] = successor;
+                        if (rule == SISolver::SwitchingRule::allProfitable) {
+                            break;
+                        }
+                    }
+                }
+            }
+        });
+
+        unsigned numSwitches = 0;
+        for (size_t id = 0; id < game.getSize(); id++) {
+            if (switchTo[id] != SISolver::noSuccessor) {
+                numSwitches++;
+                strategy[id] = switchTo[id];
+                markDirty(id);
+            }
+        }
+
+        return numSwitches;
+    }
+
+    std::vector<Player> Improvement::getWinners() const
+    {
+        std::vector<Player> winners;
+        winners.reserve(game.getSize());
+
+        for (auto& measure : measures) {
+            winners.push_back(measure.isTop() ? Player::odd : Player::even);
+        }
+
+        return winners;
+    }
+
+    // Even's winning strategy moves to a successor with the least measure.
+    void Improvement::getEvenStrategy(std::vector<size_t>& evenStrategy) const
+    {
+        for (const auto& vertex : game.getVertices()) {
+            if (vertex.owner != Player::even || measures[vertex.id].isTop()) {
+                continue;
+            }
+
+            Measure best(maxMeasure);
+            best.makeTop();
+            for (const size_t successor : vertex.outgoing) {
+                auto intermediateResult = prog(vertex.id, successor);
+                if (intermediateResult < best) {
+                    best = intermediateResult;
+                    evenStrategy[vertex.id] = successor;
+                }
+            }
+        }
+    }
+}
+
+SISolver::SISolver(const Arena& arena)
+    : arena(&arena)
+    , maxThreads(std::max(1u, std::thread::hardware_concurrency()))
+    , parallelThreshold(4096)
+    , control(nullptr)
+    , strategy(arena.getSize(), noSuccessor)
+    , numIterations(0)
+    , numSwitches(0)
+    , numRounds(0)
+    , numLifts(0)
+{
+}
+
+void SISolver::reset(const Arena& newArena)
+{
+    arena = &newArena;
+    strategy.assign(newArena.getSize(), noSuccessor);
+    numIterations = 0;
+    numSwitches = 0;
+    numRounds = 0;
+    numLifts = 0;
+}
+
+std::vector<Player> SISolver::improve(const Arena& game, SwitchingRule rule, std::vector<size_t>& evenStrategy)
+{
+    Improvement improvement(game, maxThreads, parallelThreshold, control);
+
+    while (true) {
+        numIterations++;
+        numRounds += improvement.evaluate(numLifts);
+
+        const unsigned switches = improvement.improve(rule);
+        if (switches == 0) {
+            break;
+        }
+        numSwitches += switches;
+    }
+
+    improvement.getEvenStrategy(evenStrategy);
+    return improvement.getWinners();
+}
+
+std::vector<Player> SISolver::solve(SwitchingRule rule)
+{
+    std::fill(strategy.begin(), strategy.end(), noSuccessor);
+
+    // even's strategy comes from the game itself, odd's from the dual game
+    // where odd plays even's part
+    std::vector<Player> result = improve(*arena, rule, strategy);
+    improve(makeDual(*arena), rule, strategy);
+
+    return result;
+}
+
+std::vector<Player> SISolver::solveAllProfitable()
+{
+    return solve(SwitchingRule::allProfitable);
+}
+
+std::vector<Player> SISolver::solveLocallyOptimal()
+{
+    return solve(SwitchingRule::locallyOptimal);
+}
+
+} // PAPG
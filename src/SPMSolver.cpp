@@ -1,321 +1,641 @@
 #include "SPMSolver.hpp"
+#include "Checkpoint.hpp"
+#include "LiftTrace.hpp"
+#include "SCCDecomposition.hpp"
+#include "SuccinctMeasure.hpp"
 
 #include <cstdlib>
 #include <ctime>
 
 #include <algorithm>
 #include <iostream>
+#include <limits>
+#include <numeric>
 #include <stdexcept>
+#include <unordered_map>
+#include <utility>
 
 namespace PAPG {
 
-Measure SPMSolver::makeMaxMeasure() const
-{
-    std::vector<unsigned> priorityOccurences(arena.getMaxPriority() + 1, 0);
+template <typename MeasureType, typename StoreType, typename ArenaType>
+const size_t BasicSPMSolver<MeasureType, StoreType, ArenaType>::noWitness = std::numeric_limits<size_t>::max();
+
+namespace {
+    // the max measure of the arena's measure space, picked by the type of the second argument
+    template <typename ArenaType>
+    Measure makeMaxMeasure(const ArenaType& arena, const Measure*)
+    {
+        std::vector<unsigned> priorityOccurences(arena.getMaxPriority() + 1, 0);
 
-    for (const auto& vertex : arena.getVertices()) {
-        const size_t priority = vertex.priority;
-        if (priority % 2) { // priority is odd
-            priorityOccurences[priority]++;
+        for (const auto& vertex : arena.getVertices()) {
+            const size_t priority = vertex.priority;
+            if (priority % 2) { // priority is odd
+                priorityOccurences[priority]++;
+            }
         }
+
+        return Measure(priorityOccurences);
     }
 
-    return Measure(priorityOccurences);
-}
+    template <typename ArenaType>
+    SuccinctMeasure makeMaxMeasure(const ArenaType& arena, const SuccinctMeasure*)
+    {
+        size_t numOddVertices = 0;
 
-void SPMSolver::initializeMeasures()
-{
-    measures.clear();
-    measures.reserve(arena.getSize());
+        for (const auto& vertex : arena.getVertices()) {
+            if (vertex.priority % 2) { // priority is odd
+                numOddVertices++;
+            }
+        }
 
-    for (size_t i = 0; i < arena.getSize(); i++) {
-        measures.emplace_back(Measure(maxMeasure));
+        return SuccinctMeasure(arena.getMaxPriority() + 1, numOddVertices);
     }
-}
-
-std::vector<Player> SPMSolver::getResult() const
-{
 
-    std::vector<Player> result;
-    result.reserve(arena.getSize());
+    // Regional max measures take a decomposition per odd priority, which isn't
+    // done past this many vertex and edge visits in all (about a second).
+    const unsigned long long maxRegionWork = 1ULL << 24;
 
-    for (auto& measure : measures) {
-        if (measure.isTop()) {
-            result.emplace_back(Player::odd);
-        } else {
-            result.emplace_back(Player::even);
+    struct BoundHash {
+        inline size_t operator()(const std::pair<size_t, unsigned>& bound) const
+        {
+            return std::hash<size_t>()(bound.first * 0x9e3779b97f4a7c15ULL ^ bound.second);
+        }
+    };
+
+    // Tighter max measures than the priority counts of the whole game. Even's
+    // least progress measure counts, at priority p of a vertex v, the vertices
+    // of priority p on a play from v up to the first lower priority. A vertex
+    // of priority p seen twice on such a play closes a cycle that odd wins, so
+    // the count is at most the number of distinct vertices of priority p on a
+    // path from v through priorities p and up. These path counts are worked
+    // out on the components of the subgraph of priorities p and up, bottom
+    // components first. A vertex whose lifts pass its bounds can go to top
+    // right away, as it can't be even's. Vertices with the same bounds share a
+    // max measure. maxMeasureOf is left empty if the game is too big for it.
+    template <typename ArenaType>
+    void makeRegionMaxMeasures(const ArenaType& arena, std::deque<Measure>& maxMeasures, std::vector<const Measure*>& maxMeasureOf)
+    {
+        const size_t numVertices = arena.getSize();
+        size_t numEdges = 0;
+        std::vector<size_t> priorities(numVertices);
+        std::vector<bool> isPresent(arena.getMaxPriority() + 1, false);
+        for (const auto& vertex : arena.getVertices()) {
+            numEdges += vertex.outgoing.size();
+            priorities[vertex.id] = vertex.priority;
+            isPresent[vertex.priority] = true;
         }
-    }
-
-    return result;
-}
 
-SPMSolver::SPMSolver(const Arena& arena)
-    : arena(arena)
-    , maxMeasure(makeMaxMeasure())
-    , numLifts(0)
-    , maxRecursionDepth(0)
-{
-}
+        size_t numPasses = 0; // the odd priorities some vertex has, the others are bound by 0
+        for (size_t priority = 1; priority <= arena.getMaxPriority(); priority += 2) {
+            numPasses += isPresent[priority];
+        }
+        if (numVertices == 0 || numPasses * static_cast<unsigned long long>(numVertices + numEdges) > maxRegionWork) {
+            return;
+        }
+        const size_t numOddPriorities = (arena.getMaxPriority() + 1) / 2;
+
+        // The bounds of each vertex so far, for the odd priorities done, as the
+        // id of a chain of (previous id, bound) links so equal ones are kept once.
+        std::vector<std::pair<size_t, unsigned> > links(1, std::make_pair(0, 0)); // the empty chain
+        std::vector<size_t> chainOf(numVertices, 0);
+        std::unordered_map<std::pair<size_t, unsigned>, size_t, BoundHash> linkIds;
+
+        BasicSCCDecomposition<ArenaType> sccs(arena);
+        std::vector<size_t> roots(numVertices);
+        std::iota(roots.begin(), roots.end(), 0);
+        std::vector<size_t> componentOf(numVertices, 0);
+        std::vector<unsigned> componentBounds;
+
+        for (size_t priority = 1; priority <= arena.getMaxPriority(); priority += 2) {
+            const auto isMember = [&](size_t id) { return isPresent[priority] && priorities[id] >= priority; };
+
+            // the components come bottom first, so those below a component are done before it
+            componentBounds.clear();
+            if (isPresent[priority]) {
+                sccs.forEachComponent(roots, isMember, [](size_t, size_t) { return true; }, [&](const size_t* first, const size_t* last) {
+                    const size_t componentId = componentBounds.size();
+                    unsigned count = 0;
+                    for (const size_t* member = first; member != last; member++) {
+                        componentOf[*member] = componentId;
+                        count += priorities[*member] == priority;
+                    }
+
+                    unsigned below = 0;
+                    for (const size_t* member = first; member != last; member++) {
+                        for (const size_t successor : arena[*member].outgoing) {
+                            if (isMember(successor) && componentOf[successor] != componentId) {
+                                below = std::max(below, componentBounds[componentOf[successor]]);
+                            }
+                        }
+                    }
+                    componentBounds.push_back(count + below);
+                });
+            }
 
-Measure SPMSolver::prog(const size_t fromVertex, const size_t toVertex) const
-{
-    const size_t priority = arena[fromVertex].priority;
-    Measure result(maxMeasure);
+            linkIds.clear();
+            for (size_t id = 0; id < numVertices; id++) {
+                const auto link = std::make_pair(chainOf[id], isMember(id) ? componentBounds[componentOf[id]] : 0);
+                const auto inserted = linkIds.emplace(link, links.size());
+                if (inserted.second) {
+                    links.push_back(link);
+                }
+                chainOf[id] = inserted.first->second;
+            }
+        }
 
-    // start with partial equal, and increment if necessary
-    result.makePartialEqualOf(priority, measures[toVertex]);
+        // a max measure per distinct chain, its bounds read back from the last priority down
+        std::unordered_map<size_t, const Measure*> measureOf;
+        maxMeasureOf.resize(numVertices);
+        for (size_t id = 0; id < numVertices; id++) {
+            const auto found = measureOf.find(chainOf[id]);
+            if (found != measureOf.end()) {
+                maxMeasureOf[id] = found->second;
+                continue;
+            }
 
-    if (!result.isTop() && (priority % 2)) { 
-    // result is not already top, and fromVertex priority is odd
-        if (!result.partialIncrementIfAble(priority)) {
-            // not able to increment, make top instead
-            result.makeTop();
+            std::vector<unsigned> bounds(arena.getMaxPriority() + 1, 0);
+            size_t chain = chainOf[id];
+            for (size_t index = 2 * numOddPriorities - 1; chain != 0; index -= 2) {
+                bounds[index] = links[chain].second;
+                chain = links[chain].first;
+            }
+            maxMeasures.emplace_back(bounds);
+            maxMeasureOf[id] = measureOf[chainOf[id]] = &maxMeasures.back();
         }
     }
 
-    return result;
-}
-
-bool SPMSolver::lift(const size_t vertex)
-{
-    // std::cerr << "lift(" << vertex << "): " << measures[vertex] << " -> ";
-    numLifts++;
+    // the succinct measures keep the max measure of the whole game
+    template <typename ArenaType>
+    void makeRegionMaxMeasures(const ArenaType&, std::deque<SuccinctMeasure>&, std::vector<const SuccinctMeasure*>&)
+    {
+    }
 
-    Measure result(maxMeasure);
+    // Checkpoints keep a top flag and a value per odd priority per measure,
+    // which only Measure has.
+    bool isCheckpointable(const Measure*) { return true; }
+    bool isCheckpointable(const SuccinctMeasure*) { return false; }
 
-    if (arena[vertex].owner == Player::even) {
-        result.makeTop();
-        for (const size_t successor : arena[vertex].outgoing) {
-            auto intermediateResult = prog(vertex, successor);
-            if (intermediateResult < result) {
-                result = intermediateResult;
-            }
+    void encodeMeasure(const Measure& measure, std::vector<uint32_t>& words)
+    {
+        words.push_back(measure.isTop());
+        for (size_t index = 1; index < measure.getSize(); index += 2) {
+            words.push_back(measure.getValue(index));
         }
-    } else {
-        for (const size_t successor : arena[vertex].outgoing) {
-            auto intermediateResult = prog(vertex, successor);
-            if (intermediateResult > result) {
-                result = intermediateResult;
+    }
+    void encodeMeasure(const SuccinctMeasure&, std::vector<uint32_t>&) {}
+
+    // false if the record isn't a measure of measure's space
+    bool decodeMeasure(const uint32_t* record, Measure& measure)
+    {
+        if (record[0]) {
+            measure.makeTop();
+            return true;
+        }
+        for (size_t index = 1; index < measure.getSize(); index += 2) {
+            if (!measure.setValue(index, record[1 + index / 2])) {
+                return false;
             }
         }
+        return true;
     }
+    bool decodeMeasure(const uint32_t*, SuccinctMeasure&) { return false; }
 
-    // std::cerr << measures[vertex] << std::endl;
+    // read-ahead hints for what solveBlockOrder() is about to visit, only mapped arenas and stores take them
+    template <typename T>
+    void adviseWillNeed(const T&, size_t, size_t)
+    {
+    }
 
-    if (result != measures[vertex]) {
-        measures[vertex] = result;
-        return true;
+    void adviseWillNeed(const MappedArena& arena, size_t begin, size_t end)
+    {
+        arena.willNeed(begin, end);
+    }
+
+    template <typename MeasureType>
+    void adviseWillNeed(const MappedMeasureStore<MeasureType>& store, size_t begin, size_t end)
+    {
+        store.willNeed(begin, end);
+    }
+
+    // sets a table of BasicSPMSolver to size values, mapped tables go where the store's file goes
+    template <typename T, typename StoreType>
+    void assignTable(std::vector<T>& table, size_t size, const T& value, const StoreType&)
+    {
+        table.assign(size, value);
+    }
+
+    template <typename T, typename MeasureType>
+    void assignTable(MappedTable<T>& table, size_t size, const T& value, const MappedMeasureStore<MeasureType>& store)
+    {
+        table.assign(size, value, store.getDirectory());
     }
-    return false;
 }
 
-std::vector<Player> SPMSolver::solveInputOrder()
+template <typename MeasureType, typename StoreType, typename ArenaType>
+void BasicSPMSolver<MeasureType, StoreType, ArenaType>::initializeMeasures()
 {
-    initializeMeasures(); // set all measures to (0,..,0)
+    measures.reset(arena->getSize(), maxMeasures->get());
 
-    std::vector<bool> isFinished(arena.getSize(), false);
+    assignTable(witnesses, arena->getSize(), noWitness, measures);
+    assignTable(seenChanges, arena->getSize(), 0ULL, measures);
+    assignTable(changedAt, arena->getSize(), 0ULL, measures);
+    numChanges = 0;
 
-    while (std::count(isFinished.begin(), isFinished.end(), false)) {
-        for (size_t i = 0; i < isFinished.size(); i++) {
-            // First thing to do in each iteration of this loop is loudly proclaim your hatred for vector<bool> :(
-            isFinished[i] = false;
-        }
+    recursionDepth = 0;
+    numTop = 0;
 
-        for (size_t currentVertex = 0; currentVertex < arena.getSize(); currentVertex++) {
-            if (measures[currentVertex].isTop() || !lift(currentVertex)) { // no change was made
-                isFinished[currentVertex] = true;
-            }
-        }
+    if (control != nullptr && control->getCheckpointer() != nullptr) {
+        restoreCheckpoint(*control->getCheckpointer());
     }
-
-    return getResult(); // get results from measures table
 }
 
-std::vector<Player> SPMSolver::solveRandomOrder()
+template <typename MeasureType, typename StoreType, typename ArenaType>
+void BasicSPMSolver<MeasureType, StoreType, ArenaType>::writeCheckpoint(Checkpointer& checkpointer)
 {
-    initializeMeasures(); // set all measures to (0,..,0)
+    if (!isCheckpointable(static_cast<const MeasureType*>(nullptr)) || !checkpointer.isReady()) {
+        return;
+    }
 
-    std::srand(std::time(NULL));
+    std::unique_ptr<CheckpointData> data(new CheckpointData());
+    data->key = checkpointer.getKey();
+    data->strategy = checkpointer.getStrategy();
+    data->lifts = checkpointer.getResumedLifts() + numLifts;
+    data->recordSize = 1 + maxMeasures->get().getSize() / 2;
+    data->words.reserve(arena->getSize() * data->recordSize);
+    MeasureType measure(maxMeasures->get());
+    for (size_t vertex = 0; vertex < arena->getSize(); vertex++) {
+        measures.get(vertex, measure);
+        encodeMeasure(measure, data->words);
+    }
+    checkpointer.write(std::move(data));
+}
 
-    std::vector<bool> isFinished(arena.getSize(), false);
-    size_t numFinishedVertices = 0;
+template <typename MeasureType, typename StoreType, typename ArenaType>
+void BasicSPMSolver<MeasureType, StoreType, ArenaType>::restoreCheckpoint(Checkpointer& checkpointer)
+{
+    if (!isCheckpointable(static_cast<const MeasureType*>(nullptr))) {
+        return;
+    }
+    std::unique_ptr<CheckpointData> data = checkpointer.takeResume();
+    if (!data) {
+        return;
+    }
 
-    while (numFinishedVertices != arena.getSize()) {
-        const size_t chosenVertex = std::rand() % arena.getSize();
+    const size_t recordSize = 1 + maxMeasures->get().getSize() / 2;
+    if (data->recordSize != recordSize || data->words.size() != arena->getSize() * recordSize) {
+        throw std::invalid_argument("ERR: the checkpoint doesn't fit the measures of this game.");
+    }
 
-        if (!isFinished[chosenVertex]) {
-            if (measures[chosenVertex].isTop() || !lift(chosenVertex)) { // no change was made
-                isFinished[chosenVertex] = true;
-                numFinishedVertices++;
-            } else {
-                for (size_t i = 0; i < isFinished.size(); i++) {
-                    // First thing to do in each iteration of this loop is loudly proclaim your hatred for vector<bool> :(
-                    isFinished[i] = false;
-                }
-                numFinishedVertices = 0;
-            }
+    // the witnesses stay unknown, so every vertex looks at all its successors the first time
+    for (size_t vertex = 0; vertex < arena->getSize(); vertex++) {
+        MeasureType measure(maxMeasures->get());
+        if (!decodeMeasure(data->words.data() + vertex * recordSize, measure)) {
+            throw std::invalid_argument("ERR: the checkpoint doesn't fit the measures of this game.");
+        }
+        if (measures.set(vertex, measure) && measure.isTop()) {
+            numTop++;
         }
     }
-
-    return getResult(); // get results from measures table
 }
 
-std::vector<Player> SPMSolver::solvePriorityOrder()
+template <typename MeasureType, typename StoreType, typename ArenaType>
+std::vector<Player> BasicSPMSolver<MeasureType, StoreType, ArenaType>::getResult() const
 {
-    initializeMeasures(); // set all measures to (0,..,0)
-
-    std::vector<bool> isFinished(arena.getSize(), false);
 
-    std::vector<size_t> priorityOrderMap;
-    priorityOrderMap.reserve(arena.getSize());
+    std::vector<Player> result;
+    result.reserve(arena->getSize());
 
-    for (size_t i = 0; i < arena.getSize(); i++) {
-        priorityOrderMap.emplace_back(i);
+    for (size_t id = 0; id < measures.getSize(); id++) {
+        if (measures.isTop(id)) {
+            result.emplace_back(Player::odd);
+        } else {
+            result.emplace_back(Player::even);
+        }
     }
 
-    std::sort(priorityOrderMap.begin(), priorityOrderMap.end(), [this](size_t a, size_t b) {
-        return arena[a].priority < arena[b].priority;
-    });
+    return result;
+}
 
-    while (std::count(isFinished.begin(), isFinished.end(), false)) {
-        // there are unfinished vertices left
-        for (size_t i = 0; i < isFinished.size(); i++) {
-            isFinished[i] = false;
-        }
+template <typename MeasureType, typename StoreType, typename ArenaType>
+Progress BasicSPMSolver<MeasureType, StoreType, ArenaType>::getProgress() const
+{
+    Progress progress;
+    progress.lifts = numLifts;
+    progress.verticesAtTop = numTop;
+    progress.recursionDepth = recursionDepth;
+    return progress;
+}
 
-        for (const auto& currentVertex : priorityOrderMap) {
-            if (measures[currentVertex].isTop() || !lift(currentVertex)) { // no change was made
-                isFinished[currentVertex] = true;
-            }
-        }
-    }
+template <typename MeasureType>
+template <typename ArenaType>
+MaxMeasures<MeasureType>::MaxMeasures(const ArenaType& arena)
+    : maxMeasure(makeMaxMeasure(arena, static_cast<const MeasureType*>(nullptr)))
+    , regionMaxMeasures()
+    , maxMeasureOf()
+{
+    makeRegionMaxMeasures(arena, regionMaxMeasures, maxMeasureOf);
+}
 
-    return getResult(); // get results from measures table
+template <typename MeasureType, typename StoreType, typename ArenaType>
+BasicSPMSolver<MeasureType, StoreType, ArenaType>::BasicSPMSolver(const ArenaType& arena, std::shared_ptr<const MaxMeasures<MeasureType> > sharedMaxMeasures)
+    : arena(&arena)
+    , maxMeasures(sharedMaxMeasures ? sharedMaxMeasures : std::make_shared<const MaxMeasures<MeasureType> >(arena))
+    , liftResult(maxMeasures->get())
+    , liftCandidate(maxMeasures->get())
+    , numChanges(0)
+    , numLifts(0)
+    , numRescansAvoided(0)
+    , maxRecursionDepth(0)
+    , recursionDepth(0)
+    , numTop(0)
+    , locked(0)
+    , control(nullptr)
+{
 }
 
-std::vector<Player> SPMSolver::solveIncomingOrder()
+template <typename MeasureType, typename StoreType, typename ArenaType>
+void BasicSPMSolver<MeasureType, StoreType, ArenaType>::reset(const ArenaType& newArena, std::shared_ptr<const MaxMeasures<MeasureType> > sharedMaxMeasures)
 {
-    initializeMeasures(); // set all measures to (0,..,0)
+    arena = &newArena;
+    maxMeasures = sharedMaxMeasures ? sharedMaxMeasures : std::make_shared<const MaxMeasures<MeasureType> >(newArena);
+    liftResult = maxMeasures->get();
+    liftCandidate = maxMeasures->get();
+    numChanges = 0;
+    numLifts = 0;
+    numRescansAvoided = 0;
+    maxRecursionDepth = 0;
+    recursionDepth = 0;
+    numTop = 0;
+    locked.assign(0);
+}
+
+template <typename MeasureType, typename StoreType, typename ArenaType>
+MeasureType BasicSPMSolver<MeasureType, StoreType, ArenaType>::prog(const size_t fromVertex, const size_t toVertex) const
+{
+    MeasureType result(maxMeasures->get());
+    prog(fromVertex, toVertex, result);
+    return result;
+}
 
-    std::vector<bool> isFinished(arena.getSize(), false);
+template <typename MeasureType, typename StoreType, typename ArenaType>
+void BasicSPMSolver<MeasureType, StoreType, ArenaType>::prog(const size_t fromVertex, const size_t toVertex, MeasureType& result) const
+{
+    const size_t priority = (*arena)[fromVertex].priority;
+    result = maxMeasures->getOf(fromVertex); // the bounds, every value is overwritten below
 
-    std::vector<size_t> incomingOrderMap;
-    incomingOrderMap.reserve(arena.getSize());
+    // start with partial equal, and increment if necessary
+    measures.getPartial(toVertex, priority, result);
 
-    for (size_t i = 0; i < arena.getSize(); i++) {
-        incomingOrderMap.emplace_back(i);
+    if (!result.isTop() && (priority % 2)) { 
+    // result is not already top, and fromVertex priority is odd
+        if (!result.partialIncrementIfAble(priority)) {
+            // not able to increment, make top instead
+            result.makeTop();
+        }
     }
+}
 
-    std::sort(incomingOrderMap.begin(), incomingOrderMap.end(), [this](size_t a, size_t b) {
-        return arena[a].incoming.size() > arena[b].incoming.size();
-    });
+template <typename MeasureType, typename StoreType, typename ArenaType>
+bool BasicSPMSolver<MeasureType, StoreType, ArenaType>::lift(const size_t vertex)
+{
+    numLifts++;
 
-    while (std::count(isFinished.begin(), isFinished.end(), false)) {
-        for (size_t i = 0; i < isFinished.size(); i++) {
-            isFinished[i] = false;
+    if (control != nullptr && numLifts % SolveControl::checkInterval == 0) {
+        Checkpointer* checkpointer = control->getCheckpointer();
+        try {
+            control->check(getProgress());
+        } catch (const SolveInterrupted&) {
+            // the measures are as they were after the last lift, keep them for a resume
+            if (checkpointer != nullptr) {
+                checkpointer->flush();
+                writeCheckpoint(*checkpointer);
+            }
+            throw;
+        }
+        if (checkpointer != nullptr && checkpointer->isDue()) {
+            writeCheckpoint(*checkpointer);
         }
+    }
 
-        for (auto& currentVertex : incomingOrderMap) {
-            if (measures[currentVertex].isTop() || !lift(currentVertex)) { // no change was made
-                isFinished[currentVertex] = true;
+    const auto& current = (*arena)[vertex];
+    size_t& witness = witnesses[vertex];
+    const unsigned long long lastSeen = seenChanges[vertex];
+    seenChanges[vertex] = numChanges; // before our own change, a self-loop has to see that next time
+
+    MeasureType& result = liftResult;
+    MeasureType& intermediateResult = liftCandidate;
+    bool isRescanNeeded = (witness == noWitness);
+
+    if (!isRescanNeeded && current.owner == Player::even) {
+        // the other successors only went up from at least the old minimum, so
+        // while the witness gives the same prog nothing changes
+        if (changedAt[witness] <= lastSeen || (prog(vertex, witness, intermediateResult), measures.isEqual(vertex, intermediateResult))) {
+            numRescansAvoided++;
+            PAPG_TRACE_LIFT(vertex, false, measures.isTop(vertex), recursionDepth);
+            return false;
+        }
+        isRescanNeeded = true;
+    } else if (!isRescanNeeded) {
+        // the successors that didn't change still give at most the old maximum
+        numRescansAvoided++;
+        measures.get(vertex, result);
+        for (const size_t successor : current.outgoing) {
+            if (changedAt[successor] > lastSeen) {
+                prog(vertex, successor, intermediateResult);
+                if (intermediateResult > result) {
+                    result = intermediateResult;
+                    witness = successor;
+                }
             }
         }
     }
 
-    return getResult(); // get results from measures table
+    if (current.outgoing.empty()) {
+        // no way out: lost for even, nothing to lift for odd
+        measures.get(vertex, result);
+        if (current.owner == Player::even) {
+            result.makeTop();
+        }
+    } else if (isRescanNeeded) {
+        witness = current.outgoing.front();
+        prog(vertex, witness, result);
+        for (size_t i = 1; i < current.outgoing.size(); i++) {
+            const size_t successor = current.outgoing[i];
+            prog(vertex, successor, intermediateResult);
+            if ((current.owner == Player::even) ? intermediateResult < result : intermediateResult > result) {
+                result = intermediateResult;
+                witness = successor;
+            }
+        }
+    }
+
+    if (measures.set(vertex, result)) {
+        if (result.isTop()) {
+            numTop++;
+        }
+        changedAt[vertex] = ++numChanges;
+        PAPG_TRACE_LIFT(vertex, true, result.isTop(), recursionDepth);
+        return true;
+    }
+    PAPG_TRACE_LIFT(vertex, false, result.isTop(), recursionDepth);
+    return false;
 }
 
-void SPMSolver::liftRecursive(const std::vector<size_t>& subset)
+template <typename MeasureType, typename StoreType, typename ArenaType>
+std::vector<Player> BasicSPMSolver<MeasureType, StoreType, ArenaType>::solveInputOrder()
 {
-    static unsigned recursionDepth = 0;
+    return solveWith<InputOrder, Sweep>();
+}
 
-    if (recursionDepth > maxRecursionDepth)
-        maxRecursionDepth = recursionDepth;
+template <typename MeasureType, typename StoreType, typename ArenaType>
+std::vector<Player> BasicSPMSolver<MeasureType, StoreType, ArenaType>::solveRandomOrder()
+{
+    return solveWith<InputOrder, Random>();
+}
 
-    std::vector<size_t> liftedVertices;
-    liftedVertices.reserve(subset.size());
+template <typename MeasureType, typename StoreType, typename ArenaType>
+std::vector<Player> BasicSPMSolver<MeasureType, StoreType, ArenaType>::solvePriorityOrder()
+{
+    return solveWith<PriorityOrder, Sweep>();
+}
 
-    while (true) {
-        for (auto& currentVertex : subset) {
-            if (!measures[currentVertex].isTop() && lift(currentVertex)) { // a change was made
-                liftedVertices.emplace_back(currentVertex);
-            }
-        }
+template <typename MeasureType, typename StoreType, typename ArenaType>
+std::vector<Player> BasicSPMSolver<MeasureType, StoreType, ArenaType>::solveIncomingOrder()
+{
+    return solveWith<IncomingOrder, Sweep>();
+}
 
-        if (liftedVertices.empty()){
-            // we were unable to lift anything
-            return;
-        }
+template <typename MeasureType, typename StoreType, typename ArenaType>
+std::vector<Player> BasicSPMSolver<MeasureType, StoreType, ArenaType>::solveWorklist()
+{
+    return solveWith<InputOrder, Worklist>();
+}
 
-        // If liftedVertices is the same size as our input, that means we
-        // lifted all our vertices and a recursive call would have the exact
-        // same effect as simply iterating again, therefore only recurse if
-        // this is not the case.
-        if (liftedVertices.size() != subset.size()) {
-            recursionDepth++;
-            liftRecursive(liftedVertices);
-            recursionDepth--;
-        }
+template <typename MeasureType, typename StoreType, typename ArenaType>
+std::vector<Player> BasicSPMSolver<MeasureType, StoreType, ArenaType>::solveRecursive()
+{
+    return solveWith<InputOrder, Recursive>();
+}
 
-        liftedVertices.clear();
-    }
+template <typename MeasureType, typename StoreType, typename ArenaType>
+std::vector<Player> BasicSPMSolver<MeasureType, StoreType, ArenaType>::solveRecursivePriorityOrder()
+{
+    return solveWith<PriorityOrder, Recursive>();
 }
 
-std::vector<Player> SPMSolver::solveRecursive()
+template <typename MeasureType, typename StoreType, typename ArenaType>
+std::vector<Player> BasicSPMSolver<MeasureType, StoreType, ArenaType>::solveRecursiveIncomingOrder()
 {
-    initializeMeasures(); // set all measures to (0,..,0)
+    return solveWith<IncomingOrder, Recursive>();
+}
 
-    std::vector<size_t> fullSet;
-    fullSet.reserve(arena.getSize());
-    for (size_t i = 0; i < arena.getSize(); i++) {
-        fullSet.emplace_back(i);
-    }
+template <typename MeasureType, typename StoreType, typename ArenaType>
+std::vector<Player> BasicSPMSolver<MeasureType, StoreType, ArenaType>::solvePropagation()
+{
+    return solveWith<InputOrder, Recursive, PropagationSeeding>();
+}
 
-    liftRecursive(fullSet);
+template <typename MeasureType, typename StoreType, typename ArenaType>
+std::vector<Player> BasicSPMSolver<MeasureType, StoreType, ArenaType>::solvePropagationRecursiveHybrid()
+{
+    return solveWith<InputOrder, Recursive, HybridSeeding>();
+}
 
-    return getResult(); // get results from measures table
+template <typename MeasureType, typename StoreType, typename ArenaType>
+std::vector<Player> BasicSPMSolver<MeasureType, StoreType, ArenaType>::solvePropagationWorklist()
+{
+    return solveWith<InputOrder, Worklist, PropagationSeeding>();
 }
 
-std::vector<Player> SPMSolver::solveRecursivePriorityOrder(){
+template <typename MeasureType, typename StoreType, typename ArenaType>
+std::vector<Player> BasicSPMSolver<MeasureType, StoreType, ArenaType>::solveBlockOrder(size_t blockSize)
+{
     initializeMeasures(); // set all measures to (0,..,0)
+    PAPG_TRACE_PHASE(worklist);
+
+    blockSize = std::max<size_t>(1, blockSize);
+    const size_t numBlocks = (arena->getSize() + blockSize - 1) / blockSize;
+    VertexSet isQueued(arena->getSize(), true); // a bit per vertex, all of them to start with
+
+    // and a bit per chunk of up to 64 vertices of a block with any of them
+    // queued, so a visit costs what the block has queued and not its size
+    const size_t chunkSize = 64;
+    const size_t chunksPerBlock = (blockSize + chunkSize - 1) / chunkSize;
+    VertexSet queuedChunks(numBlocks * chunksPerBlock, true);
+    auto chunkOf = [&](size_t id) { return id / blockSize * chunksPerBlock + id % blockSize / chunkSize; };
+
+    std::deque<size_t> queue;
+
+    // Goes round the blocks in order until none is left to lift, so vertices,
+    // their edges and their measures are mostly visited page after page. A
+    // block's queued vertices are lifted first in first out, a vertex that
+    // lifted queues its predecessors: the ones in the block go on the queue,
+    // the ones in other blocks wait for their block's next visit. A visit
+    // stops after as many lifts as the block has vertices, what is left is
+    // lifted on the next round: a block lifted to the end against outside
+    // measures that are behind can count up far more than a worklist would.
+    size_t chunk = queuedChunks.findNext(0);
+    while (chunk < queuedChunks.getSize()) {
+        const size_t blockIndex = chunk / chunksPerBlock;
+        const size_t begin = blockIndex * blockSize;
+        const size_t end = std::min(arena->getSize(), begin + blockSize);
+
+        const size_t firstChunk = blockIndex * chunksPerBlock;
+        queuedChunks.forEachIn(firstChunk, firstChunk + chunksPerBlock, [&](size_t queuedChunk) {
+            const size_t chunkBegin = begin + (queuedChunk - firstChunk) * chunkSize;
+            isQueued.forEachIn(chunkBegin, std::min(end, chunkBegin + chunkSize), [&queue](size_t id) { queue.push_back(id); });
+            queuedChunks.erase(queuedChunk);
+        });
+        if (queue.size() >= (end - begin) / 8) {
+            // read-ahead only pays when much of the block is lifted, a few
+            // vertices here and there touch just their own pages
+            adviseWillNeed(*arena, begin, end);
+            adviseWillNeed(measures, begin, end);
+        }
 
-    std::vector<size_t> fullSet;
-    fullSet.reserve(arena.getSize());
-    for (size_t i = 0; i < arena.getSize(); i++) {
-        fullSet.emplace_back(i);
-    }
-    
-    std::sort(fullSet.begin(), fullSet.end(), [this](size_t a, size_t b) {
-        return arena[a].priority < arena[b].priority;
-    });
+        for (size_t numLeft = end - begin; !queue.empty(); numLeft--) {
+            if (numLeft == 0) {
+                for (const size_t vertex : queue) { // still queued, for the next round
+                    queuedChunks.insert(chunkOf(vertex));
+                }
+                queue.clear();
+                break;
+            }
 
-    liftRecursive(fullSet);
+            const size_t vertex = queue.front();
+            queue.pop_front();
+            isQueued.erase(vertex);
 
-    return getResult(); // get results from measures table   
-}
+            if (isTop(vertex) || !lift(vertex)) {
+                continue;
+            }
 
-std::vector<Player> SPMSolver::solveRecursiveIncomingOrder(){
-    initializeMeasures(); // set all measures to (0,..,0)
+            for (const size_t predecessor : (*arena)[vertex].incoming) {
+                if (isQueued.contains(predecessor) || isTop(predecessor)) {
+                    continue;
+                }
+                isQueued.insert(predecessor);
+                if (predecessor >= begin && predecessor < end) {
+                    queue.push_back(predecessor);
+                } else {
+                    queuedChunks.insert(chunkOf(predecessor));
+                }
+            }
+        }
 
-    std::vector<size_t> fullSet;
-    fullSet.reserve(arena.getSize());
-    for (size_t i = 0; i < arena.getSize(); i++) {
-        fullSet.emplace_back(i);
+        chunk = queuedChunks.findNext(firstChunk + chunksPerBlock);
+        if (chunk == queuedChunks.getSize()) {
+            chunk = queuedChunks.findNext(0); // next round
+        }
     }
-    
-    std::sort(fullSet.begin(), fullSet.end(), [this](size_t a, size_t b) {
-        return arena[a].incoming.size() > arena[b].incoming.size();
-    });
 
-    liftRecursive(fullSet);
-
-    return getResult(); // get results from measures table   
+    return getResult(); // get results from measures table
 }
 
-
-bool SPMSolver::checkForSelfLoop(const Vertex& vertex) const
+template <typename MeasureType, typename StoreType, typename ArenaType>
+bool BasicSPMSolver<MeasureType, StoreType, ArenaType>::checkForSelfLoop(const size_t vertexId) const
 {
+    const auto& vertex = (*arena)[vertexId];
     if (vertex.incoming.size() < vertex.outgoing.size()) {
         return std::find(vertex.incoming.begin(), vertex.incoming.end(), vertex.id) != vertex.incoming.end();
     } else {
@@ -323,24 +643,35 @@ bool SPMSolver::checkForSelfLoop(const Vertex& vertex) const
     }
 }
 
-void SPMSolver::lockPredecessorsIfAble(const size_t vertexId, std::vector<size_t> & lockedVertices)
-{   
-    const Vertex& vertex = arena[vertexId];
-    const Measure & vertexMeasure = measures[vertexId];
+template <typename MeasureType, typename StoreType, typename ArenaType>
+void BasicSPMSolver<MeasureType, StoreType, ArenaType>::lock(const size_t vertex, std::vector<size_t> & lockedVertices)
+{
+    if (!locked.contains(vertex)) {
+        locked.insert(vertex);
+        lockedVertices.emplace_back(vertex);
+    }
+}
+
+template <typename MeasureType, typename StoreType, typename ArenaType>
+void BasicSPMSolver<MeasureType, StoreType, ArenaType>::lockPredecessorsIfAble(const size_t vertexId, std::vector<size_t> & lockedVertices)
+{
+    PAPG_TRACE_PHASE(propagation);
+    const auto& vertex = (*arena)[vertexId];
+    const bool isVertexTop = measures.isTop(vertexId); // lifting the predecessors may move measures around in the store
 
     for (auto& predecessorId : vertex.incoming) {
 
-        if(std::find(lockedVertices.begin(), lockedVertices.end(), predecessorId) != lockedVertices.end()){
+        if(locked.contains(predecessorId)){
             // predecessor is already locked, next
             continue;
         }
 
-        const Vertex& predecessor = arena[predecessorId];
+        const auto& predecessor = (*arena)[predecessorId];
 
-        if((vertexMeasure.isTop() 
+        if((isVertexTop 
             && predecessor.owner == Player::even 
             && predecessor.outgoing.size() > 1)
-            || (!vertexMeasure.isTop()
+            || (!isVertexTop
                 && predecessor.owner == Player::odd
                 && predecessor.outgoing.size() > 1)){
             // case B,H -> do nothing
@@ -351,110 +682,20 @@ void SPMSolver::lockPredecessorsIfAble(const size_t vertexId, std::vector<size_t
         
         while(lift(predecessorId)){
         }
-        lockedVertices.emplace_back(predecessorId);
+        lock(predecessorId, lockedVertices);
     }
 }
 
-std::vector<Player> SPMSolver::solvePropagation()
+template <typename MeasureType, typename StoreType, typename ArenaType>
+std::vector<size_t> BasicSPMSolver<MeasureType, StoreType, ArenaType>::lockSelfLoopVertices()
 {
-    initializeMeasures(); // set all measures to (0,..,0)
-
-    std::vector<size_t> lockedVertices; // vertices we know will lift no more
-    lockedVertices.reserve(arena.getSize());
-
-    // initial pass, lifting cases A,B,D,E,F and G.
-    for (auto& vertex : arena.getVertices()) {
-        const Player owner = vertex.owner;
-        const bool evenPriority = !(vertex.priority % 2);
-
-        if (vertex.outgoing.size() > 1) { // if there are more than 1 outgoing edges, we definitely have an edge that is not a self-loop
-            if ((owner == Player::odd && evenPriority) || (owner == Player::even && !evenPriority)) {
-                // cases C & H, and also some cases where there is no self-loop at all
-                continue;
-            }
-        }
-
-        if (!checkForSelfLoop(vertex)) {
-            // all remaining cases without a self-loop
-            continue;
-        }
-
-        // At this point we know the vertex is either of case A,B,D,E,F or G, meaning it
-        // can be lifted as much as possible and then locked in.
-
-        while (lift(vertex.id)) {
-        }
-
-        lockedVertices.emplace_back(vertex.id);
-    }
-
-    size_t oldLockedVerticesSize = 0; 
-
-    // repeatedly pass over locked vertices, lift and lock direct attracteds
-    // stop when lockedVertices stops growing
-    do {
-        oldLockedVerticesSize = lockedVertices.size();
-
-        for (auto& vertexId : lockedVertices) {
-            lockPredecessorsIfAble(vertexId, lockedVertices);
-        }
-    } while(lockedVertices.size() != oldLockedVerticesSize);
-
-    std::vector<size_t> unlockedVertices;
-    unlockedVertices.reserve(arena.getSize() - lockedVertices.size());
-
-    for(auto & vertex : arena.getVertices()){
-        if(std::find(lockedVertices.begin(), lockedVertices.end(), vertex.id) == lockedVertices.end()){
-            unlockedVertices.emplace_back(vertex.id);
-        }
-    }
-
-    // call liftRecursive on what's left
-    liftRecursive(unlockedVertices);
-
-    return getResult(); // get results from measures table
-}
-
-
-void SPMSolver::liftPropagationRecursiveHybrid(std::vector<size_t> & subset, std::vector<size_t> & lockedVertices){
-    std::vector<size_t> liftedVertices;
-    liftedVertices.reserve(subset.size());
-
-    while (true) {
-        for (auto& currentVertex : subset) {
-            if (!measures[currentVertex].isTop() && lift(currentVertex)) { // a change was made
-                if(measures[currentVertex].isTop()) { // vertex was just lifted to top
-                    lockPredecessorsIfAble(currentVertex, lockedVertices); // adds any vertices that are locked in the function to the lockedVertices vector
-                    lockedVertices.emplace_back(currentVertex);
-                }
-                liftedVertices.emplace_back(currentVertex);
-            }
-        }
-
-        if (liftedVertices.empty())
-            return;
-
-        if (liftedVertices.size() != subset.size()) {
-            liftPropagationRecursiveHybrid(liftedVertices, lockedVertices);
-        }
-
-        liftedVertices.clear();
-    }
-}
-
-std::vector<Player> SPMSolver::solvePropagationRecursiveHybrid(){
-    initializeMeasures(); // set all measures to (0,..,0)
-
-    std::vector<size_t> fullSet;
     std::vector<size_t> lockedVertices;
-    fullSet.reserve(arena.getSize());
-    lockedVertices.reserve(arena.getSize());
-    for (size_t i = 0; i < arena.getSize(); i++) {
-        fullSet.emplace_back(i);
-    }
+    lockedVertices.reserve(arena->getSize()); // lockPredecessorsIfAble appends while we iterate, must not reallocate
+    locked.assign(arena->getSize());
 
     // initial pass, lifting cases A,B,D,E,F and G.
-    for (auto& vertex : arena.getVertices()) {
+    PAPG_TRACE_PHASE(seeds);
+    for (const auto& vertex : arena->getVertices()) {
         const Player owner = vertex.owner;
         const bool evenPriority = !(vertex.priority % 2);
 
@@ -465,7 +706,7 @@ std::vector<Player> SPMSolver::solvePropagationRecursiveHybrid(){
             }
         }
 
-        if (!checkForSelfLoop(vertex)) {
+        if (!checkForSelfLoop(vertex.id)) {
             // all remaining cases without a self-loop
             continue;
         }
@@ -476,7 +717,7 @@ std::vector<Player> SPMSolver::solvePropagationRecursiveHybrid(){
         while (lift(vertex.id)) {
         }
 
-        lockedVertices.emplace_back(vertex.id);
+        lock(vertex.id, lockedVertices);
     }
 
     size_t oldLockedVerticesSize = 0; 
@@ -491,20 +732,17 @@ std::vector<Player> SPMSolver::solvePropagationRecursiveHybrid(){
         }
     } while(lockedVertices.size() != oldLockedVerticesSize);
 
-    std::vector<size_t> unlockedVertices;
-    unlockedVertices.reserve(arena.getSize() - lockedVertices.size());
-
-    for(auto & vertex : arena.getVertices()){
-        if(std::find(lockedVertices.begin(), lockedVertices.end(), vertex.id) == lockedVertices.end()){
-            unlockedVertices.emplace_back(vertex.id);
-        }
-    }
-
-
-    liftPropagationRecursiveHybrid(unlockedVertices, lockedVertices);
-
-    return getResult(); // get results from measures table
+    return lockedVertices;
 }
 
+template MaxMeasures<Measure>::MaxMeasures(const Arena&);
+template MaxMeasures<Measure>::MaxMeasures(const MappedArena&);
+template MaxMeasures<SuccinctMeasure>::MaxMeasures(const Arena&);
+
+template class BasicSPMSolver<Measure>;
+template class BasicSPMSolver<SuccinctMeasure>;
+template class BasicSPMSolver<Measure, InternedMeasureStore<Measure> >;
+template class BasicSPMSolver<Measure, MappedMeasureStore<Measure>, MappedArena>;
+template class BasicSPMSolver<Measure, SharedMeasureStore<Measure> >;
 
 } // PAPG
\ No newline at end of file
@@ -0,0 +1,392 @@
+#include "Server.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace PAPG {
+
+namespace {
+    const size_t readBufferSize = 1 << 16;
+    const int pollTimeout = 200; // ms between checks for stop() while waiting for connections
+
+    bool writeAll(int output, const char* data, size_t length)
+    {
+        while (length > 0) {
+            const ssize_t written = ::write(output, data, length);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            data += written;
+            length -= written;
+        }
+        return true;
+    }
+
+    uint32_t readUint32(const char* data)
+    {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+        return static_cast<uint32_t>(bytes[0]) | (static_cast<uint32_t>(bytes[1]) << 8)
+            | (static_cast<uint32_t>(bytes[2]) << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+    }
+}
+
+// buffered reading from one connection
+struct Server::Connection {
+    const int input;
+    const int output;
+    std::vector<char> buffer;
+    size_t position = 0;
+    size_t end = 0;
+
+    Connection(int input, int output)
+        : input(input)
+        , output(output)
+        , buffer(readBufferSize)
+    {
+    }
+
+    // refills the buffer, returns false at the end of the input
+    bool fill()
+    {
+        while (true) {
+            const ssize_t length = ::read(input, buffer.data(), buffer.size());
+            if (length < 0 && errno == EINTR) {
+                continue;
+            }
+            if (length <= 0) {
+                return false;
+            }
+            position = 0;
+            end = length;
+            return true;
+        }
+    }
+
+    bool readLine(std::string& line)
+    {
+        line.clear();
+        while (true) {
+            if (position == end && !fill()) {
+                return false;
+            }
+            const char* begin = buffer.data() + position;
+            const char* newline = static_cast<const char*>(std::memchr(begin, '\n', end - position));
+            if (newline != nullptr) {
+                line.append(begin, newline);
+                position += (newline - begin) + 1;
+                return true;
+            }
+            line.append(begin, end - position);
+            position = end;
+        }
+    }
+
+    bool read(char* data, size_t length)
+    {
+        while (length > 0) {
+            if (position == end && !fill()) {
+                return false;
+            }
+            const size_t chunk = std::min(length, end - position);
+            std::memcpy(data, buffer.data() + position, chunk);
+            position += chunk;
+            data += chunk;
+            length -= chunk;
+        }
+        return true;
+    }
+};
+
+Server::WorkerState::~WorkerState()
+{
+    for (auto& solver : solvers) {
+        papg_solver_destroy(solver.second);
+    }
+}
+
+Server::Server(const Options& options)
+    : options(options)
+    , isStopping(false)
+    , pending()
+    , active()
+    , mutex()
+    , changed()
+{
+}
+
+papg_solver* Server::getSolver(WorkerState& state, const std::string& name)
+{
+    auto it = state.solvers.find(name);
+    if (it != state.solvers.end()) {
+        return it->second;
+    }
+
+    papg_solver* solver = nullptr;
+    if (papg_solver_create(name.c_str(), &solver) != PAPG_OK) {
+        return nullptr;
+    }
+    papg_solver_set_preprocessing(solver, options.isPreprocessing);
+    papg_solver_set_time_limit(solver, options.timeLimit);
+    papg_solver_set_lift_budget(solver, options.liftBudget);
+
+    state.solvers[name] = solver;
+    return solver;
+}
+
+bool Server::decodeBinary(WorkerState& state, papg_arena** arena)
+{
+    const std::vector<char>& request = state.request;
+    size_t position = 0;
+
+    // reads a u32 at position if there is one
+    auto next = [&](uint32_t& value) {
+        if (request.size() - position < 4) {
+            return false;
+        }
+        value = readUint32(request.data() + position);
+        position += 4;
+        return true;
+    };
+
+    uint32_t numVertices = 0;
+    if (!next(numVertices)) {
+        return false;
+    }
+
+    state.owners.clear();
+    state.priorities.clear();
+    state.successorOffsets.assign(1, 0);
+    state.successors.clear();
+
+    for (uint32_t id = 0; id < numVertices; id++) {
+        uint32_t priority = 0;
+        uint32_t numSuccessors = 0;
+        if (position == request.size()) {
+            return false;
+        }
+        state.owners.push_back(static_cast<uint8_t>(request[position++]));
+        if (!next(priority) || !next(numSuccessors)) {
+            return false;
+        }
+        state.priorities.push_back(priority);
+
+        for (uint32_t i = 0; i < numSuccessors; i++) {
+            uint32_t successor = 0;
+            if (!next(successor)) {
+                return false;
+            }
+            state.successors.push_back(successor);
+        }
+        state.successorOffsets.push_back(state.successors.size());
+    }
+
+    return position == request.size()
+        && papg_arena_create(numVertices, state.owners.data(), state.priorities.data(),
+               state.successorOffsets.data(), state.successors.data(), arena)
+        == PAPG_OK;
+}
+
+bool Server::handleRequest(WorkerState& state, Connection& connection)
+{
+    std::string line;
+    if (!connection.readLine(line) || line == "quit") {
+        return false;
+    }
+
+    std::string& response = state.response;
+    auto fail = [&](const std::string& message, bool isFatal) {
+        response = "error " + message + "\n";
+        return writeAll(connection.output, response.data(), response.size()) && !isFatal;
+    };
+
+    // <format> <length> <name>, the name may contain spaces
+    const size_t first = line.find(' ');
+    const size_t second = (first == std::string::npos) ? std::string::npos : line.find(' ', first + 1);
+    if (second == std::string::npos) {
+        return fail("malformed request", true);
+    }
+    const std::string format = line.substr(0, first);
+    const std::string name = line.substr(second + 1);
+    const std::string lengthField = line.substr(first + 1, second - first - 1);
+    if (lengthField.empty() || lengthField.find_first_not_of("0123456789") != std::string::npos) {
+        return fail("malformed request", true); // stoull would take "-1" as well
+    }
+    unsigned long long length = 0;
+    try {
+        length = std::stoull(lengthField);
+    } catch (const std::exception&) { // out of range
+        return fail("request too large", true);
+    }
+    if (format != "text" && format != "binary") {
+        return fail("unknown format " + format, true);
+    }
+    // checked before allocating, the length is whatever the client claims
+    if (length > options.maxRequestSize) {
+        return fail("request too large", true);
+    }
+
+    try {
+        state.request.resize(length);
+    } catch (const std::exception&) { // bad_alloc or length_error
+        return fail("request too large", true);
+    }
+    if (!connection.read(state.request.data(), length)) {
+        return false;
+    }
+
+    papg_solver* solver = getSolver(state, name);
+    if (solver == nullptr) {
+        return fail("unknown strategy " + name, false);
+    }
+
+    papg_arena* arena = nullptr;
+    const bool isParsed = (format == "text")
+        ? papg_arena_parse_text(state.request.data(), length, &arena) == PAPG_OK
+        : decodeBinary(state, &arena);
+    if (!isParsed) {
+        return fail("bad arena", false);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const papg_status status = papg_solve(solver, arena);
+    const auto time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    const size_t numVertices = papg_arena_size(arena);
+    papg_arena_destroy(arena);
+
+    if (status != PAPG_OK) {
+        return fail(papg_solver_error(solver), false);
+    }
+
+    const size_t numCounters = papg_solver_counter_count(solver);
+    response = "ok " + std::to_string(numVertices) + " " + std::to_string(time) + " " + std::to_string(numCounters) + "\n";
+    for (size_t i = 0; i < numCounters; i++) {
+        response += papg_solver_counter_name(solver, i);
+        response += "=" + std::to_string(papg_solver_counter_value(solver, i)) + "\n";
+    }
+    const uint8_t* winners = papg_solver_winners(solver);
+    for (size_t id = 0; id < numVertices; id++) {
+        response += (winners[id] == PAPG_EVEN) ? '0' : '1';
+    }
+    response += '\n';
+
+    return writeAll(connection.output, response.data(), response.size());
+}
+
+void Server::serve(int input, int output)
+{
+    WorkerState state;
+    Connection connection(input, output);
+    while (handleRequest(state, connection)) {
+    }
+}
+
+void Server::work()
+{
+    WorkerState state; // kept for every connection this worker handles
+
+    while (true) {
+        int connection = -1;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [this]() { return !pending.empty() || isStopping; });
+            if (isStopping) {
+                return;
+            }
+            connection = pending.front();
+            pending.pop_front();
+            active.insert(connection);
+        }
+
+        Connection reader(connection, connection);
+        while (handleRequest(state, reader)) {
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            active.erase(connection);
+        }
+        ::close(connection);
+    }
+}
+
+void Server::listen(const std::string& path)
+{
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::invalid_argument("ERR: socket path is too long.");
+    }
+    std::strcpy(address.sun_path, path.c_str());
+
+    // a socket left behind by an earlier server is replaced, anything else is not
+    struct stat status;
+    if (::stat(path.c_str(), &status) == 0 && S_ISSOCK(status.st_mode)) {
+        ::unlink(path.c_str());
+    }
+
+    const int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        throw std::runtime_error("ERR: failed to create socket.");
+    }
+    if (::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(listener, SOMAXCONN) != 0) {
+        ::close(listener);
+        throw std::runtime_error("ERR: failed to listen on " + path + ": " + std::strerror(errno));
+    }
+
+    const unsigned numThreads = (options.numThreads > 0) ? options.numThreads : std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < numThreads; i++) {
+        workers.emplace_back(&Server::work, this);
+    }
+
+    pollfd waiting = { listener, POLLIN, 0 };
+    while (!isStopping) {
+        if (::poll(&waiting, 1, pollTimeout) <= 0) {
+            continue;
+        }
+        const int connection = ::accept(listener, nullptr, nullptr);
+        if (connection < 0) {
+            continue;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending.push_back(connection);
+        }
+        changed.notify_one();
+    }
+
+    ::close(listener);
+    ::unlink(path.c_str());
+
+    {
+        // wakes up workers waiting for requests on open connections
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const int connection : active) {
+            ::shutdown(connection, SHUT_RDWR);
+        }
+    }
+    changed.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    for (const int connection : pending) {
+        ::close(connection);
+    }
+    pending.clear();
+}
+
+} // PAPG
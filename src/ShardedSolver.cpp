@@ -0,0 +1,382 @@
+#include "ShardedSolver.hpp"
+#include "VertexSet.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <deque>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+#include <thread>
+
+#include <sched.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace PAPG {
+
+namespace {
+    // one busy worker in ShardedSolver's counter, the ids on their way count one each
+    const uint64_t busyWorker = 1ull << 32;
+
+    // lifts between looking for ids from the other workers and sending ours
+    const size_t liftBatch = 256;
+
+    // an idle worker yields this many times before it starts to sleep between looks
+    const unsigned idleSpins = 64;
+
+    struct Header {
+        alignas(64) std::atomic<uint64_t> activity; // busy workers times busyWorker plus the ids on their way
+        alignas(64) std::atomic<uint32_t> isStopped;
+    };
+
+    struct Counters {
+        alignas(64) std::atomic<uint64_t> lifts;
+        std::atomic<uint64_t> idsSent;
+        std::atomic<uint64_t> idsReceived;
+    };
+
+    // ids of vertices changed by the producer, for the consumer
+    struct Ring {
+        alignas(64) std::atomic<uint64_t> head; // the next one to take, only moved by the consumer
+        alignas(64) std::atomic<uint64_t> tail; // one past the last one put, only moved by the producer
+        alignas(64) uint32_t ids[ShardedSolver::ringCapacity];
+    };
+
+    static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2, "the shared state needs lock-free atomics");
+}
+
+ShardedSolver::ShardedSolver(const Arena& arena, unsigned numWorkers)
+    : arena(arena)
+    , numWorkers(numWorkers)
+    , shardBegins()
+    , shardOf(arena.getSize(), 0)
+    , remoteShards()
+    , remoteShardOffsets()
+    , solver(arena)
+    , sharedState()
+    , stats()
+{
+    if (numWorkers == 0) {
+        throw std::invalid_argument("ShardedSolver(): needs at least one worker!");
+    }
+    if (arena.getSize() > UINT32_MAX) {
+        throw std::invalid_argument("ShardedSolver(): vertex ids must fit in 32 bits!");
+    }
+    makeShards();
+}
+
+void ShardedSolver::makeShards()
+{
+    // about the same number of vertices plus edges in every shard
+    size_t totalWeight = 0;
+    for (const Vertex& vertex : arena.getVertices()) {
+        totalWeight += 1 + vertex.outgoing.size();
+    }
+
+    shardBegins.assign(1, 0);
+    size_t weight = 0;
+    for (size_t id = 0; id < arena.getSize(); id++) {
+        while (shardBegins.size() < numWorkers && weight >= totalWeight * shardBegins.size() / numWorkers) {
+            shardBegins.push_back(id);
+        }
+        shardOf[id] = shardBegins.size() - 1;
+        weight += 1 + arena[id].outgoing.size();
+    }
+    shardBegins.resize(numWorkers, arena.getSize());
+    shardBegins.push_back(arena.getSize());
+
+    remoteShards.clear();
+    remoteShardOffsets.assign(1, 0);
+    for (const Vertex& vertex : arena.getVertices()) {
+        const size_t first = remoteShards.size();
+        for (const size_t predecessor : vertex.incoming) {
+            if (shardOf[predecessor] != shardOf[vertex.id]) {
+                remoteShards.push_back(shardOf[predecessor]);
+            }
+        }
+        std::sort(remoteShards.begin() + first, remoteShards.end());
+        remoteShards.erase(std::unique(remoteShards.begin() + first, remoteShards.end()), remoteShards.end());
+        remoteShardOffsets.push_back(remoteShards.size());
+    }
+}
+
+void ShardedSolver::work(unsigned worker)
+{
+    char* const base = sharedState.getData();
+    Header& header = *reinterpret_cast<Header*>(base);
+    Counters& counters = reinterpret_cast<Counters*>(base + sizeof(Header))[worker];
+    Ring* const rings = reinterpret_cast<Ring*>(base + sizeof(Header) + numWorkers * sizeof(Counters));
+    auto getRing = [&](unsigned from, unsigned to) -> Ring& { return rings[from * numWorkers + to]; };
+
+    std::deque<size_t> queue;
+    VertexSet isQueued(arena.getSize());
+    auto enqueuePredecessors = [&](size_t vertex) {
+        for (const size_t predecessor : arena[vertex].incoming) {
+            if (shardOf[predecessor] == worker && !isQueued.contains(predecessor)) {
+                isQueued.insert(predecessor);
+                queue.push_back(predecessor);
+            }
+        }
+    };
+    for (size_t vertex = shardBegins[worker]; vertex < shardBegins[worker + 1]; vertex++) {
+        isQueued.insert(vertex);
+        queue.push_back(vertex);
+    }
+
+    // vertices of the shard that changed since the last send and have predecessors
+    // in other shards, and per worker the ids that didn't fit in its ring yet
+    std::vector<size_t> changed;
+    VertexSet isChanged(arena.getSize());
+    std::vector<std::deque<uint32_t> > outboxes(numWorkers);
+
+    auto receive = [&]() {
+        uint64_t numReceived = 0;
+        for (unsigned from = 0; from < numWorkers; from++) {
+            Ring& ring = getRing(from, worker);
+            const uint64_t head = ring.head.load(std::memory_order_relaxed);
+            const uint64_t tail = ring.tail.load(std::memory_order_acquire);
+            for (uint64_t i = head; i < tail; i++) {
+                const size_t vertex = ring.ids[i % ringCapacity];
+                solver.noteChanged(vertex);
+                enqueuePredecessors(vertex);
+            }
+            ring.head.store(tail, std::memory_order_release);
+            numReceived += tail - head;
+        }
+        if (numReceived > 0) {
+            counters.idsReceived.fetch_add(numReceived, std::memory_order_relaxed);
+            header.activity.fetch_sub(numReceived, std::memory_order_acq_rel);
+        }
+    };
+
+    auto hasIncoming = [&]() {
+        for (unsigned from = 0; from < numWorkers; from++) {
+            const Ring& ring = getRing(from, worker);
+            if (ring.tail.load(std::memory_order_acquire) != ring.head.load(std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    // sends what fits, the rest waits in the outboxes for the consumer to catch up
+    auto send = [&]() {
+        for (const size_t vertex : changed) {
+            isChanged.erase(vertex);
+            for (size_t i = remoteShardOffsets[vertex]; i < remoteShardOffsets[vertex + 1]; i++) {
+                outboxes[remoteShards[i]].push_back(vertex);
+            }
+        }
+        changed.clear();
+
+        bool isEmpty = true;
+        for (unsigned to = 0; to < numWorkers; to++) {
+            std::deque<uint32_t>& outbox = outboxes[to];
+            if (outbox.empty()) {
+                continue;
+            }
+
+            Ring& ring = getRing(worker, to);
+            const uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+            const uint64_t head = ring.head.load(std::memory_order_acquire);
+            const size_t count = std::min<size_t>(outbox.size(), ringCapacity - (tail - head));
+            for (size_t i = 0; i < count; i++) {
+                ring.ids[(tail + i) % ringCapacity] = outbox[i];
+            }
+            outbox.erase(outbox.begin(), outbox.begin() + count);
+
+            // counted before the consumer can see them, so the counter can't drop to zero while they wait
+            header.activity.fetch_add(count, std::memory_order_acq_rel);
+            ring.tail.store(tail + count, std::memory_order_release);
+            counters.idsSent.fetch_add(count, std::memory_order_relaxed);
+            isEmpty = isEmpty && outbox.empty();
+        }
+        return isEmpty;
+    };
+
+    while (true) {
+        if (header.isStopped.load(std::memory_order_relaxed)) {
+            return;
+        }
+
+        receive();
+        for (size_t i = 0; i < liftBatch && !queue.empty(); i++) {
+            const size_t vertex = queue.front();
+            queue.pop_front();
+            isQueued.erase(vertex);
+
+            if (solver.isTop(vertex) || !solver.lift(vertex)) {
+                continue;
+            }
+            enqueuePredecessors(vertex);
+            if (remoteShardOffsets[vertex] != remoteShardOffsets[vertex + 1] && !isChanged.contains(vertex)) {
+                isChanged.insert(vertex);
+                changed.push_back(vertex);
+            }
+        }
+        const bool isSent = send();
+        counters.lifts.store(solver.getLiftCount(), std::memory_order_relaxed);
+
+        if (!queue.empty() || !isSent) {
+            continue;
+        }
+
+        // nothing left to do until another worker sends something, or all are done
+        header.activity.fetch_sub(busyWorker, std::memory_order_acq_rel);
+        for (unsigned spins = 0;; spins++) {
+            if (header.isStopped.load(std::memory_order_relaxed)) {
+                return;
+            }
+            if (hasIncoming()) {
+                header.activity.fetch_add(busyWorker, std::memory_order_acq_rel);
+                break;
+            }
+            if (header.activity.load(std::memory_order_acquire) == 0) {
+                return;
+            }
+
+            if (spins < idleSpins) {
+                ::sched_yield();
+            } else {
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+        }
+    }
+}
+
+std::vector<Player> ShardedSolver::solve(SolveControl* control)
+{
+    solver.setControl(nullptr); // the workers don't share it, the control is checked here
+    solver.resetLiftCount();
+    solver.initializeMeasures();
+
+    const size_t countersOffset = sizeof(Header);
+    const size_t ringsOffset = countersOffset + numWorkers * sizeof(Counters);
+    sharedState = MappedFile();
+    sharedState = MappedFile::createShared(ringsOffset + numWorkers * numWorkers * sizeof(Ring));
+
+    char* const base = sharedState.getData();
+    Header& header = *new (base) Header();
+    Counters* const counters = reinterpret_cast<Counters*>(base + countersOffset);
+    for (unsigned worker = 0; worker < numWorkers; worker++) {
+        new (&counters[worker]) Counters();
+    }
+    Ring* const rings = reinterpret_cast<Ring*>(base + ringsOffset);
+    for (unsigned ring = 0; ring < numWorkers * numWorkers; ring++) {
+        new (&rings[ring]) Ring();
+    }
+    header.activity.store(numWorkers * busyWorker);
+
+    // what is still buffered would be written by every worker as well
+    std::cout.flush();
+    std::cerr.flush();
+
+    const pid_t parent = ::getpid();
+    std::vector<pid_t> workers;
+    for (unsigned worker = 0; worker < numWorkers && arena.getSize() > 0; worker++) {
+        const pid_t pid = ::fork();
+        if (pid == 0) {
+            // the parent stops the workers on signals, and they don't outlive it
+            std::signal(SIGINT, SIG_IGN);
+            std::signal(SIGUSR1, SIG_IGN);
+            std::signal(SIGTERM, SIG_DFL);
+            ::prctl(PR_SET_PDEATHSIG, SIGKILL);
+            if (::getppid() != parent) {
+                ::_exit(1); // it ended before the line above
+            }
+
+            int status = 0;
+            try {
+                work(worker);
+            } catch (const std::exception& exception) {
+                std::cerr << "ERR: worker " << worker << ": " << exception.what() << std::endl;
+                status = 1;
+            }
+            ::_exit(status);
+        }
+        if (pid < 0) {
+            break;
+        }
+        workers.push_back(pid);
+    }
+
+    // waits for the workers that are left, stopping them first if isStopping
+    auto waitAll = [&](bool isStopping) {
+        if (isStopping) {
+            header.isStopped.store(1);
+        }
+        bool isFailed = false;
+        for (const pid_t pid : workers) {
+            int status = 0;
+            if (pid > 0) {
+                isFailed = ::waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0 || isFailed;
+            }
+        }
+        workers.clear();
+        return !isFailed;
+    };
+
+    auto getLiftCount = [&]() {
+        unsigned long long lifts = 0;
+        for (unsigned worker = 0; worker < numWorkers; worker++) {
+            lifts += counters[worker].lifts.load(std::memory_order_relaxed);
+        }
+        return lifts;
+    };
+
+    if (workers.size() != numWorkers && arena.getSize() > 0) {
+        waitAll(true);
+        throw std::runtime_error("ERR: failed to start the workers of the sharded solver.");
+    }
+
+    size_t numRunning = workers.size();
+    while (numRunning > 0) {
+        for (pid_t& pid : workers) {
+            int status = 0;
+            if (pid <= 0 || ::waitpid(pid, &status, WNOHANG) != pid) {
+                continue;
+            }
+            pid = 0;
+            numRunning--;
+            if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+                waitAll(true);
+                throw std::runtime_error("ERR: a worker of the sharded solver failed.");
+            }
+        }
+        if (numRunning == 0) {
+            break;
+        }
+
+        if (control != nullptr) {
+            Progress progress;
+            progress.lifts = getLiftCount();
+            try {
+                control->check(progress);
+            } catch (const SolveInterrupted&) {
+                waitAll(true);
+                throw;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    workers.clear();
+
+    stats.clear();
+    for (unsigned worker = 0; worker < numWorkers; worker++) {
+        stats.push_back(WorkerStats{ shardBegins[worker + 1] - shardBegins[worker], counters[worker].lifts.load(), counters[worker].idsSent.load(),
+            counters[worker].idsReceived.load() });
+    }
+
+    std::vector<Player> result;
+    result.reserve(arena.getSize());
+    for (size_t id = 0; id < arena.getSize(); id++) {
+        result.push_back(solver.getMeasureStore().isTop(id) ? Player::odd : Player::even);
+    }
+    return result;
+}
+
+} // PAPG
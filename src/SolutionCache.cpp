@@ -0,0 +1,227 @@
+#include "SolutionCache.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace PAPG {
+
+namespace {
+    const char magic[8] = { 'P', 'A', 'P', 'G', 'S', 'O', 'L', '2' };
+    const std::string extension = ".sol";
+
+    struct Header {
+        char magic[8];
+        uint64_t keyHigh;
+        uint64_t keyLow;
+        uint64_t numVertices;
+    };
+
+    // the splitmix64 finalizer, a bijection that spreads every input bit over the output
+    uint64_t mix(uint64_t value)
+    {
+        value ^= value >> 30;
+        value *= 0xbf58476d1ce4e5b9ULL;
+        value ^= value >> 27;
+        value *= 0x94d049bb133111ebULL;
+        value ^= value >> 31;
+        return value;
+    }
+
+    // two differently seeded and combined lanes, for 128 bits
+    class Hasher {
+    private:
+        uint64_t high;
+        uint64_t low;
+
+    public:
+        Hasher()
+            : high(0x243f6a8885a308d3ULL)
+            , low(0x13198a2e03707344ULL)
+        {
+        }
+
+        inline void add(uint64_t word)
+        {
+            high = mix(high ^ word);
+            low = mix(low + word * 0x9e3779b97f4a7c15ULL);
+        }
+
+        inline SolutionCache::Key getKey() const { return SolutionCache::Key{ high, low }; }
+    };
+
+    struct CacheFile {
+        std::string path;
+        uint64_t size;
+        struct timespec modified;
+    };
+}
+
+std::string SolutionCache::Key::toString() const
+{
+    char digits[33];
+    std::snprintf(digits, sizeof(digits), "%016llx%016llx", static_cast<unsigned long long>(high), static_cast<unsigned long long>(low));
+    return digits;
+}
+
+SolutionCache::SolutionCache(const std::string& directory, uint64_t maxBytes)
+    : directory(directory)
+    , maxBytes(maxBytes)
+    , stats()
+{
+    if (::mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST) {
+        throw std::runtime_error("ERR: failed to make the cache directory " + directory + ": " + std::strerror(errno));
+    }
+    struct stat status;
+    if (::stat(directory.c_str(), &status) != 0 || !S_ISDIR(status.st_mode)) {
+        throw std::runtime_error("ERR: " + directory + " is not a directory.");
+    }
+}
+
+SolutionCache::Key SolutionCache::makeKey(const Arena& arena, const std::string& strategyName)
+{
+    Hasher hasher;
+    hasher.add(arena.getSize());
+
+    std::vector<size_t> successors;
+    for (const Vertex& vertex : arena.getVertices()) {
+        hasher.add(vertex.owner == Player::odd);
+        hasher.add(vertex.priority);
+        hasher.add(vertex.outgoing.size());
+
+        successors.assign(vertex.outgoing.begin(), vertex.outgoing.end());
+        std::sort(successors.begin(), successors.end());
+        for (const size_t successor : successors) {
+            hasher.add(successor);
+        }
+    }
+
+    hasher.add(strategyName.size());
+    for (const char character : strategyName) {
+        hasher.add(static_cast<unsigned char>(character));
+    }
+
+    return hasher.getKey();
+}
+
+std::string SolutionCache::getPath(const Key& key) const
+{
+    return directory + "/" + key.toString() + extension;
+}
+
+bool SolutionCache::load(const Key& key, size_t numVertices, Entry& entry)
+{
+    const std::string path = getPath(key);
+    std::ifstream file(path, std::ios::binary);
+
+    Header header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))
+        || std::memcmp(header.magic, magic, sizeof(magic)) != 0
+        || header.keyHigh != key.high || header.keyLow != key.low || header.numVertices != numVertices) {
+        stats.misses++;
+        return false;
+    }
+
+    std::vector<unsigned char> bits((numVertices + 7) / 8);
+    if (!file.read(reinterpret_cast<char*>(bits.data()), bits.size())) {
+        stats.misses++;
+        return false;
+    }
+
+    entry.winners.resize(numVertices);
+    for (size_t id = 0; id < numVertices; id++) {
+        entry.winners[id] = ((bits[id / 8] >> (id % 8)) & 1) ? Player::odd : Player::even;
+    }
+
+    ::utimensat(AT_FDCWD, path.c_str(), nullptr, 0); // used just now, for the eviction order
+    stats.hits++;
+    return true;
+}
+
+void SolutionCache::store(const Key& key, const Entry& entry)
+{
+    const size_t numVertices = entry.winners.size();
+    Header header;
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.keyHigh = key.high;
+    header.keyLow = key.low;
+    header.numVertices = numVertices;
+
+    std::vector<unsigned char> bits((numVertices + 7) / 8, 0);
+    for (size_t id = 0; id < numVertices; id++) {
+        if (entry.winners[id] == Player::odd) {
+            bits[id / 8] |= 1 << (id % 8);
+        }
+    }
+
+    // written in full under a name of our own first, so no one reads half a file
+    const std::string path = getPath(key);
+    const std::string temporaryPath = path + ".tmp" + std::to_string(::getpid());
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(bits.data()), bits.size());
+        file.close();
+        if (!file) {
+            std::remove(temporaryPath.c_str());
+            return;
+        }
+    }
+    if (std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        std::remove(temporaryPath.c_str());
+        return;
+    }
+    stats.stores++;
+
+    evict();
+}
+
+void SolutionCache::evict()
+{
+    DIR* listing = ::opendir(directory.c_str());
+    if (listing == nullptr) {
+        return;
+    }
+
+    std::vector<CacheFile> files;
+    uint64_t totalBytes = 0;
+    while (const dirent* item = ::readdir(listing)) {
+        const std::string name = item->d_name;
+        struct stat status;
+        if (name.size() <= extension.size() || name.compare(name.size() - extension.size(), extension.size(), extension) != 0
+            || ::stat((directory + "/" + name).c_str(), &status) != 0) {
+            continue;
+        }
+        files.push_back(CacheFile{ directory + "/" + name, static_cast<uint64_t>(status.st_size), status.st_mtim });
+        totalBytes += status.st_size;
+    }
+    ::closedir(listing);
+
+    if (totalBytes <= maxBytes) {
+        return;
+    }
+
+    std::sort(files.begin(), files.end(), [](const CacheFile& a, const CacheFile& b) {
+        return (a.modified.tv_sec != b.modified.tv_sec) ? a.modified.tv_sec < b.modified.tv_sec : a.modified.tv_nsec < b.modified.tv_nsec;
+    });
+    for (const CacheFile& file : files) {
+        if (totalBytes <= maxBytes) {
+            break;
+        }
+        if (::unlink(file.path.c_str()) == 0) {
+            stats.evictions++;
+        }
+        totalBytes -= file.size; // removed by someone else if unlink() failed
+    }
+}
+
+} // PAPG
@@ -0,0 +1,90 @@
+#include "SolveControl.hpp"
+
+namespace PAPG {
+
+const unsigned long long SolveControl::checkInterval;
+
+SolveControl::SolveControl()
+    : timeLimit(std::chrono::steady_clock::duration::zero())
+    , liftBudget(0)
+    , progressInterval(std::chrono::steady_clock::duration::zero())
+    , progressCallback()
+    , checkpointer(nullptr)
+    , isCancelRequested(false)
+    , isReportRequested(false)
+    , startTime(std::chrono::steady_clock::now())
+    , nextReport(startTime)
+    , reportMutex()
+{
+}
+
+void SolveControl::start()
+{
+    startTime = std::chrono::steady_clock::now();
+    nextReport = startTime + progressInterval;
+}
+
+void SolveControl::report(Progress progress, std::chrono::steady_clock::time_point now)
+{
+    progress.seconds = std::chrono::duration<double>(now - startTime).count();
+    if (progressCallback) {
+        progressCallback(progress);
+    }
+    nextReport = now + progressInterval;
+}
+
+void SolveControl::check(const Progress& progress)
+{
+    const auto now = std::chrono::steady_clock::now();
+
+    // report before a cancellation, so the stats at that point aren't lost.
+    // Periodic reports are skipped by threads that find another one reporting.
+    const bool isRequested = isReportRequested.exchange(false);
+    if (isRequested || progressInterval != std::chrono::steady_clock::duration::zero()) {
+        std::unique_lock<std::mutex> lock(reportMutex, std::defer_lock);
+        if (isRequested) {
+            lock.lock();
+        } else {
+            lock.try_lock();
+        }
+
+        if (lock.owns_lock() && (isRequested || now >= nextReport)) {
+            report(progress, now);
+        }
+    }
+
+    Progress current = progress;
+    current.seconds = std::chrono::duration<double>(now - startTime).count();
+
+    if (isCancelRequested) {
+        throw SolveInterrupted(Reason::cancelled, current);
+    }
+    if (liftBudget != 0 && progress.lifts > liftBudget) {
+        throw SolveInterrupted(Reason::liftBudget, current);
+    }
+    if (timeLimit != std::chrono::steady_clock::duration::zero() && now - startTime >= timeLimit) {
+        throw SolveInterrupted(Reason::timeout, current);
+    }
+}
+
+SolveInterrupted::SolveInterrupted(SolveControl::Reason reason, const Progress& progress)
+    : std::runtime_error("solve interrupted: " + toString(reason))
+    , reason(reason)
+    , progress(progress)
+{
+}
+
+std::string toString(SolveControl::Reason reason)
+{
+    switch (reason) {
+    case SolveControl::Reason::timeout:
+        return "timeout";
+    case SolveControl::Reason::liftBudget:
+        return "lift budget";
+    case SolveControl::Reason::cancelled:
+        return "cancelled";
+    }
+    return "unknown";
+}
+
+} // PAPG
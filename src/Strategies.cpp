@@ -0,0 +1,153 @@
+#include "Strategies.hpp"
+#include "PPSolver.hpp"
+#include "SISolver.hpp"
+#include "SPMSolver.hpp"
+#include "TLSolver.hpp"
+#include "ZielonkaSolver.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+
+namespace PAPG {
+
+namespace {
+    template <typename MeasureType>
+    void addMeasureStoreCounters(const FlatMeasureStore<MeasureType>& store, Counters& counters)
+    {
+        counters.emplace_back("measure bytes", store.getMemoryUsage());
+    }
+
+    template <typename MeasureType>
+    void addMeasureStoreCounters(const InternedMeasureStore<MeasureType>& store, Counters& counters)
+    {
+        counters.emplace_back("measure bytes", store.getMemoryUsage());
+        counters.emplace_back("max distinct measures", store.getMaxDistinctCount());
+    }
+
+    template <typename Solver>
+    Strategy makeSPMStrategy(const std::string& name, const std::string& engine, std::vector<Player> (Solver::*solve)())
+    {
+        return Strategy{ name, engine, [solve](const Arena& arena, Workspace& workspace, SolveControl& control, Counters& counters, std::vector<size_t>*) {
+                            Solver& solver = workspace.get<Solver>(arena, workspace.getShared<typename Solver::MaxMeasuresType>(arena));
+                            solver.setControl(&control);
+                            auto results = (solver.*solve)();
+                            counters.emplace_back("lifts", solver.getLiftCount());
+                            counters.emplace_back("rescans avoided", solver.getRescansAvoidedCount());
+                            counters.emplace_back("region max measures", solver.getRegionMaxMeasureCount());
+                            counters.emplace_back("max recursion depth", solver.getMaxRecursionDepth());
+                            addMeasureStoreCounters(solver.getMeasureStore(), counters);
+                            return results;
+                        } };
+    }
+
+    Strategy makeZielonkaStrategy()
+    {
+        return Strategy{ "zielonka", "zielonka", [](const Arena& arena, Workspace& workspace, SolveControl& control, Counters& counters, std::vector<size_t>*) {
+                            ZielonkaSolver& solver = workspace.get<ZielonkaSolver>(arena);
+                            solver.setControl(&control);
+                            auto results = solver.solve();
+                            counters.emplace_back("recursive calls", solver.getRecursiveCallCount());
+                            counters.emplace_back("attractors", solver.getAttractorCount());
+                            counters.emplace_back("parallel calls", solver.getParallelCallCount());
+                            counters.emplace_back("max recursion depth", solver.getMaxRecursionDepth());
+                            return results;
+                        } };
+    }
+
+    Strategy makePPStrategy(const std::string& name, std::vector<Player> (PPSolver::*solve)())
+    {
+        return Strategy{ name, "pp", [solve](const Arena& arena, Workspace& workspace, SolveControl& control, Counters& counters, std::vector<size_t>*) {
+                            PPSolver& solver = workspace.get<PPSolver>(arena);
+                            solver.setControl(&control);
+                            auto results = (solver.*solve)();
+                            counters.emplace_back("promotions", solver.getPromotionCount());
+                            counters.emplace_back("resets", solver.getResetCount());
+                            counters.emplace_back("recoveries", solver.getRecoveryCount());
+                            counters.emplace_back("dominions", solver.getDominionCount());
+                            counters.emplace_back("attractors", solver.getAttractorCount());
+                            return results;
+                        } };
+    }
+
+    Strategy makeSIStrategy(const std::string& name, std::vector<Player> (SISolver::*solve)())
+    {
+        return Strategy{ name, "si", [solve](const Arena& arena, Workspace& workspace, SolveControl& control, Counters& counters, std::vector<size_t>* winningStrategy) {
+                            SISolver& solver = workspace.get<SISolver>(arena);
+                            solver.setControl(&control);
+                            auto results = (solver.*solve)();
+                            if (winningStrategy != nullptr) {
+                                *winningStrategy = solver.getWinningStrategy();
+                            }
+                            counters.emplace_back("lifts", solver.getLiftCount());
+                            counters.emplace_back("iterations", solver.getIterationCount());
+                            counters.emplace_back("switches", solver.getSwitchCount());
+                            counters.emplace_back("rounds", solver.getRoundCount());
+                            return results;
+                        } };
+    }
+
+    Strategy makeTLStrategy()
+    {
+        return Strategy{ "tangle learning", "tl", [](const Arena& arena, Workspace& workspace, SolveControl& control, Counters& counters, std::vector<size_t>*) {
+                            TLSolver& solver = workspace.get<TLSolver>(arena);
+                            solver.setControl(&control);
+                            auto results = solver.solve();
+                            counters.emplace_back("tangles", solver.getTangleCount());
+                            counters.emplace_back("iterations", solver.getIterationCount());
+                            counters.emplace_back("attractors", solver.getAttractorCount());
+                            counters.emplace_back("dominions", solver.getDominionCount());
+                            return results;
+                        } };
+    }
+}
+
+std::vector<Strategy> makeStrategies()
+{
+    return {
+        makeSPMStrategy("input order", "spm", &SPMSolver::solveInputOrder),
+        makeSPMStrategy("random order", "spm", &SPMSolver::solveRandomOrder),
+        makeSPMStrategy("priority order", "spm", &SPMSolver::solvePriorityOrder),
+        makeSPMStrategy("incoming order", "spm", &SPMSolver::solveIncomingOrder),
+        makeSPMStrategy("recursive", "spm", &SPMSolver::solveRecursive),
+        makeSPMStrategy("recursive priority order", "spm", &SPMSolver::solveRecursivePriorityOrder),
+        makeSPMStrategy("recursive incoming order", "spm", &SPMSolver::solveRecursiveIncomingOrder),
+        makeSPMStrategy("propagation", "spm", &SPMSolver::solvePropagation),
+        makeSPMStrategy("propagation recursive hybrid", "spm", &SPMSolver::solvePropagationRecursiveHybrid),
+        makeSPMStrategy("worklist", "spm", &SPMSolver::solveWorklist),
+        makeSPMStrategy("propagation worklist", "spm", &SPMSolver::solvePropagationWorklist),
+        makeSPMStrategy("succinct input order", "succinct", &SuccinctSPMSolver::solveInputOrder),
+        makeSPMStrategy("succinct priority order", "succinct", &SuccinctSPMSolver::solvePriorityOrder),
+        makeSPMStrategy("succinct recursive", "succinct", &SuccinctSPMSolver::solveRecursive),
+        makeSPMStrategy("succinct propagation recursive hybrid", "succinct", &SuccinctSPMSolver::solvePropagationRecursiveHybrid),
+        makeSPMStrategy("interned recursive", "interned", &InternedSPMSolver::solveRecursive),
+        makeSPMStrategy("interned propagation recursive hybrid", "interned", &InternedSPMSolver::solvePropagationRecursiveHybrid),
+        makeZielonkaStrategy(),
+        makePPStrategy("priority promotion", &PPSolver::solvePriorityPromotion),
+        makePPStrategy("priority promotion plus", &PPSolver::solvePriorityPromotionPlus),
+        makePPStrategy("region recovery", &PPSolver::solveRegionRecovery),
+        makeSIStrategy("strategy improvement all profitable", &SISolver::solveAllProfitable),
+        makeSIStrategy("strategy improvement locally optimal", &SISolver::solveLocallyOptimal),
+        makeTLStrategy()
+    };
+}
+
+Strategy makeAutoStrategy(const StrategySelector& selector, std::function<void(const StrategySelector::Choice&)> onChoice)
+{
+    const std::shared_ptr<const std::vector<Strategy> > all = std::make_shared<const std::vector<Strategy> >(makeStrategies());
+    for (auto& name : selector.getStrategies()) {
+        if (std::none_of(all->begin(), all->end(), [&](const Strategy& strategy) { return strategy.name == name; })) {
+            throw std::invalid_argument("ERR: the strategy selector chooses an unknown strategy: " + name);
+        }
+    }
+
+    return Strategy{ "auto", "auto", [all, selector, onChoice](const Arena& arena, Workspace& workspace, SolveControl& control, Counters& counters, std::vector<size_t>* winningStrategy) {
+                        const StrategySelector::Choice choice = selector.choose(StrategySelector::computeFeatures(arena));
+                        const auto chosen = std::find_if(all->begin(), all->end(), [&](const Strategy& strategy) { return strategy.name == choice.strategy; });
+                        onChoice(choice);
+                        counters.emplace_back("auto choice", chosen - all->begin() + 1);
+                        return chosen->solve(arena, workspace, control, counters, winningStrategy);
+                    } };
+}
+
+} // PAPG
@@ -0,0 +1,304 @@
+#include "StrategySelector.hpp"
+#include "SCCDecomposition.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+
+namespace PAPG {
+
+namespace {
+    const std::string header = "papg strategy selector 1";
+
+    // a subset with fewer games isn't split any further
+    const size_t minLeafSamples = 5;
+
+    // Times get this many µS added before they are compared, so the noise of
+    // games solved in next to no time doesn't weigh as much as real gaps.
+    const double timeSmoothing = 100;
+
+    // a run that didn't finish counts as this many times the slowest one that did on its game
+    const double unfinishedPenalty = 10;
+
+    // The model shipped with papg, trained with tools/trainselector.cpp on the
+    // table output of all strategies with a 1 second timeout on 76 games of
+    // 100 to 50000 vertices: gengame random and counter games, and random
+    // games with 1 to 3 successors and up to 80% self-loops.
+    const char defaultModel[] = R"(papg strategy selector 1
+split vertices 7476 1 4
+split cyclic-share 0.3051282051 2 3
+leaf 17 1.001 priority promotion plus
+leaf 45 1.013 region recovery
+split largest-scc-share 0.8479553135 5 6
+leaf 9 1.045 zielonka
+leaf 5 1.075 region recovery
+)";
+}
+
+const std::vector<std::string> StrategySelector::featureNames = {
+    "vertices",
+    "edges-per-vertex",
+    "priorities",
+    "distinct-priorities",
+    "odd-share",
+    "top-priority-share",
+    "self-loop-share",
+    "largest-scc-share",
+    "cyclic-share",
+};
+
+StrategySelector::Features StrategySelector::computeFeatures(const Arena& arena)
+{
+    const size_t numVertices = arena.getSize();
+    if (numVertices == 0) {
+        return Features(featureNames.size(), 0);
+    }
+
+    size_t numEdges = 0;
+    size_t numOdd = 0;
+    size_t numSelfLoops = 0;
+    std::vector<size_t> priorityCounts(arena.getMaxPriority() + 1, 0);
+    std::vector<bool> hasSelfLoop(numVertices, false);
+    for (const auto& vertex : arena.getVertices()) {
+        numEdges += vertex.outgoing.size();
+        numOdd += vertex.priority % 2;
+        priorityCounts[vertex.priority]++;
+        hasSelfLoop[vertex.id] = std::find(vertex.outgoing.begin(), vertex.outgoing.end(), vertex.id) != vertex.outgoing.end();
+        numSelfLoops += hasSelfLoop[vertex.id];
+    }
+    const size_t numPriorities = std::count_if(priorityCounts.begin(), priorityCounts.end(), [](size_t count) { return count > 0; });
+    const size_t topPriorityCount = *std::max_element(priorityCounts.begin(), priorityCounts.end());
+
+    SCCDecomposition sccs(arena);
+    std::vector<size_t> roots(numVertices);
+    std::iota(roots.begin(), roots.end(), 0);
+    size_t largestComponent = 0;
+    size_t numCyclic = 0;
+    sccs.forEachComponent(roots, [](size_t) { return true; }, [](size_t, size_t) { return true; }, [&](const size_t* first, const size_t* last) {
+        const size_t size = last - first;
+        largestComponent = std::max(largestComponent, size);
+        if (size > 1 || hasSelfLoop[*first]) {
+            numCyclic += size;
+        }
+    });
+
+    const double n = numVertices;
+    return Features{
+        n,
+        numEdges / n,
+        static_cast<double>(arena.getMaxPriority() + 1),
+        static_cast<double>(numPriorities),
+        numOdd / n,
+        topPriorityCount / n,
+        numSelfLoops / n,
+        largestComponent / n,
+        numCyclic / n,
+    };
+}
+
+StrategySelector StrategySelector::makeDefault()
+{
+    std::istringstream model(defaultModel);
+    return read(model);
+}
+
+StrategySelector StrategySelector::read(std::istream& model)
+{
+    std::string line;
+    if (!std::getline(model, line) || line != header) {
+        throw std::runtime_error("ERR: not a strategy selector model, it should start with \"" + header + "\".");
+    }
+
+    StrategySelector selector;
+    while (std::getline(model, line)) {
+        if (line.empty()) {
+            continue;
+        }
+
+        std::istringstream fields(line);
+        std::string kind;
+        fields >> kind;
+        Node node{ 0, 0, 0, 0, "", 0, 1 };
+        bool isValid = false;
+
+        if (kind == "split") {
+            std::string feature;
+            fields >> feature >> node.threshold >> node.below >> node.above;
+            const auto found = std::find(featureNames.begin(), featureNames.end(), feature);
+            node.feature = found - featureNames.begin();
+            // children come after their parent, so the tree has no cycles
+            isValid = fields && found != featureNames.end() && node.below > selector.nodes.size() && node.above > selector.nodes.size();
+        } else if (kind == "leaf") {
+            fields >> node.numSamples >> node.slowdown >> std::ws;
+            std::getline(fields, node.strategy);
+            isValid = !node.strategy.empty();
+        }
+
+        if (!isValid) {
+            throw std::runtime_error("ERR: invalid strategy selector model line: " + line);
+        }
+        selector.nodes.push_back(node);
+    }
+
+    if (selector.nodes.empty()) {
+        throw std::runtime_error("ERR: the strategy selector model has no nodes.");
+    }
+    for (const Node& node : selector.nodes) {
+        if (node.strategy.empty() && (node.below >= selector.nodes.size() || node.above >= selector.nodes.size())) {
+            throw std::runtime_error("ERR: the strategy selector model refers to a node it doesn't have.");
+        }
+    }
+    return selector;
+}
+
+StrategySelector StrategySelector::train(const std::vector<std::string>& candidates, const std::vector<Sample>& samples, size_t maxDepth)
+{
+    // per sample the cost of every candidate: log2 of how many times slower than the fastest it was
+    std::vector<std::vector<double> > costs;
+    std::vector<Features> features;
+    for (const Sample& sample : samples) {
+        double fastest = std::numeric_limits<double>::infinity();
+        double slowest = 0;
+        for (const double time : sample.times) {
+            if (time >= 0) {
+                fastest = std::min(fastest, time);
+                slowest = std::max(slowest, time);
+            }
+        }
+        if (fastest == std::numeric_limits<double>::infinity()) {
+            continue;
+        }
+
+        costs.emplace_back();
+        for (const double time : sample.times) {
+            const double effective = (time >= 0) ? time : unfinishedPenalty * slowest;
+            costs.back().push_back(std::log2((effective + timeSmoothing) / (fastest + timeSmoothing)));
+        }
+        features.push_back(sample.features);
+    }
+    if (costs.empty()) {
+        throw std::invalid_argument("ERR: no game to train the strategy selector on has a finished run.");
+    }
+
+    StrategySelector selector;
+    std::vector<size_t> subset(costs.size());
+    std::iota(subset.begin(), subset.end(), 0);
+    selector.grow(candidates, costs, features, subset, 0, maxDepth);
+    return selector;
+}
+
+size_t StrategySelector::grow(const std::vector<std::string>& candidates, const std::vector<std::vector<double> >& costs, const std::vector<Features>& features,
+    std::vector<size_t>& subset, size_t depth, size_t maxDepth)
+{
+    // the candidate with the least total cost on subset, and that cost
+    auto getBest = [&](const std::vector<double>& totals) {
+        const size_t best = std::min_element(totals.begin(), totals.end()) - totals.begin();
+        return std::make_pair(best, totals[best]);
+    };
+
+    std::vector<double> totals(candidates.size(), 0);
+    for (const size_t sample : subset) {
+        for (size_t candidate = 0; candidate < candidates.size(); candidate++) {
+            totals[candidate] += costs[sample][candidate];
+        }
+    }
+    const auto leaf = getBest(totals);
+
+    const size_t id = nodes.size();
+    nodes.push_back(Node{ 0, 0, 0, 0, candidates[leaf.first], subset.size(), std::exp2(leaf.second / subset.size()) });
+
+    // the split that lowers the total cost the most, if any
+    double bestCost = leaf.second - 1e-9;
+    size_t bestFeature = featureNames.size();
+    double bestThreshold = 0;
+    if (depth < maxDepth && subset.size() >= 2 * minLeafSamples) {
+        for (size_t feature = 0; feature < featureNames.size(); feature++) {
+            std::sort(subset.begin(), subset.end(), [&](size_t a, size_t b) { return features[a][feature] < features[b][feature]; });
+
+            std::vector<double> below(candidates.size(), 0);
+            std::vector<double> above = totals;
+            for (size_t i = 0; i + 1 < subset.size(); i++) {
+                for (size_t candidate = 0; candidate < candidates.size(); candidate++) {
+                    below[candidate] += costs[subset[i]][candidate];
+                    above[candidate] -= costs[subset[i]][candidate];
+                }
+
+                const double value = features[subset[i]][feature];
+                const double next = features[subset[i + 1]][feature];
+                if (value == next || i + 1 < minLeafSamples || subset.size() - i - 1 < minLeafSamples) {
+                    continue;
+                }
+                const double cost = getBest(below).second + getBest(above).second;
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestFeature = feature;
+                    bestThreshold = (value + next) / 2;
+                }
+            }
+        }
+    }
+
+    if (bestFeature == featureNames.size()) {
+        return id;
+    }
+
+    std::vector<size_t> belowSubset;
+    std::vector<size_t> aboveSubset;
+    for (const size_t sample : subset) {
+        (features[sample][bestFeature] <= bestThreshold ? belowSubset : aboveSubset).push_back(sample);
+    }
+
+    nodes[id].strategy.clear();
+    nodes[id].feature = bestFeature;
+    nodes[id].threshold = bestThreshold;
+    const size_t belowId = grow(candidates, costs, features, belowSubset, depth + 1, maxDepth);
+    const size_t aboveId = grow(candidates, costs, features, aboveSubset, depth + 1, maxDepth);
+    nodes[id].below = belowId;
+    nodes[id].above = aboveId;
+    return id;
+}
+
+void StrategySelector::write(std::ostream& model) const
+{
+    model << header << "\n";
+    for (const Node& node : nodes) {
+        if (node.strategy.empty()) {
+            model << "split " << featureNames[node.feature] << " " << std::setprecision(10) << node.threshold << " " << node.below << " " << node.above << "\n";
+        } else {
+            model << "leaf " << node.numSamples << " " << std::setprecision(4) << node.slowdown << " " << node.strategy << "\n";
+        }
+    }
+}
+
+StrategySelector::Choice StrategySelector::choose(const Features& features) const
+{
+    std::ostringstream reason;
+    size_t id = 0;
+    while (nodes[id].strategy.empty()) {
+        const Node& node = nodes[id];
+        const bool isBelow = features[node.feature] <= node.threshold;
+        reason << featureNames[node.feature] << " " << features[node.feature] << (isBelow ? " <= " : " > ") << node.threshold << ", ";
+        id = isBelow ? node.below : node.above;
+    }
+
+    const Node& leaf = nodes[id];
+    reason << "on the " << leaf.numSamples << " training games like that it took " << std::setprecision(3) << leaf.slowdown << " times the fastest time";
+    return Choice{ leaf.strategy, reason.str() };
+}
+
+std::vector<std::string> StrategySelector::getStrategies() const
+{
+    std::vector<std::string> strategies;
+    for (const Node& node : nodes) {
+        if (!node.strategy.empty() && std::find(strategies.begin(), strategies.end(), node.strategy) == strategies.end()) {
+            strategies.push_back(node.strategy);
+        }
+    }
+    return strategies;
+}
+
+} // PAPG
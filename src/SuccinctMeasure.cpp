@@ -0,0 +1,154 @@
+#include "SuccinctMeasure.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace PAPG {
+
+SuccinctMeasure::SuccinctMeasure(size_t size, size_t numOddVertices)
+    : components((size + 1) / 2, 0)
+    , size(size)
+    , budget(0)
+    , isToppedOut(false)
+{
+    while (budget < 63 && (numOddVertices >> budget)) {
+        budget++;
+    }
+
+    makeMinimalFrom(0, 0);
+}
+
+void SuccinctMeasure::makeMinimalFrom(size_t index, unsigned used)
+{
+    if (index < components.size()) {
+        // 0..0 using all of the budget that is left is least, after that nothing is left for the others
+        components[index] = makeZeroes(budget - used);
+        std::fill(components.begin() + index + 1, components.end(), makeZeroes(0));
+    }
+}
+
+bool SuccinctMeasure::operator==(const SuccinctMeasure& rhs) const
+{
+    return (this == &rhs)
+        || (this->isTop() && rhs.isTop()) // if both are top, they are considered equal
+        || (!this->isTop() && !rhs.isTop() // if not both of them are top, neither should be
+               && this->components == rhs.components
+               && this->size == rhs.size);
+}
+
+bool SuccinctMeasure::operator!=(const SuccinctMeasure& rhs) const
+{
+    return !(*this == rhs);
+}
+
+bool SuccinctMeasure::operator<(const SuccinctMeasure& rhs) const
+{
+    if (this->isTop()) {
+        return false;
+    } else if (rhs.isTop()) {
+        return true;
+    }
+
+    return std::lexicographical_compare(this->components.begin(), this->components.end(), rhs.components.begin(), rhs.components.end());
+}
+
+bool SuccinctMeasure::operator>(const SuccinctMeasure& rhs) const
+{
+    return rhs < *this;
+}
+
+bool SuccinctMeasure::partialIncrementIfAble(size_t boundary)
+{
+    if (boundary >= size) {
+        throw std::out_of_range("partialIncrementIfAble(): SuccinctMeasure boundary out of range!");
+    }
+
+    const size_t last = convertIndex(boundary);
+
+    unsigned used = 0; // budget used by the components before i, kept as i goes down
+    for (size_t i = 0; i < last; i++) {
+        used += getLength(components[i]);
+    }
+
+    for (size_t i = last + 1; i-- > 0;) {
+        const uint64_t component = components[i];
+        const unsigned room = budget - used;
+
+        if (getLength(component) < room) {
+            // s becomes s10..0, using up the rest of the budget
+            components[i] = component | makeZeroes(room);
+            makeMinimalFrom(i + 1, budget);
+            return true;
+        }
+
+        // s = u01..1 becomes u, adding the marker's lowest bit carries through the ones
+        const uint64_t next = component + (component & -component);
+        if (next != 0) {
+            components[i] = next;
+            makeMinimalFrom(i + 1, used + getLength(next));
+            return true;
+        }
+        // s is all ones, there is nothing above it, carry into the more significant component
+        if (i > 0) {
+            used -= getLength(components[i - 1]);
+        }
+    }
+
+    return false;
+}
+
+void SuccinctMeasure::makePartialEqualOf(size_t boundary, const SuccinctMeasure& other)
+{
+    if (boundary >= size || boundary >= other.size) {
+        throw std::out_of_range("makePartialEqualOf(): SuccinctMeasure boundary out of range!");
+    }
+
+    if (this == &other) {
+        return;
+    }
+
+    if (other.isTop()) {
+        makeTop();
+        return;
+    }
+
+    isToppedOut = false;
+
+    unsigned used = 0;
+    size_t i = 0;
+    for (; i < (boundary + 1) / 2; i++) {
+        components[i] = other.components[i];
+        used += getLength(components[i]);
+    }
+    makeMinimalFrom(i, used);
+}
+
+size_t SuccinctMeasure::getMemoryUsage() const
+{
+    return sizeof(SuccinctMeasure) + components.capacity() * sizeof(uint64_t);
+}
+
+std::ostream& operator<<(std::ostream& stream, const SuccinctMeasure& measure)
+{
+    stream << "(";
+
+    if (measure.isTop()) {
+        stream << "top";
+    } else {
+        for (size_t i = 0; i < measure.components.size(); i++) {
+            const unsigned length = SuccinctMeasure::getLength(measure.components[i]);
+            stream << (length ? "" : "e");
+            for (unsigned bit = 0; bit < length; bit++) {
+                stream << ((measure.components[i] >> (63 - bit)) & 1);
+            }
+            if (i + 1 < measure.components.size()) {
+                stream << ", ";
+            }
+        }
+    }
+    stream << ")";
+
+    return stream;
+}
+
+} // PAPG
@@ -0,0 +1,416 @@
+#include "TLSolver.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace PAPG {
+
+namespace {
+    const size_t noStrategy = std::numeric_limits<size_t>::max();
+
+    inline Player playerOf(size_t priority) { return (priority % 2) ? Player::odd : Player::even; }
+
+    inline size_t indexOf(Player player) { return (player == Player::even) ? 0 : 1; }
+}
+
+TLSolver::TLSolver(const Arena& arena)
+    : arena(nullptr)
+    , tangles()
+    , escapingTangles()
+    , vertexTangles()
+    , escapesInGame()
+    , unescapableInGame()
+    , escapesInSubgame()
+    , subgameStamps()
+    , unescapableInSubgame()
+    , remainingSuccessors()
+    , stamps()
+    , remainingEscapes()
+    , tangleStamps()
+    , generation(0)
+    , queue()
+    , sccs(arena)
+    , control(nullptr)
+    , numIterations(0)
+    , numAttractors(0)
+    , numDominions(0)
+{
+    reset(arena);
+}
+
+void TLSolver::reset(const Arena& newArena)
+{
+    arena = &newArena;
+    tangles.clear();
+    for (auto& escaping : escapingTangles) {
+        escaping.clear();
+    }
+    escapingTangles.resize(newArena.getSize());
+    for (auto& members : vertexTangles) {
+        members.clear();
+    }
+    vertexTangles.resize(newArena.getSize());
+    escapesInGame.clear();
+    escapesInSubgame.clear();
+    subgameStamps.clear();
+    for (size_t player = 0; player < 2; player++) {
+        unescapableInGame[player].clear();
+        unescapableInSubgame[player].clear();
+    }
+    remainingSuccessors.assign(newArena.getSize(), 0);
+    stamps.assign(newArena.getSize(), 0);
+    remainingEscapes.clear();
+    tangleStamps.clear();
+    generation = 0;
+    queue.reserve(newArena.getSize());
+    sccs.reset(newArena);
+    numIterations = 0;
+    numAttractors = 0;
+    numDominions = 0;
+}
+
+void TLSolver::attract(const VertexSet& subgame, VertexSet& region, Player player, std::vector<size_t>& strategy, std::vector<size_t>& unescapable)
+{
+    numAttractors++;
+
+    if (control != nullptr) {
+        control->check(Progress());
+    }
+
+    if (++generation == 0) {
+        // generation counter wrapped around, stale stamps could match again
+        std::fill(stamps.begin(), stamps.end(), 0);
+        std::fill(tangleStamps.begin(), tangleStamps.end(), 0);
+        generation = 1;
+    }
+
+    auto add = [&](size_t id) {
+        region.insert(id);
+        queue.push_back(id);
+    };
+
+    auto attractTangle = [&](const Tangle& tangle) {
+        for (size_t i = 0; i < tangle.vertices.size(); i++) {
+            const size_t id = tangle.vertices[i];
+            if (!region.contains(id)) {
+                if (tangle.strategy[i] != noStrategy) {
+                    strategy[id] = tangle.strategy[i];
+                }
+                add(id);
+            }
+        }
+    };
+
+    queue.clear();
+    region.forEach([this](size_t id) { queue.push_back(id); });
+
+    // tangles of player that can't be escaped from within the subgame at all
+    // are never triggered by an escape, they're attracted right away. Ones no
+    // longer in the subgame won't be again while it is used, so they're dropped.
+    size_t numKept = 0;
+    for (const size_t index : unescapable) {
+        const Tangle& tangle = tangles[index];
+        if (tangle.isAlive && std::all_of(tangle.vertices.begin(), tangle.vertices.end(), [&](size_t id) { return subgame.contains(id); })) {
+            attractTangle(tangle);
+            unescapable[numKept++] = index;
+        }
+    }
+    unescapable.resize(numKept);
+
+    while (!queue.empty()) {
+        const size_t current = queue.back();
+        queue.pop_back();
+
+        for (const size_t predecessor : (*arena)[current].incoming) {
+            if (!subgame.contains(predecessor) || region.contains(predecessor)) {
+                continue;
+            }
+
+            const Vertex& vertex = (*arena)[predecessor];
+
+            if (vertex.owner == player) {
+                strategy[predecessor] = current;
+            } else {
+                if (stamps[predecessor] != generation) {
+                    remainingSuccessors[predecessor] = std::count_if(vertex.outgoing.begin(), vertex.outgoing.end(), [&](size_t successor) {
+                        return subgame.contains(successor);
+                    });
+                    stamps[predecessor] = generation;
+                }
+
+                if (--remainingSuccessors[predecessor] > 0) {
+                    continue;
+                }
+            }
+
+            add(predecessor);
+        }
+
+        // a tangle of player is attracted once all of its escapes within the
+        // subgame are in the region, escapes out of the subgame lead to more
+        // significant regions and don't count
+        for (const size_t index : escapingTangles[current]) {
+            Tangle& tangle = tangles[index];
+            if (!tangle.isAlive || tangle.player != player) {
+                continue;
+            }
+
+            if (tangleStamps[index] != generation) {
+                tangleStamps[index] = generation;
+
+                const bool isInSubgame = std::all_of(tangle.vertices.begin(), tangle.vertices.end(), [&](size_t id) {
+                    return subgame.contains(id);
+                });
+                const bool isInRegion = std::all_of(tangle.vertices.begin(), tangle.vertices.end(), [&](size_t id) {
+                    return region.contains(id);
+                });
+
+                if (!isInSubgame || isInRegion) {
+                    remainingEscapes[index] = 0; // never attract it in this computation
+                    continue;
+                }
+
+                remainingEscapes[index] = 1 + std::count_if(tangle.escapes.begin(), tangle.escapes.end(), [&](size_t escape) {
+                    return subgame.contains(escape);
+                });
+            }
+
+            if (remainingEscapes[index] == 0 || --remainingEscapes[index] > 1) {
+                continue;
+            }
+            remainingEscapes[index] = 0;
+            attractTangle(tangle);
+        }
+    }
+}
+
+void TLSolver::leaveSubgame(size_t id)
+{
+    for (const size_t index : escapingTangles[id]) {
+        if (subgameStamps[index] != numIterations) {
+            // the subgame of this iteration started out as the game
+            subgameStamps[index] = numIterations;
+            escapesInSubgame[index] = escapesInGame[index];
+        }
+        if (--escapesInSubgame[index] == 0 && tangles[index].isAlive) {
+            unescapableInSubgame[indexOf(tangles[index].player)].push_back(index);
+        }
+    }
+}
+
+void TLSolver::leaveGame(size_t id)
+{
+    for (const size_t index : vertexTangles[id]) {
+        tangles[index].isAlive = false;
+    }
+    for (const size_t index : escapingTangles[id]) {
+        if (--escapesInGame[index] == 0 && tangles[index].isAlive) {
+            unescapableInGame[indexOf(tangles[index].player)].push_back(index);
+        }
+    }
+}
+
+size_t TLSolver::learnTangles(const VertexSet& game, const VertexSet& subgame, const VertexSet& region, Player player, const std::vector<size_t>& strategy)
+{
+    // only the part of region the opponent can't leave within the subgame can
+    // hold tangles, peel off the opponent's attractor to its escapes first
+    VertexSet closed = region;
+    queue.clear();
+    region.forEach([&](size_t id) {
+        const Vertex& vertex = (*arena)[id];
+        const bool isEscaping = (vertex.owner == player)
+            ? (strategy[id] == noStrategy || !region.contains(strategy[id]))
+            : std::any_of(vertex.outgoing.begin(), vertex.outgoing.end(), [&](size_t successor) {
+                  return subgame.contains(successor) && !region.contains(successor);
+              });
+        if (isEscaping) {
+            closed.erase(id);
+            queue.push_back(id);
+        }
+    });
+    while (!queue.empty()) {
+        const size_t current = queue.back();
+        queue.pop_back();
+
+        for (const size_t predecessor : (*arena)[current].incoming) {
+            if (closed.contains(predecessor) && ((*arena)[predecessor].owner != player || strategy[predecessor] == current)) {
+                closed.erase(predecessor);
+                queue.push_back(predecessor);
+            }
+        }
+    }
+
+    // player's vertices follow strategy, the opponent's can go anywhere. The
+    // tangles are the nontrivial bottom SCCs of what is left.
+    auto isMember = [&](size_t id) { return closed.contains(id); };
+    auto followEdge = [&](size_t from, size_t to) {
+        return (*arena)[from].owner != player || strategy[from] == to;
+    };
+
+    std::vector<size_t> roots;
+    closed.forEach([&](size_t id) { roots.push_back(id); });
+
+    VertexSet component(arena->getSize());
+    size_t dominion = noStrategy;
+
+    for (auto& members : sccs.decompose(roots, isMember, followEdge)) {
+        if (!sccs.isNontrivial(members, followEdge)) {
+            continue;
+        }
+
+        component.clear();
+        for (const size_t id : members) {
+            component.insert(id);
+        }
+
+        const bool isBottom = std::all_of(members.begin(), members.end(), [&](size_t id) {
+            return std::all_of((*arena)[id].outgoing.begin(), (*arena)[id].outgoing.end(), [&](size_t successor) {
+                return component.contains(successor) || !closed.contains(successor) || !followEdge(id, successor);
+            });
+        });
+        if (!isBottom) {
+            continue;
+        }
+
+        Tangle tangle{ player, members, std::vector<size_t>(), std::vector<size_t>(), true };
+        VertexSet escapes(arena->getSize());
+        for (const size_t id : members) {
+            if ((*arena)[id].owner == player) {
+                tangle.strategy.push_back(strategy[id]);
+                continue;
+            }
+
+            tangle.strategy.push_back(noStrategy);
+            for (const size_t successor : (*arena)[id].outgoing) {
+                if (game.contains(successor) && !component.contains(successor)) {
+                    escapes.insert(successor);
+                }
+            }
+        }
+        escapes.forEach([&](size_t id) {
+            tangle.escapes.push_back(id);
+            escapingTangles[id].push_back(tangles.size());
+        });
+        for (const size_t id : members) {
+            vertexTangles[id].push_back(tangles.size());
+        }
+
+        if (tangle.escapes.empty()) {
+            if (dominion == noStrategy) {
+                dominion = tangles.size();
+            }
+            unescapableInGame[indexOf(player)].push_back(tangles.size());
+        }
+
+        escapesInGame.push_back(tangle.escapes.size());
+        escapesInSubgame.push_back(0);
+        subgameStamps.push_back(0);
+        tangles.push_back(std::move(tangle));
+        remainingEscapes.push_back(0);
+        tangleStamps.push_back(0);
+    }
+
+    return dominion == noStrategy ? tangles.size() : dominion;
+}
+
+size_t TLSolver::findDominion()
+{
+    for (auto& unescapable : unescapableInGame) {
+        while (!unescapable.empty()) {
+            if (tangles[unescapable.back()].isAlive) {
+                return unescapable.back();
+            }
+            unescapable.pop_back();
+        }
+    }
+    return tangles.size();
+}
+
+size_t TLSolver::searchDominion(const VertexSet& game, std::vector<size_t>& strategy)
+{
+    while (true) {
+        numIterations++;
+        const size_t numKnownTangles = tangles.size();
+        for (size_t player = 0; player < 2; player++) {
+            unescapableInSubgame[player] = unescapableInGame[player];
+        }
+
+        VertexSet subgame = game;
+        while (!subgame.empty()) {
+            size_t priority = std::numeric_limits<size_t>::max();
+            subgame.forEach([&](size_t id) {
+                priority = std::min(priority, (*arena)[id].priority);
+            });
+            const Player player = playerOf(priority);
+
+            VertexSet region(arena->getSize());
+            subgame.forEach([&](size_t id) {
+                if ((*arena)[id].priority == priority) {
+                    region.insert(id);
+                    strategy[id] = noStrategy;
+                }
+            });
+
+            attract(subgame, region, player, strategy, unescapableInSubgame[indexOf(player)]);
+
+            // the vertices region started from need to stay in it as well
+            region.forEach([&](size_t id) {
+                if ((*arena)[id].owner == player && (*arena)[id].priority == priority) {
+                    for (const size_t successor : (*arena)[id].outgoing) {
+                        if (region.contains(successor)) {
+                            strategy[id] = successor;
+                            break;
+                        }
+                    }
+                }
+            });
+
+            const size_t dominion = learnTangles(game, subgame, region, player, strategy);
+            if (dominion != tangles.size()) {
+                return dominion;
+            }
+
+            subgame -= region;
+            region.forEach([this](size_t id) { leaveSubgame(id); });
+        }
+
+        if (tangles.size() == numKnownTangles) {
+            throw std::logic_error("searchDominion(): no new tangles learned!");
+        }
+    }
+}
+
+std::vector<Player> TLSolver::solve()
+{
+    std::vector<Player> result(arena->getSize(), Player::even);
+    std::vector<size_t> strategy(arena->getSize(), noStrategy);
+    VertexSet game(arena->getSize(), true);
+
+    while (!game.empty()) {
+        // removing a dominion can take away the last escapes of a tangle
+        size_t index = findDominion();
+        if (index == tangles.size()) {
+            index = searchDominion(game, strategy);
+        }
+        numDominions++;
+
+        const Player winner = tangles[index].player;
+        VertexSet dominion(arena->getSize());
+        for (const size_t id : tangles[index].vertices) {
+            dominion.insert(id);
+        }
+        attract(game, dominion, winner, strategy, unescapableInGame[indexOf(winner)]);
+
+        dominion.forEach([&](size_t id) {
+            result[id] = winner;
+            leaveGame(id);
+        });
+        game -= dominion;
+    }
+
+    return result;
+}
+
+} // PAPG
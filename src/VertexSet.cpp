@@ -0,0 +1,140 @@
+#include "VertexSet.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace PAPG {
+
+VertexSet::VertexSet(size_t size, bool filled)
+    : words((size + bitsPerWord - 1) / bitsPerWord, filled ? ~uint64_t(0) : 0)
+    , size(size)
+{
+    clearPadding();
+}
+
+void VertexSet::clearPadding()
+{
+    // bits beyond size in the last word must stay zero, count() and empty() rely on it
+    if (size % bitsPerWord) {
+        words.back() &= bitMask(size) - 1;
+    }
+}
+
+size_t VertexSet::count() const
+{
+    size_t result = 0;
+    for (const uint64_t word : words) {
+        result += __builtin_popcountll(word);
+    }
+    return result;
+}
+
+bool VertexSet::empty() const
+{
+    for (const uint64_t word : words) {
+        if (word) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t VertexSet::findNext(size_t from) const
+{
+    if (from >= size) {
+        return size;
+    }
+    size_t w = wordIndex(from);
+    uint64_t word = words[w] & (~uint64_t(0) << (from % bitsPerWord));
+    while (!word) {
+        if (++w == words.size()) {
+            return size;
+        }
+        word = words[w];
+    }
+    return w * bitsPerWord + __builtin_ctzll(word); // the padding is zero, so this is below size
+}
+
+void VertexSet::clear()
+{
+    std::fill(words.begin(), words.end(), 0);
+}
+
+void VertexSet::fill()
+{
+    std::fill(words.begin(), words.end(), ~uint64_t(0));
+    clearPadding();
+}
+
+void VertexSet::assign(size_t newSize, bool filled)
+{
+    size = newSize;
+    words.assign((size + bitsPerWord - 1) / bitsPerWord, filled ? ~uint64_t(0) : 0);
+    clearPadding();
+}
+
+VertexSet& VertexSet::operator|=(const VertexSet& rhs)
+{
+    if (size != rhs.size)
+        throw std::invalid_argument("operator|=(): VertexSet sizes differ!");
+
+    for (size_t w = 0; w < words.size(); w++) {
+        words[w] |= rhs.words[w];
+    }
+    return *this;
+}
+
+VertexSet& VertexSet::operator&=(const VertexSet& rhs)
+{
+    if (size != rhs.size)
+        throw std::invalid_argument("operator&=(): VertexSet sizes differ!");
+
+    for (size_t w = 0; w < words.size(); w++) {
+        words[w] &= rhs.words[w];
+    }
+    return *this;
+}
+
+VertexSet& VertexSet::operator-=(const VertexSet& rhs)
+{
+    if (size != rhs.size)
+        throw std::invalid_argument("operator-=(): VertexSet sizes differ!");
+
+    for (size_t w = 0; w < words.size(); w++) {
+        words[w] &= ~rhs.words[w];
+    }
+    return *this;
+}
+
+VertexSet VertexSet::operator|(const VertexSet& rhs) const
+{
+    VertexSet result(*this);
+    result |= rhs;
+    return result;
+}
+
+VertexSet VertexSet::operator&(const VertexSet& rhs) const
+{
+    VertexSet result(*this);
+    result &= rhs;
+    return result;
+}
+
+VertexSet VertexSet::operator-(const VertexSet& rhs) const
+{
+    VertexSet result(*this);
+    result -= rhs;
+    return result;
+}
+
+bool VertexSet::operator==(const VertexSet& rhs) const
+{
+    return size == rhs.size && words == rhs.words;
+}
+
+bool VertexSet::operator!=(const VertexSet& rhs) const
+{
+    return !(*this == rhs);
+}
+
+} // PAPG
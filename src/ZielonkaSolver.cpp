@@ -0,0 +1,216 @@
+#include "ZielonkaSolver.hpp"
+
+#include <algorithm>
+#include <future>
+#include <limits>
+#include <thread>
+
+namespace PAPG {
+
+ZielonkaSolver::ZielonkaSolver(const Arena& arena)
+    : arena(&arena)
+    , attractor(arena)
+    , maxThreads(std::max(1u, std::thread::hardware_concurrency()))
+    , parallelThreshold(4096)
+    , control(nullptr)
+    , numRecursiveCalls(0)
+    , numAttractors(0)
+    , numParallelCalls(0)
+    , maxRecursionDepth(0)
+    , numActiveThreads(1)
+{
+}
+
+void ZielonkaSolver::reset(const Arena& newArena)
+{
+    arena = &newArena;
+    attractor.reset(newArena);
+    numRecursiveCalls = 0;
+    numAttractors = 0;
+    numParallelCalls = 0;
+    maxRecursionDepth = 0;
+    numActiveThreads = 1; // an interrupted solve can leave it off
+}
+
+void ZielonkaSolver::updateMaxRecursionDepth(unsigned depth)
+{
+    unsigned current = maxRecursionDepth;
+    while (depth > current && !maxRecursionDepth.compare_exchange_weak(current, depth)) {
+    }
+}
+
+std::vector<VertexSet> ZielonkaSolver::splitComponents(const VertexSet& subgame) const
+{
+    std::vector<VertexSet> components;
+
+    if (maxThreads < 2 || subgame.count() < 2 * parallelThreshold) {
+        // can't have two components that are large enough to be worth it
+        return components;
+    }
+
+    VertexSet visited(arena->getSize());
+    VertexSet smallComponents(arena->getSize());
+    std::vector<size_t> stack;
+    std::vector<size_t> members;
+
+    subgame.forEach([&](size_t root) {
+        if (visited.contains(root)) {
+            return;
+        }
+
+        // plain DFS over edges in both directions, restricted to the subgame
+        members.clear();
+        stack.push_back(root);
+        visited.insert(root);
+        while (!stack.empty()) {
+            const size_t current = stack.back();
+            stack.pop_back();
+            members.push_back(current);
+
+            for (const auto* neighbours : { &(*arena)[current].outgoing, &(*arena)[current].incoming }) {
+                for (const size_t neighbour : *neighbours) {
+                    if (subgame.contains(neighbour) && !visited.contains(neighbour)) {
+                        visited.insert(neighbour);
+                        stack.push_back(neighbour);
+                    }
+                }
+            }
+        }
+
+        if (members.size() >= parallelThreshold) {
+            components.emplace_back(arena->getSize());
+            for (const size_t id : members) {
+                components.back().insert(id);
+            }
+        } else {
+            for (const size_t id : members) {
+                smallComponents.insert(id);
+            }
+        }
+    });
+
+    if (!smallComponents.empty()) {
+        components.push_back(smallComponents);
+    }
+
+    if (components.size() < 2) {
+        components.clear(); // subgame is connected, nothing to gain
+    }
+
+    return components;
+}
+
+VertexSet ZielonkaSolver::solveComponents(const std::vector<VertexSet>& components, Attractor& attractor, unsigned depth)
+{
+    VertexSet wonByOdd(arena->getSize());
+    std::vector<std::future<VertexSet> > futures;
+
+    for (const auto& component : components) {
+        // only hand off to another thread if there's one to spare, otherwise solve it here
+        unsigned active = numActiveThreads;
+        bool acquired = false;
+        while (active < maxThreads && !acquired) {
+            acquired = numActiveThreads.compare_exchange_weak(active, active + 1);
+        }
+
+        if (acquired) {
+            numParallelCalls++;
+            futures.push_back(std::async(std::launch::async, [this, &component, depth]() {
+                Attractor threadAttractor(*arena);
+                VertexSet result = solveSubgame(component, threadAttractor, depth);
+                numActiveThreads--;
+                return result;
+            }));
+        } else {
+            wonByOdd |= solveSubgame(component, attractor, depth);
+        }
+    }
+
+    for (auto& future : futures) {
+        wonByOdd |= future.get();
+    }
+
+    return wonByOdd;
+}
+
+VertexSet ZielonkaSolver::solveSubgame(const VertexSet& subgame, Attractor& attractor, unsigned depth)
+{
+    numRecursiveCalls++;
+    updateMaxRecursionDepth(depth);
+
+    if (control != nullptr) {
+        Progress progress;
+        progress.recursionDepth = depth;
+        control->check(progress);
+    }
+
+    const std::vector<VertexSet> components = splitComponents(subgame);
+    if (!components.empty()) {
+        return solveComponents(components, attractor, depth);
+    }
+
+    VertexSet wonByOdd(arena->getSize());
+    VertexSet current(subgame);
+
+    // The second recursive call of the algorithm is a tail call, it is done by
+    // iterating on the remaining subgame instead, so the recursion depth is
+    // bounded by the number of priorities rather than the number of vertices.
+    while (!current.empty()) {
+        size_t minPriority = std::numeric_limits<size_t>::max();
+        current.forEach([&](size_t id) {
+            minPriority = std::min(minPriority, (*arena)[id].priority);
+        });
+
+        const Player player = (minPriority % 2) ? Player::odd : Player::even;
+        const Player opponent = (player == Player::even) ? Player::odd : Player::even;
+
+        VertexSet region(arena->getSize());
+        current.forEach([&](size_t id) {
+            if ((*arena)[id].priority == minPriority) {
+                region.insert(id);
+            }
+        });
+        attractor.attract(current, region, player);
+        numAttractors++;
+
+        const VertexSet rest = current - region;
+        const VertexSet restWonByOdd = solveSubgame(rest, attractor, depth + 1);
+        VertexSet restWonByOpponent = (opponent == Player::odd) ? restWonByOdd : rest - restWonByOdd;
+
+        if (restWonByOpponent.empty()) {
+            // player wins everything that is left
+            if (player == Player::odd) {
+                wonByOdd |= current;
+            }
+            break;
+        }
+
+        attractor.attract(current, restWonByOpponent, opponent);
+        numAttractors++;
+
+        if (opponent == Player::odd) {
+            wonByOdd |= restWonByOpponent;
+        }
+        current -= restWonByOpponent;
+    }
+
+    return wonByOdd;
+}
+
+std::vector<Player> ZielonkaSolver::solve()
+{
+    attractor.setMaxThreads(maxThreads);
+
+    const VertexSet wonByOdd = solveSubgame(VertexSet(arena->getSize(), true), attractor, 0);
+
+    std::vector<Player> result;
+    result.reserve(arena->getSize());
+
+    for (size_t id = 0; id < arena->getSize(); id++) {
+        result.emplace_back(wonByOdd.contains(id) ? Player::odd : Player::even);
+    }
+
+    return result;
+}
+
+} // PAPG
@@ -1,13 +1,304 @@
 #include "main.hpp"
 #include "Arena.hpp"
-#include "Measure.hpp"
+#include "Checkpoint.hpp"
+#include "LiftTrace.hpp"
+#include "MappedArena.hpp"
 #include "Parser.hpp"
+#include "PerfCounters.hpp"
+#include "Preprocessor.hpp"
+#include "Reducer.hpp"
 #include "SPMSolver.hpp"
-
+#include "Server.hpp"
+#include "ShardedSolver.hpp"
+#include "SolutionCache.hpp"
+#include "SolveControl.hpp"
+#include "Strategies.hpp"
+#include "StrategySelector.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <csignal>
 #include <chrono>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
 #include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+using PAPG::Counters;
+using PAPG::Strategy;
+
+struct StrategyRun {
+    std::vector<PAPG::Player> results; // empty if interrupted
+    unsigned long long time;
+    Counters counters;
+    std::string interruption; // why the run was stopped early, empty if it finished
+};
+
+struct PreprocessingRun {
+    size_t removedVertices;
+    unsigned long long time;
+    Counters counters; // only the hardware counters, if any
+};
+
+// whether the strategies solve the reduced game (see inc/Reducer.hpp), and
+// with compared also the unreduced one to tell the time saved
+enum class Reduction {
+    off,
+    on,
+    compared
+};
+
+struct ReductionRun {
+    size_t vertices; // of the game given to the reducer
+    size_t reducedVertices;
+    unsigned long long time;
+};
+
+// the control of the running solves, for the signal handlers
+PAPG::SolveControl* signalControl = nullptr;
+
+// with --perf, the hardware counters counted around every solve and preprocessing
+PAPG::PerfCounters* perfCounters = nullptr;
+
+// with --cache, where solutions are looked up before and stored after solving
+PAPG::SolutionCache* solutionCache = nullptr;
+
+// with -s auto in human mode, the strategy the last auto run chose and why (empty if it was
+// answered from the cache), printed with its results
+std::string autoChoice;
+
+// the solvers of the strategies, kept from one solve to the next so their tables keep their
+// storage, and what they share per game (started on every game parsed)
+PAPG::Workspace workspace;
+
+// SIGUSR1 dumps the stats of the running solve, SIGINT does the same and
+// cancels everything that is left, as does SIGTERM when checkpointing
+void handleSignal(int signal)
+{
+    signalControl->requestReport();
+    if (signal == SIGINT || signal == SIGTERM) {
+        signalControl->cancel();
+        std::signal(signal, SIG_DFL); // a second one ends the program right away
+    }
+}
+
+// the server of papg serve, for the signal handlers
+PAPG::Server* signalServer = nullptr;
+
+// SIGINT and SIGTERM stop a listening server
+void handleServerSignal(int)
+{
+    signalServer->stop();
+}
+
+void printProgress(const std::string& name, const PAPG::Progress& progress)
+{
+    std::cerr << "# " << name << ": " << progress.seconds << "s"
+              << ", lifts: " << progress.lifts
+              << " (" << static_cast<unsigned long long>(progress.seconds > 0 ? progress.lifts / progress.seconds : 0) << "/s)"
+              << ", vertices at top: " << progress.verticesAtTop
+              << ", recursion depth: " << progress.recursionDepth << std::endl;
+}
+
+// Runs strategy on the residual arena of preprocessor if given, or on arena
+// itself if not, reduced by reducer if that is given too, giving the results
+// for all of arena either way. Runs that control stops early get no results,
+// only the reason in interruption. With a solution cache, a hit skips solving
+// and its time is that of the lookup.
+StrategyRun runStrategy(const Strategy& strategy, const PAPG::Arena& arena, const PAPG::Preprocessor* preprocessor, const PAPG::Reducer* reducer,
+    PAPG::SolveControl& control)
+{
+    StrategyRun run;
+    run.time = 0;
+
+    if (control.isCancelled()) {
+        run.interruption = PAPG::toString(PAPG::SolveControl::Reason::cancelled);
+        return run;
+    }
+
+    const PAPG::Arena& residual = (preprocessor != nullptr) ? preprocessor->getResidualArena() : arena;
+    const PAPG::Arena& game = (reducer != nullptr) ? reducer->getReducedArena() : residual;
+    std::vector<PAPG::Player> results;
+
+    // the winners of all of arena from those of game
+    auto expand = [&](const std::vector<PAPG::Player>& gameResults) {
+        const std::vector<PAPG::Player> unreduced = (reducer != nullptr) ? reducer->expandResults(gameResults) : gameResults;
+        return (preprocessor != nullptr) ? preprocessor->mergeResults(unreduced) : unreduced;
+    };
+
+    // nothing left to solve if preprocessing decided the whole game
+    if (game.getSize() > 0) {
+        PAPG::SolutionCache::Key key{ 0, 0 };
+        PAPG::SolutionCache::Entry entry;
+        if (solutionCache != nullptr) {
+            auto begin = std::chrono::steady_clock::now();
+            key = PAPG::SolutionCache::makeKey(game, strategy.name);
+            const bool isHit = solutionCache->load(key, game.getSize(), entry);
+            auto end = std::chrono::steady_clock::now();
+
+            run.counters.emplace_back("cache hits", isHit);
+            if (isHit) {
+                run.time = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+                run.results = expand(entry.winners);
+                return run;
+            }
+        }
+
+        PAPG::Checkpointer* checkpointer = control.getCheckpointer();
+        if (checkpointer != nullptr && !checkpointer->begin(PAPG::SolutionCache::makeKey(game, ""), strategy.name)) {
+            std::cerr << "# the checkpoint is of another game, " << strategy.name << " starts from scratch" << std::endl;
+        }
+
+        control.setProgressCallback([&strategy](const PAPG::Progress& progress) { printProgress(strategy.name, progress); });
+        control.start();
+
+        PAPG_TRACE_RUN(strategy.name);
+        if (perfCounters != nullptr) {
+            perfCounters->start();
+        }
+        auto begin = std::chrono::steady_clock::now();
+        try {
+            results = strategy.solve(game, workspace, control, run.counters, nullptr);
+        } catch (const PAPG::SolveInterrupted& interrupted) {
+            run.interruption = PAPG::toString(interrupted.getReason());
+        }
+        auto end = std::chrono::steady_clock::now();
+        if (perfCounters != nullptr) {
+            perfCounters->stop(run.counters);
+        }
+
+        run.time = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+
+        if (checkpointer != nullptr && checkpointer->getResumedLifts() > 0) {
+            run.counters.emplace_back("lifts before resume", checkpointer->getResumedLifts());
+        }
+
+        if (solutionCache != nullptr && run.interruption.empty()) {
+            entry.winners = results;
+            solutionCache->store(key, entry);
+        }
+    }
+
+    if (run.interruption.empty()) {
+        run.results = expand(results);
+    }
+
+    return run;
+}
+
+// Runs the preprocessing pipeline on arena, with the time it took in µS.
+PreprocessingRun preprocess(PAPG::Preprocessor& preprocessor)
+{
+    PreprocessingRun run;
+
+    if (perfCounters != nullptr) {
+        perfCounters->start();
+    }
+    auto begin = std::chrono::steady_clock::now();
+    preprocessor.run();
+    auto end = std::chrono::steady_clock::now();
+    if (perfCounters != nullptr) {
+        perfCounters->stop(run.counters);
+    }
+
+    run.removedVertices = preprocessor.getRemovedCount();
+    run.time = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+    return run;
+}
+
+// Runs the reduction of the game preprocessing left (or the full game), with
+// the time it took in µS.
+ReductionRun reduce(PAPG::Reducer& reducer)
+{
+    auto begin = std::chrono::steady_clock::now();
+    reducer.run();
+    auto end = std::chrono::steady_clock::now();
+
+    const size_t reducedVertices = reducer.getReducedArena().getSize();
+    return ReductionRun{ reducedVertices + reducer.getRemovedCount(), reducedVertices,
+        static_cast<unsigned long long>(std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count()) };
+}
+
+// For --compare-reduction, runs strategy on the unreduced game as well and
+// adds its time to run as the unreduced time counter. Both must find the same
+// winners.
+void addUnreducedRun(StrategyRun& run, const Strategy& strategy, const PAPG::Arena& arena, const PAPG::Preprocessor* preprocessor, PAPG::SolveControl& control)
+{
+    if (!run.interruption.empty()) {
+        return;
+    }
+
+    const StrategyRun unreduced = runStrategy(strategy, arena, preprocessor, nullptr, control);
+    if (!unreduced.interruption.empty()) {
+        return;
+    }
+    if (unreduced.results != run.results) {
+        throw std::logic_error("ERR: " + strategy.name + " finds other winners on the reduced game than on the unreduced one.");
+    }
+    run.counters.emplace_back("unreduced time (µS)", unreduced.time);
+}
+
+// returns the value of the named counter as a string, or "-" if the run doesn't
+// report it. Interrupted runs have the reason instead of any counter.
+std::string getCounter(const StrategyRun& run, const std::string& name)
+{
+    if (!run.interruption.empty()) {
+        return run.interruption;
+    }
+
+    for (auto& counter : run.counters) {
+        if (counter.first == name) {
+            return std::to_string(counter.second);
+        }
+    }
+    return "-";
+}
+
+// all counter names reported by the given runs, in order of first appearance
+std::vector<std::string> getCounterNames(const std::vector<StrategyRun>& runs)
+{
+    std::vector<std::string> names;
+    for (auto& run : runs) {
+        for (auto& counter : run.counters) {
+            if (std::find(names.begin(), names.end(), counter.first) == names.end()) {
+                names.push_back(counter.first);
+            }
+        }
+    }
+    return names;
+}
+
+// the vertices of the reduced game per vertex of the game given to the reducer
+std::string getReductionRatio(const ReductionRun& reduction)
+{
+    std::ostringstream ratio;
+    ratio << std::setprecision(3) << (reduction.vertices > 0 ? static_cast<double>(reduction.reducedVertices) / reduction.vertices : 1.0);
+    return ratio.str();
+}
 
-void printResults(PAPG::Arena& arena, std::vector<PAPG::Player> results)
+// the unreduced time of run minus the time of the reduction and of run
+// itself, or why there is none
+std::string getTimeSaved(const StrategyRun& run, const ReductionRun& reduction)
+{
+    const std::string unreduced = getCounter(run, "unreduced time (µS)");
+    if (!run.interruption.empty() || unreduced == "-") {
+        return unreduced;
+    }
+    return std::to_string(static_cast<long long>(std::stoull(unreduced)) - static_cast<long long>(reduction.time + run.time));
+}
+
+void printResults(const PAPG::Arena& arena, std::vector<PAPG::Player> results)
 {
     std::cout << "results:{ ";
     for (size_t i = 0; i < results.size(); i++) {
@@ -21,9 +312,12 @@ void printResults(PAPG::Arena& arena, std::vector<PAPG::Player> results)
     std::cout << "}" << std::endl;
 }
 
-void processGame(char path[])
+void processGame(const char path[], const std::vector<Strategy>& strategies, bool isPreprocessing, Reduction reduction, PAPG::SolveControl& control)
 {
     PAPG::Arena arena = PAPG::Parser::parse(path);
+    workspace.startGame();
+    PAPG::Preprocessor preprocessor(arena);
+    PAPG::Reducer reducer(isPreprocessing ? preprocessor.getResidualArena() : arena);
 
     for (size_t i = 0; i < arena.getSize(); i++) {
         std::cout << "id:" << arena[i].id << " owner:" << (arena[i].owner == PAPG::Player::odd) << " priority:" << arena[i].priority << " successors:{ ";
@@ -38,332 +332,1093 @@ void processGame(char path[])
         }
     }
 
-    std::chrono::steady_clock::time_point begin;
-    std::chrono::steady_clock::time_point end;
+    if (isPreprocessing) {
+        const PreprocessingRun run = preprocess(preprocessor);
+        std::cout << "# preprocessing removed vertices: " << run.removedVertices << std::endl;
+        std::cout << "# preprocessing self-loop dominions: " << preprocessor.getDominionCount() << std::endl;
+        std::cout << "# preprocessing time (µS): " << run.time << std::endl;
+        for (auto& counter : run.counters) {
+            std::cout << "# preprocessing " << counter.first << ": " << counter.second << std::endl;
+        }
+    }
 
-    PAPG::SPMSolver solver(arena);
+    const bool isReducing = reduction != Reduction::off;
+    ReductionRun reductionRun{ 0, 0, 0 };
+    if (isReducing) {
+        reductionRun = reduce(reducer);
+        std::cout << "# reduction removed vertices: " << reducer.getRemovedCount() << std::endl;
+        std::cout << "# reduction ratio: " << getReductionRatio(reductionRun) << std::endl;
+        std::cout << "# reduction chain vertices: " << reducer.getChainVertexCount() << std::endl;
+        std::cout << "# reduction refinement rounds: " << reducer.getRoundCount() << (reducer.isQuotient() ? "" : " (not stable, only chains collapsed)") << std::endl;
+        std::cout << "# reduction time (µS): " << reductionRun.time << std::endl;
+    }
 
-    std::vector<PAPG::Player> results;
+    std::vector<StrategyRun> runs;
 
-    // Input order
-    std::cout << "input order " << std::flush;
-    begin = std::chrono::steady_clock::now();
-    results = solver.solveInputOrder();
-    end = std::chrono::steady_clock::now();
+    for (auto& strategy : strategies) {
+        std::cout << strategy.name << " " << std::flush;
+        autoChoice.clear();
+        runs.push_back(runStrategy(strategy, arena, isPreprocessing ? &preprocessor : nullptr, isReducing ? &reducer : nullptr, control));
+        if (reduction == Reduction::compared) {
+            addUnreducedRun(runs.back(), strategy, arena, isPreprocessing ? &preprocessor : nullptr, control);
+        }
 
-    auto inputOrderNonReturningTime = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
-    auto inputOrderNonReturningLifts = solver.getLiftCount();
+        if (!runs.back().interruption.empty()) {
+            std::cout << "interrupted: " << runs.back().interruption << std::endl;
+            continue;
+        }
+        printResults(arena, runs.back().results);
 
-    printResults(arena, results);
-    solver.resetLiftCount();
+        for (auto& counter : runs.back().counters) {
+            if (counter.first != "lifts") {
+                std::cout << "# " << strategy.name << " " << counter.first << ": " << counter.second << std::endl;
+            }
+        }
+        if (!autoChoice.empty()) {
+            std::cout << "# auto: " << autoChoice << std::endl;
+        }
+        if (reduction == Reduction::compared) {
+            std::cout << "# " << strategy.name << " time saved by reduction (µS): " << getTimeSaved(runs.back(), reductionRun) << std::endl;
+        }
+    }
 
-    // Random order
-    std::cout << "random order " << std::flush;
-    begin = std::chrono::steady_clock::now();
-    results = solver.solveRandomOrder();
-    end = std::chrono::steady_clock::now();
+    std::cout << "# ";
+    for (size_t i = 0; i < strategies.size(); i++) {
+        std::cout << (i ? " / " : "") << strategies[i].name;
+    }
+    std::cout << "\n";
 
-    auto randomOrderTime = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
-    auto randomOrderLifts = solver.getLiftCount();
+    std::cout << "# lifts:\t";
+    for (size_t i = 0; i < runs.size(); i++) {
+        std::cout << (i ? " / " : "") << getCounter(runs[i], "lifts");
+    }
+    std::cout << std::endl;
+
+    std::cout << "# time (µS):\t";
+    for (size_t i = 0; i < runs.size(); i++) {
+        std::cout << (i ? " / " : "") << runs[i].time;
+    }
+    std::cout << std::endl;
+
+    std::cout << "# total vertices: " << arena.getSize() << std::endl;
+}
+
+// prints one ';'-delimited table with a row per game and a column per strategy
+void printTable(const std::string& title, const std::vector<std::string>& paths, const std::vector<Strategy>& strategies, std::function<std::string(size_t, size_t)> getCell)
+{
+    const std::string delim = ";";
 
-    printResults(arena, results);
-    solver.resetLiftCount();
+    std::cout << title << ":" << std::endl;
+    std::cout << "path";
+    for (auto& strategy : strategies) {
+        std::cout << delim << strategy.name;
+    }
+    std::cout << std::endl;
+
+    for (size_t game = 0; game < paths.size(); game++) {
+        std::cout << paths[game];
+        for (size_t strategy = 0; strategy < strategies.size(); strategy++) {
+            std::cout << delim << getCell(game, strategy);
+        }
+        std::cout << std::endl;
+    }
+}
 
-    // Priority order
-    std::cout << "priority order " << std::flush;
-    begin = std::chrono::steady_clock::now();
-    results = solver.solvePriorityOrder();
-    end = std::chrono::steady_clock::now();
+std::string getOutcome(const StrategyRun& run)
+{
+    if (!run.interruption.empty()) {
+        return run.interruption;
+    }
+    return std::to_string(run.results[0] == PAPG::Player::odd);
+}
 
-    auto priorityOrderNonReturningTime = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
-    auto priorityOrderNonReturningLifts = solver.getLiftCount();
+void printPreprocessingTable(const std::vector<std::string>& paths, const std::vector<PreprocessingRun>& preprocessing)
+{
+    const std::string delim = ";";
+
+    std::vector<std::string> counterNames;
+    for (auto& run : preprocessing) {
+        for (auto& counter : run.counters) {
+            if (std::find(counterNames.begin(), counterNames.end(), counter.first) == counterNames.end()) {
+                counterNames.push_back(counter.first);
+            }
+        }
+    }
 
-    printResults(arena, results);
-    solver.resetLiftCount();
+    std::cout << "Preprocessing:" << std::endl;
+    std::cout << "path" << delim << "removed vertices" << delim << "time (µS)";
+    for (auto& name : counterNames) {
+        std::cout << delim << name;
+    }
+    std::cout << std::endl;
 
-    // Incoming order
-    std::cout << "incoming order " << std::flush;
-    begin = std::chrono::steady_clock::now();
-    results = solver.solveIncomingOrder();
-    end = std::chrono::steady_clock::now();
+    for (size_t game = 0; game < paths.size(); game++) {
+        std::cout << paths[game] << delim << preprocessing[game].removedVertices << delim << preprocessing[game].time;
+        for (auto& name : counterNames) {
+            auto counter = std::find_if(preprocessing[game].counters.begin(), preprocessing[game].counters.end(),
+                [&](const std::pair<std::string, unsigned long long>& counter) { return counter.first == name; });
+            std::cout << delim << ((counter != preprocessing[game].counters.end()) ? std::to_string(counter->second) : "-");
+        }
+        std::cout << std::endl;
+    }
+}
 
-    auto incomingOrderNonReturningTime = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
-    auto incomingOrderNonReturningLifts = solver.getLiftCount();
+// the Reduction table and with --compare-reduction the time saved by it per
+// strategy, of the last run of each
+void printReductionTables(const std::vector<std::string>& paths, const std::vector<Strategy>& strategies, Reduction reduction,
+    const std::vector<std::vector<std::vector<StrategyRun> > >& runs, const std::vector<ReductionRun>& reductions)
+{
+    if (reduction == Reduction::off) {
+        return;
+    }
 
-    printResults(arena, results);
-    solver.resetLiftCount();
+    const std::string delim = ";";
+    std::cout << "Reduction:" << std::endl;
+    std::cout << "path" << delim << "vertices" << delim << "reduced vertices" << delim << "ratio" << delim << "time (µS)" << std::endl;
+    for (size_t game = 0; game < paths.size(); game++) {
+        const ReductionRun& run = reductions[game];
+        std::cout << paths[game] << delim << run.vertices << delim << run.reducedVertices << delim << getReductionRatio(run) << delim << run.time << std::endl;
+    }
 
-    // Recursive
-    std::cout << "recursive " << std::flush;
-    begin = std::chrono::steady_clock::now();
-    results = solver.solveRecursive();
-    end = std::chrono::steady_clock::now();
+    if (reduction == Reduction::compared) {
+        printTable("Time saved by reduction (µS)", paths, strategies, [&](size_t game, size_t strategy) {
+            return getTimeSaved(runs[game][strategy].back(), reductions[game]);
+        });
+    }
+}
 
-    auto recursiveTime = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
-    auto recursiveLifts = solver.getLiftCount();
+// Runs every strategy repetitions times on every game (after warmups
+// unmeasured runs) and collects the runs per game, per strategy. A run that is
+// interrupted ends the repetitions of its strategy on that game.
+std::vector<std::vector<std::vector<StrategyRun> > > runAll(const std::vector<std::string>& paths, const std::vector<Strategy>& strategies, bool isPreprocessing, Reduction reduction,
+    unsigned warmups, unsigned repetitions, PAPG::SolveControl& control, std::vector<PreprocessingRun>& preprocessing, std::vector<ReductionRun>& reductions)
+{
+    std::vector<std::vector<std::vector<StrategyRun> > > runs;
+
+    for (auto& path : paths) {
+        runs.emplace_back(strategies.size());
+
+        if (control.isCancelled()) {
+            // don't bother parsing the rest, their runs are all cancelled
+            for (auto& strategyRuns : runs.back()) {
+                strategyRuns.push_back(StrategyRun{ {}, 0, {}, PAPG::toString(PAPG::SolveControl::Reason::cancelled) });
+            }
+            preprocessing.push_back(PreprocessingRun{ 0, 0, {} });
+            reductions.push_back(ReductionRun{ 0, 0, 0 });
+            continue;
+        }
 
-    printResults(arena, results);
-    std::cout << "# Recursive strategy max recursion depth: " << solver.getMaxRecursionDepth() << std::endl;
+        std::cerr << "Testing " << path << "..." << std::flush;
 
-    solver.resetMaxRecursionDepth();
-    solver.resetLiftCount();
+        PAPG::Arena arena = PAPG::Parser::parse(path);
+        workspace.startGame();
+        PAPG::Preprocessor preprocessor(arena);
+        PAPG::Reducer reducer(isPreprocessing ? preprocessor.getResidualArena() : arena);
+        const bool isReducing = reduction != Reduction::off;
 
-    // Recursive priority order
-    std::cout << "recursive priority order " << std::flush;
-    begin = std::chrono::steady_clock::now();
-    results = solver.solveRecursivePriorityOrder();
-    end = std::chrono::steady_clock::now();
+        if (isPreprocessing) {
+            preprocessing.push_back(preprocess(preprocessor));
+        }
+        if (isReducing) {
+            reductions.push_back(reduce(reducer));
+        }
 
-    auto recursivePriorityOrderTime = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
-    auto recursivePriorityOrderLifts = solver.getLiftCount();
+        for (size_t strategy = 0; strategy < strategies.size(); strategy++) {
+            auto& strategyRuns = runs.back()[strategy];
+
+            for (unsigned i = 0; i < warmups + repetitions; i++) {
+                StrategyRun run = runStrategy(strategies[strategy], arena, isPreprocessing ? &preprocessor : nullptr, isReducing ? &reducer : nullptr, control);
+                if (reduction == Reduction::compared) {
+                    addUnreducedRun(run, strategies[strategy], arena, isPreprocessing ? &preprocessor : nullptr, control);
+                }
+                const bool isInterrupted = !run.interruption.empty();
+
+                if (i >= warmups || isInterrupted) {
+                    strategyRuns.push_back(run);
+                }
+                if (isInterrupted) {
+                    break;
+                }
+            }
+        }
 
-    printResults(arena, results);
-    std::cout << "# Recurisve priority order strategy max recursion depth: " << solver.getMaxRecursionDepth() << std::endl;
+        std::cerr << "DONE" << std::endl;
+    }
 
-    solver.resetMaxRecursionDepth();
-    solver.resetLiftCount();
+    std::cout << std::endl;
 
-    // Recursive incoming order
-    std::cout << "recursive incoming order " << std::flush;
-    begin = std::chrono::steady_clock::now();
-    results = solver.solveRecursiveIncomingOrder();
-    end = std::chrono::steady_clock::now();
+    return runs;
+}
 
-    auto recursiveIncomingOrderTime = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
-    auto recursiveIncomingOrderLifts = solver.getLiftCount();
+// all counter names reported by the given runs, in order of first appearance
+std::vector<std::string> getCounterNames(const std::vector<std::vector<std::vector<StrategyRun> > >& runs)
+{
+    std::vector<StrategyRun> allRuns;
+    for (auto& gameRuns : runs) {
+        for (auto& strategyRuns : gameRuns) {
+            allRuns.push_back(strategyRuns.front());
+        }
+    }
+    return getCounterNames(allRuns);
+}
 
-    printResults(arena, results);
-    std::cout << "# Recursive incoming order max recursion depth: " << solver.getMaxRecursionDepth() << std::endl;
+void generateResultsTable(const std::vector<std::string>& paths, const std::vector<Strategy>& strategies, bool isPreprocessing, Reduction reduction, PAPG::SolveControl& control)
+{
+    std::vector<PreprocessingRun> preprocessing; // per game
+    std::vector<ReductionRun> reductions; // per game
+    const auto runs = runAll(paths, strategies, isPreprocessing, reduction, 0, 1, control, preprocessing, reductions);
 
-    solver.resetMaxRecursionDepth();
-    solver.resetLiftCount();
+    for (auto& counterName : getCounterNames(runs)) {
+        std::string title = counterName;
+        title[0] = std::toupper(title[0]);
 
-    // Propagation
-    std::cout << "propagation " << std::flush;
-    begin = std::chrono::steady_clock::now();
-    results = solver.solvePropagation();
-    end = std::chrono::steady_clock::now();
+        printTable(title, paths, strategies, [&](size_t game, size_t strategy) {
+            return getCounter(runs[game][strategy].front(), counterName);
+        });
+    }
 
-    auto propagationTime = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
-    auto propagationLifts = solver.getLiftCount();
+    printTable("Time (µS)", paths, strategies, [&](size_t game, size_t strategy) {
+        const StrategyRun& run = runs[game][strategy].front();
+        return run.interruption.empty() ? std::to_string(run.time) : run.interruption;
+    });
 
-    printResults(arena, results);
-    std::cout << "# Propagation max recursion depth: " << solver.getMaxRecursionDepth() << std::endl;
+    printTable("Outcome V0", paths, strategies, [&](size_t game, size_t strategy) {
+        return getOutcome(runs[game][strategy].front());
+    });
 
-    solver.resetMaxRecursionDepth();
-    solver.resetLiftCount();
+    if (isPreprocessing) {
+        printPreprocessingTable(paths, preprocessing);
+    }
+    printReductionTables(paths, strategies, reduction, runs, reductions);
+}
 
-    // Propagation recursive hybrid
-    std::cout << "propagation recursive hybrid " << std::flush;
-    begin = std::chrono::steady_clock::now();
-    results = solver.solvePropagationRecursiveHybrid();
-    end = std::chrono::steady_clock::now();
+struct TimeStatistics {
+    unsigned long long min;
+    unsigned long long median;
+    unsigned long long p95;
+    double variance;
+};
 
-    auto propagationRecursiveHybridTime = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
-    auto propagationRecursiveHybridLifts = solver.getLiftCount();
+// statistics of the times of the given runs, which must not be empty
+TimeStatistics getTimeStatistics(const std::vector<StrategyRun>& runs)
+{
+    std::vector<unsigned long long> times;
+    for (auto& run : runs) {
+        times.push_back(run.time);
+    }
+    std::sort(times.begin(), times.end());
 
-    printResults(arena, results);
-    std::cout << "# Propagation recursive hybrid max recursion depth: " << solver.getMaxRecursionDepth() << std::endl;
+    double mean = 0;
+    for (auto time : times) {
+        mean += time;
+    }
+    mean /= times.size();
 
-    solver.resetMaxRecursionDepth();
-    solver.resetLiftCount();
+    double variance = 0;
+    for (auto time : times) {
+        variance += (time - mean) * (time - mean);
+    }
+    variance /= times.size();
 
-    std::cout << "# input order / random order / priority order / incoming order / recursive / recursive priority order / recursive incoming order / propagation / propagation recursive hybrid\n";
-    std::cout << "# lifts:\t" << inputOrderNonReturningLifts << " / " << randomOrderLifts << " / " << priorityOrderNonReturningLifts << " / " << incomingOrderNonReturningLifts << " / " << recursiveLifts << " / " << recursivePriorityOrderLifts << " / " << recursiveIncomingOrderLifts << " / " << propagationLifts << " / " << propagationRecursiveHybridLifts << std::endl;
-    std::cout << "# time (µS):\t" << inputOrderNonReturningTime << " / " << randomOrderTime << " / " << priorityOrderNonReturningTime << " / " << incomingOrderNonReturningTime << " / " << recursiveTime << " / " << recursivePriorityOrderTime << " / " << recursiveIncomingOrderTime << " / " << propagationTime << " / " << propagationRecursiveHybridTime << std::endl;
+    // p95 by nearest rank
+    const size_t p95Rank = (times.size() * 95 + 99) / 100;
 
-    std::cout << "# total vertices: " << arena.getSize() << std::endl;
+    return TimeStatistics{ times.front(), times[(times.size() - 1) / 2], times[p95Rank - 1], variance };
 }
 
-void generateResultsTable(int argc, char* argv[])
+void generateBenchmarkTable(const std::vector<std::string>& paths, const std::vector<Strategy>& strategies, bool isPreprocessing, Reduction reduction, unsigned warmups, unsigned repetitions,
+    PAPG::SolveControl& control)
 {
-    std::vector<std::string> paths;
-    std::vector<std::vector<unsigned long long> > times;
-    std::vector<std::vector<unsigned long long> > lifts;
-    std::vector<std::vector<std::vector<PAPG::Player> > > results;
+    std::vector<PreprocessingRun> preprocessing; // per game
+    std::vector<ReductionRun> reductions; // per game
+    const auto runs = runAll(paths, strategies, isPreprocessing, reduction, warmups, repetitions, control, preprocessing, reductions);
+
+    // statistics are only given for strategies that finished every repetition
+    auto getStatistic = [&](size_t game, size_t strategy, std::function<std::string(const TimeStatistics&)> get) {
+        const std::vector<StrategyRun>& strategyRuns = runs[game][strategy];
+        if (!strategyRuns.back().interruption.empty()) {
+            return strategyRuns.back().interruption;
+        }
+        return get(getTimeStatistics(strategyRuns));
+    };
 
-    for (int i = 1; i < argc; i++) {
-        const std::string path = argv[i];
+    std::cout << "Benchmark: " << warmups << " warm-up runs, " << repetitions << " measured runs" << std::endl;
 
-        std::cerr << "Testing " << path << "..." << std::flush;
+    for (auto& counterName : getCounterNames(runs)) {
+        std::string title = counterName;
+        title[0] = std::toupper(title[0]);
 
-        PAPG::Arena arena = PAPG::Parser::parse(path);
-        PAPG::SPMSolver solver(arena);
+        printTable(title, paths, strategies, [&](size_t game, size_t strategy) {
+            return getCounter(runs[game][strategy].back(), counterName);
+        });
+    }
 
-        std::vector<unsigned long long> localTimes;
-        std::vector<unsigned long long> localLifts;
-        std::vector<std::vector<PAPG::Player> > localResults;
+    printTable("Time min (µS)", paths, strategies, [&](size_t game, size_t strategy) {
+        return getStatistic(game, strategy, [](const TimeStatistics& statistics) { return std::to_string(statistics.min); });
+    });
+    printTable("Time median (µS)", paths, strategies, [&](size_t game, size_t strategy) {
+        return getStatistic(game, strategy, [](const TimeStatistics& statistics) { return std::to_string(statistics.median); });
+    });
+    printTable("Time p95 (µS)", paths, strategies, [&](size_t game, size_t strategy) {
+        return getStatistic(game, strategy, [](const TimeStatistics& statistics) { return std::to_string(statistics.p95); });
+    });
+    printTable("Time variance (µS²)", paths, strategies, [&](size_t game, size_t strategy) {
+        return getStatistic(game, strategy, [](const TimeStatistics& statistics) { return std::to_string(statistics.variance); });
+    });
+
+    printTable("Outcome V0", paths, strategies, [&](size_t game, size_t strategy) {
+        return getOutcome(runs[game][strategy].back());
+    });
+
+    if (isPreprocessing) {
+        printPreprocessingTable(paths, preprocessing);
+    }
+    printReductionTables(paths, strategies, reduction, runs, reductions);
+}
 
-        {
-            // Input
-            auto begin = std::chrono::steady_clock::now();
-            auto result = solver.solveInputOrder();
-            auto end = std::chrono::steady_clock::now();
+// splits a comma-separated list
+std::vector<std::string> splitList(const std::string& list)
+{
+    std::vector<std::string> items;
+    size_t begin = 0;
+    while (begin <= list.size()) {
+        const size_t end = std::min(list.find(',', begin), list.size());
+        if (end > begin) {
+            items.push_back(list.substr(begin, end - begin));
+        }
+        begin = end + 1;
+    }
+    return items;
+}
 
-            localTimes.push_back(std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count());
-            localLifts.push_back(solver.getLiftCount());
-            localResults.push_back(result);
-            solver.resetLiftCount();
+// Selects the strategies that are named or that belong to a named engine
+// ("all" names every engine), in the order of all. Without any names all
+// strategies are selected. Returns false if a name matches nothing.
+bool selectStrategies(const std::vector<Strategy>& all, const std::vector<std::string>& engines, const std::vector<std::string>& names, std::vector<Strategy>& selected)
+{
+    for (auto& engine : engines) {
+        if (engine != "all" && std::none_of(all.begin(), all.end(), [&](const Strategy& strategy) { return strategy.engine == engine; })) {
+            std::cerr << "Unknown engine: " << engine << std::endl;
+            return false;
+        }
+    }
+    for (auto& name : names) {
+        if (std::none_of(all.begin(), all.end(), [&](const Strategy& strategy) { return strategy.name == name; })) {
+            std::cerr << "Unknown strategy: " << name << std::endl;
+            return false;
         }
+    }
 
-        {
-            // Random
-            auto begin = std::chrono::steady_clock::now();
-            auto result = solver.solveRandomOrder();
-            auto end = std::chrono::steady_clock::now();
+    const bool isAll = (engines.empty() && names.empty()) || std::find(engines.begin(), engines.end(), "all") != engines.end();
 
-            localTimes.push_back(std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count());
-            localLifts.push_back(solver.getLiftCount());
-            localResults.push_back(result);
-            solver.resetLiftCount();
+    for (auto& strategy : all) {
+        if (isAll
+            || std::find(engines.begin(), engines.end(), strategy.engine) != engines.end()
+            || std::find(names.begin(), names.end(), strategy.name) != names.end()) {
+            selected.push_back(strategy);
         }
+    }
+    return true;
+}
 
-        {
-            // Priority
-            auto begin = std::chrono::steady_clock::now();
-            auto result = solver.solvePriorityOrder();
-            auto end = std::chrono::steady_clock::now();
+void printStrategies(const std::vector<Strategy>& strategies)
+{
+    for (auto& strategy : strategies) {
+        std::cout << strategy.engine << "\t" << strategy.name << std::endl;
+    }
+}
+
+void printUsage()
+{
+    std::cout << "Usage: papg [options] <PGSolver min parity game>+" << std::endl;
+    std::cout << "   or: papg serve [options], see papg serve --help" << std::endl;
+    std::cout << "   or: papg mapped [options] <PGSolver min parity game>, see papg mapped --help" << std::endl;
+    std::cout << "   or: papg sharded [options] <PGSolver min parity game>, see papg sharded --help" << std::endl;
+    std::cout << "\te.g. papg testcases/1.gm" << std::endl;
+    std::cout << "\tWith one game, runs all strategies on it and outputs basic results and measurements in a (somewhat) human-readable format." << std::endl;
+    std::cout << "\te.g. papg testcases/1.gm testcases/2.gm testcases/3.gm" << std::endl;
+    std::cout << "\tWith more games, runs all strategies on them and outputs results and measurements in ';'-delimited tables." << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "\t-e, --engine <engines>\tRun the strategies of the given engines (comma-separated, can be repeated): all, spm, succinct, interned, zielonka, pp, si, tl." << std::endl;
+    std::cout << "\t-s, --strategy <names>\tRun the given strategies (comma-separated, can be repeated), see --list. Without -e and -s all strategies run." << std::endl;
+    std::cout << "\t\t\t\tThe strategy auto runs the one a decision tree over features of each game picks, and tells which and why." << std::endl;
+    std::cout << "\t--model <path>\t\tThe decision tree of auto, as tools/trainselector.cpp trains it from the table or bench output (default: the built-in one)." << std::endl;
+    std::cout << "\t-l, --list\t\tList the strategies with their engines and exit." << std::endl;
+    std::cout << "\t-h, --help\t\tShow this help and exit." << std::endl;
+    std::cout << "\t-o, --output <mode>\tOutput mode: human (default for one game), table (default for more games) or bench." << std::endl;
+    std::cout << "\t-w, --warmup <runs>\tIn bench mode, the unmeasured runs per strategy and game before measuring (default 1)." << std::endl;
+    std::cout << "\t-r, --repeat <runs>\tIn bench mode, the measured runs per strategy and game (default 5), reported as min, median, p95 and variance." << std::endl;
+    std::cout << "\t--no-preprocess\t\tRun the strategies on the full game, without removing self-loop dominions and their attractors first." << std::endl;
+    std::cout << "\t--reduce\t\tRun the strategies on the game reduced by collapsing chains and merging bisimilar vertices, reporting the reduction." << std::endl;
+    std::cout << "\t--compare-reduction\tThe same, and run every strategy on the unreduced game too, reporting the time the reduction saved." << std::endl;
+    std::cout << "\t-t, --timeout <seconds>\tStop a strategy that runs longer than this on a game, its results are marked as timeout." << std::endl;
+    std::cout << "\t--lift-budget <lifts>\tStop a lifting strategy after this many lifts, its results are marked as lift budget." << std::endl;
+    std::cout << "\t--progress <seconds>\tReport the progress of the running strategy on stderr at this interval." << std::endl;
+    std::cout << "\t--checkpoint <path>\tWrite the measures of the running small progress measures strategy to path regularly, and when it is interrupted." << std::endl;
+    std::cout << "\t--checkpoint-interval <seconds>\tThe time between checkpoints (default 60)." << std::endl;
+    std::cout << "\t--resume\t\tStart the first small progress measures strategy on the game of the checkpoint from the measures in it." << std::endl;
+    std::cout << "\t--perf\t\t\tCount cycles, instructions, cache misses, branch misses and page faults of every strategy and the preprocessing, as far as perf_event_open() gives them." << std::endl;
+    std::cout << "\t--cache <directory>\tLook up the solution of every game and strategy in directory before solving, and store it there after." << std::endl;
+    std::cout << "\t--cache-size <MB>\tRemove the least recently used solutions when the cache grows past this size (default 1024)." << std::endl;
+    std::cout << "\t--trace <path>\t\tRecord every lift of the lifting strategies to path, see tools/tracereport.cpp. Needs papg built with make TRACE=1." << std::endl;
+    std::cout << "Sending SIGUSR1 reports the progress of the running strategy once, SIGINT does the same and cancels what is left (a second one stops right away)." << std::endl;
+}
+
+void printServeUsage()
+{
+    std::cout << "Usage: papg serve [options]" << std::endl;
+    std::cout << "\tAnswers solve requests on stdin (on stdout), or on a Unix domain socket with --socket. See inc/Server.hpp for the protocol." << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "\t--socket <path>\t\tListen on a Unix domain socket at path instead of reading stdin." << std::endl;
+    std::cout << "\t--threads <number>\tThe number of connections handled at once on the socket (default: one per hardware thread)." << std::endl;
+    std::cout << "\t--no-preprocess\t\tSolve the full games, without removing self-loop dominions and their attractors first." << std::endl;
+    std::cout << "\t-t, --timeout <seconds>\tStop a solve that runs longer than this, it is answered with an error." << std::endl;
+    std::cout << "\t--lift-budget <lifts>\tStop a lifting strategy after this many lifts, it is answered with an error." << std::endl;
+    std::cout << "\t--max-request <MB>\tRefuse requests with a longer arena than this (default 1024), closing the connection." << std::endl;
+}
+
+// papg serve, argv[0] being "serve"
+int serve(int argc, char* argv[])
+{
+    PAPG::Server::Options options;
+    std::string socketPath;
 
-            localTimes.push_back(std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count());
-            localLifts.push_back(solver.getLiftCount());
-            localResults.push_back(result);
-            solver.resetLiftCount();
+    for (int i = 1; i < argc; i++) {
+        const std::string option = argv[i];
+        const bool hasValue = (i + 1 < argc);
+        double number = 0;
+
+        try {
+            if (option == "--socket" && hasValue) {
+                socketPath = argv[++i];
+            } else if (option == "--threads" && hasValue && (number = std::stod(argv[++i])) >= 1) {
+                options.numThreads = static_cast<unsigned>(number);
+            } else if (option == "--no-preprocess") {
+                options.isPreprocessing = false;
+            } else if ((option == "-t" || option == "--timeout") && hasValue && (number = std::stod(argv[++i])) > 0) {
+                options.timeLimit = number;
+            } else if (option == "--lift-budget" && hasValue && (number = std::stod(argv[++i])) >= 1) {
+                options.liftBudget = static_cast<unsigned long long>(number);
+            } else if (option == "--max-request" && hasValue && (number = std::stod(argv[++i])) > 0) {
+                options.maxRequestSize = static_cast<size_t>(number * 1024 * 1024);
+            } else if (option == "-h" || option == "--help") {
+                printServeUsage();
+                return 0;
+            } else {
+                printServeUsage();
+                return 1;
+            }
+        } catch (const std::exception&) {
+            printServeUsage();
+            return 1;
         }
+    }
 
-        {
-            // Incoming
-            auto begin = std::chrono::steady_clock::now();
-            auto result = solver.solveIncomingOrder();
-            auto end = std::chrono::steady_clock::now();
+    std::signal(SIGPIPE, SIG_IGN); // a client that goes away only ends its connection
+
+    PAPG::Server server(options);
+    if (socketPath.empty()) {
+        // answers go to the original stdout, anything else printed is moved
+        // to stderr to keep the framing intact
+        const int output = ::dup(STDOUT_FILENO);
+        ::dup2(STDERR_FILENO, STDOUT_FILENO);
+        server.serve(STDIN_FILENO, output);
+        ::close(output);
+        return 0;
+    }
+
+    signalServer = &server;
+    std::signal(SIGINT, handleServerSignal);
+    std::signal(SIGTERM, handleServerSignal);
+    try {
+        server.listen(socketPath);
+    } catch (const std::exception& exception) {
+        std::cerr << exception.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
 
-            localTimes.push_back(std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count());
-            localLifts.push_back(solver.getLiftCount());
-            localResults.push_back(result);
-            solver.resetLiftCount();
+void printMappedUsage()
+{
+    std::cout << "Usage: papg mapped [options] <PGSolver min parity game>" << std::endl;
+    std::cout << "\tSolves a game too large for memory with small progress measures, keeping the arena and the measures in memory-mapped" << std::endl;
+    std::cout << "\tfiles and lifting a block of vertices at a time. Reports page faults and I/O of the solve." << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "\t--dir <directory>\tWhere the files are made (default: TMPDIR, or /tmp), they are removed once papg is done." << std::endl;
+    std::cout << "\t--arena <path>\t\tKeep the arena file at path. Without a game, solve the arena file at path made earlier." << std::endl;
+    std::cout << "\t--block <vertices>\tThe number of vertices lifted at a time (default 65536)." << std::endl;
+    std::cout << "\t-t, --timeout <seconds>\tStop the solve after this time." << std::endl;
+    std::cout << "\t--lift-budget <lifts>\tStop the solve after this many lifts." << std::endl;
+    std::cout << "\t--progress <seconds>\tReport the progress of the solve on stderr at this interval." << std::endl;
+}
+
+// papg mapped, argv[0] being "mapped"
+int solveMapped(int argc, char* argv[])
+{
+    std::string directory = PAPG::MappedFile::getTemporaryDirectory();
+    std::string arenaPath;
+    std::string gamePath;
+    size_t blockSize = 65536;
+    PAPG::SolveControl control;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string option = argv[i];
+        const bool hasValue = (i + 1 < argc);
+        double number = 0;
+
+        try {
+            if (option == "--dir" && hasValue) {
+                directory = argv[++i];
+            } else if (option == "--arena" && hasValue) {
+                arenaPath = argv[++i];
+            } else if (option == "--block" && hasValue && (number = std::stod(argv[++i])) >= 1) {
+                blockSize = static_cast<size_t>(number);
+            } else if ((option == "-t" || option == "--timeout") && hasValue && (number = std::stod(argv[++i])) > 0) {
+                control.setTimeLimit(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(number)));
+            } else if (option == "--lift-budget" && hasValue && (number = std::stod(argv[++i])) >= 1) {
+                control.setLiftBudget(static_cast<unsigned long long>(number));
+            } else if (option == "--progress" && hasValue && (number = std::stod(argv[++i])) > 0) {
+                control.setProgressInterval(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(number)));
+            } else if (option == "-h" || option == "--help") {
+                printMappedUsage();
+                return 0;
+            } else if (gamePath.empty() && option[0] != '-') {
+                gamePath = option;
+            } else {
+                printMappedUsage();
+                return 1;
+            }
+        } catch (const std::exception&) {
+            printMappedUsage();
+            return 1;
         }
+    }
 
-        {
-            // Recursive
-            auto begin = std::chrono::steady_clock::now();
-            auto result = solver.solveRecursive();
-            auto end = std::chrono::steady_clock::now();
+    if (gamePath.empty() && arenaPath.empty()) {
+        printMappedUsage();
+        return 1;
+    }
 
-            localTimes.push_back(std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count());
-            localLifts.push_back(solver.getLiftCount());
-            localResults.push_back(result);
-            solver.resetLiftCount();
+    // page faults and blocks of I/O (512 bytes each) of the whole process so far
+    auto getUsage = []() {
+        rusage usage;
+        ::getrusage(RUSAGE_SELF, &usage);
+        return usage;
+    };
+
+    try {
+        auto begin = std::chrono::steady_clock::now();
+        PAPG::MappedArena arena = gamePath.empty() ? PAPG::MappedArena::open(arenaPath)
+            : arenaPath.empty()                    ? PAPG::MappedArena::buildTemporary(gamePath, directory)
+                                                   : PAPG::MappedArena::build(gamePath, arenaPath);
+        auto end = std::chrono::steady_clock::now();
+        std::cout << "# arena time (µS): " << std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count() << std::endl;
+        std::cout << "# arena bytes: " << arena.getFileSize() << std::endl;
+
+        PAPG::MappedSPMSolver solver(arena);
+        solver.setControl(&control);
+        solver.getMeasureStore().setDirectory(directory);
+        control.setProgressCallback([](const PAPG::Progress& progress) { printProgress("block order", progress); });
+        signalControl = &control;
+        std::signal(SIGUSR1, handleSignal);
+        std::signal(SIGINT, handleSignal);
+        control.start();
+
+        const rusage before = getUsage();
+        begin = std::chrono::steady_clock::now();
+        std::vector<PAPG::Player> results;
+        std::string interruption;
+        try {
+            results = solver.solveBlockOrder(blockSize);
+        } catch (const PAPG::SolveInterrupted& interrupted) {
+            interruption = PAPG::toString(interrupted.getReason());
+        }
+        end = std::chrono::steady_clock::now();
+        const rusage after = getUsage();
+
+        std::cout << "block order ";
+        if (!interruption.empty()) {
+            std::cout << "interrupted: " << interruption << std::endl;
+        } else {
+            std::cout << "results:{ ";
+            for (size_t i = 0; i < results.size() && i < 16; i++) {
+                std::cout << i << ":" << (results[i] == PAPG::Player::odd) << " ";
+            }
+            std::cout << (results.size() > 16 ? "... }" : "}") << std::endl;
         }
 
-        {
-            // Recursive Priority Order
-            auto begin = std::chrono::steady_clock::now();
-            auto result = solver.solveRecursivePriorityOrder();
-            auto end = std::chrono::steady_clock::now();
+        std::cout << "# block order rescans avoided: " << solver.getRescansAvoidedCount() << std::endl;
+        std::cout << "# block order max recursion depth: " << solver.getMaxRecursionDepth() << std::endl;
+        std::cout << "# block order measure bytes: " << solver.getMeasureStore().getMemoryUsage() << std::endl;
+        std::cout << "# block order major page faults: " << after.ru_majflt - before.ru_majflt << std::endl;
+        std::cout << "# block order minor page faults: " << after.ru_minflt - before.ru_minflt << std::endl;
+        std::cout << "# block order bytes read: " << (after.ru_inblock - before.ru_inblock) * 512ull << std::endl;
+        std::cout << "# block order bytes written: " << (after.ru_oublock - before.ru_oublock) * 512ull << std::endl;
+        std::cout << "# lifts:\t" << solver.getLiftCount() << std::endl;
+        std::cout << "# time (µS):\t" << std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count() << std::endl;
+        std::cout << "# total vertices: " << arena.getSize() << std::endl;
+    } catch (const std::exception& exception) {
+        std::cerr << exception.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+void printShardedUsage()
+{
+    std::cout << "Usage: papg sharded [options] <PGSolver min parity game>" << std::endl;
+    std::cout << "\tSolves a game with small progress measures split over worker processes that share the measures in POSIX shared memory," << std::endl;
+    std::cout << "\tonce per number of workers, and reports how it scales against the single-process worklist strategy." << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "\t--workers <counts>\tThe numbers of workers to solve with (comma-separated, default 1, 2, 4 and so on up to the hardware threads)." << std::endl;
+    std::cout << "\t--no-preprocess\t\tSolve the full game, without removing self-loop dominions and their attractors first." << std::endl;
+    std::cout << "\t-t, --timeout <seconds>\tStop every solve after this time." << std::endl;
+    std::cout << "\t--lift-budget <lifts>\tStop every solve after this many lifts (of all workers together)." << std::endl;
+}
 
-            localTimes.push_back(std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count());
-            localLifts.push_back(solver.getLiftCount());
-            localResults.push_back(result);
-            solver.resetLiftCount();
+// papg sharded, argv[0] being "sharded"
+int solveSharded(int argc, char* argv[])
+{
+    std::vector<unsigned> workerCounts;
+    bool isPreprocessing = true;
+    std::string gamePath;
+    PAPG::SolveControl control;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string option = argv[i];
+        const bool hasValue = (i + 1 < argc);
+        double number = 0;
+
+        try {
+            if (option == "--workers" && hasValue) {
+                for (auto& count : splitList(argv[++i])) {
+                    if ((number = std::stod(count)) < 1 || number > 64) {
+                        throw std::invalid_argument("no worker count");
+                    }
+                    workerCounts.push_back(static_cast<unsigned>(number));
+                }
+            } else if (option == "--no-preprocess") {
+                isPreprocessing = false;
+            } else if ((option == "-t" || option == "--timeout") && hasValue && (number = std::stod(argv[++i])) > 0) {
+                control.setTimeLimit(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(number)));
+            } else if (option == "--lift-budget" && hasValue && (number = std::stod(argv[++i])) >= 1) {
+                control.setLiftBudget(static_cast<unsigned long long>(number));
+            } else if (option == "-h" || option == "--help") {
+                printShardedUsage();
+                return 0;
+            } else if (gamePath.empty() && option[0] != '-') {
+                gamePath = option;
+            } else {
+                printShardedUsage();
+                return 1;
+            }
+        } catch (const std::exception&) {
+            printShardedUsage();
+            return 1;
+        }
+    }
+
+    if (gamePath.empty()) {
+        printShardedUsage();
+        return 1;
+    }
+    if (workerCounts.empty()) {
+        const unsigned numThreads = std::max(2u, std::thread::hardware_concurrency());
+        for (unsigned count = 1; count <= numThreads; count *= 2) {
+            workerCounts.push_back(count);
         }
+    }
+
+    signalControl = &control;
+    std::signal(SIGINT, handleSignal);
 
-        {
-            // Recursive Incoming Order
+    try {
+        const PAPG::Arena arena = PAPG::Parser::parse(gamePath.c_str());
+        PAPG::Preprocessor preprocessor(arena);
+        if (isPreprocessing) {
+            const PreprocessingRun run = preprocess(preprocessor);
+            std::cout << "# preprocessing removed vertices: " << run.removedVertices << std::endl;
+            std::cout << "# preprocessing time (µS): " << run.time << std::endl;
+        }
+        const PAPG::Arena& game = isPreprocessing ? preprocessor.getResidualArena() : arena;
+
+        struct ScalingRun {
+            unsigned workers; // 0 for the single-process strategy
+            std::vector<PAPG::Player> results; // of game, empty if interrupted
+            unsigned long long time;
+            unsigned long long lifts;
+            unsigned long long idsSent;
+            std::string interruption;
+        };
+        std::vector<ScalingRun> runs;
+
+        // runs solve (giving the results of game) under control, timed
+        auto run = [&](unsigned workers, std::function<std::vector<PAPG::Player>()> solve) {
+            ScalingRun scaling{ workers, {}, 0, 0, 0, "" };
+            control.start();
             auto begin = std::chrono::steady_clock::now();
-            auto result = solver.solveRecursiveIncomingOrder();
+            try {
+                scaling.results = solve();
+            } catch (const PAPG::SolveInterrupted& interrupted) {
+                scaling.interruption = PAPG::toString(interrupted.getReason());
+            }
             auto end = std::chrono::steady_clock::now();
+            scaling.time = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+            return scaling;
+        };
+
+        PAPG::SPMSolver single(game);
+        single.setControl(&control);
+        runs.push_back(run(0, [&]() { return single.solveWorklist(); }));
+        runs.back().lifts = single.getLiftCount();
+
+        for (const unsigned workers : workerCounts) {
+            PAPG::ShardedSolver sharded(game, workers);
+            runs.push_back(run(workers, [&]() { return sharded.solve(&control); }));
+            for (size_t worker = 0; worker < sharded.getWorkerStats().size(); worker++) {
+                const PAPG::ShardedSolver::WorkerStats& stats = sharded.getWorkerStats()[worker];
+                runs.back().lifts += stats.lifts;
+                runs.back().idsSent += stats.idsSent;
+                std::cout << "# sharded " << workers << " worker " << worker << ": vertices " << stats.vertices << ", lifts " << stats.lifts
+                          << ", ids sent " << stats.idsSent << ", ids received " << stats.idsReceived << std::endl;
+            }
+        }
 
-            localTimes.push_back(std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count());
-            localLifts.push_back(solver.getLiftCount());
-            localResults.push_back(result);
-            solver.resetLiftCount();
+        for (auto& scaling : runs) {
+            std::cout << (scaling.workers == 0 ? std::string("worklist") : "sharded " + std::to_string(scaling.workers)) << " ";
+            if (!scaling.interruption.empty()) {
+                std::cout << "interrupted: " << scaling.interruption << std::endl;
+                continue;
+            }
+            printResults(arena, isPreprocessing ? preprocessor.mergeResults(scaling.results) : scaling.results);
         }
 
-        {
-            // propagation
-            auto begin = std::chrono::steady_clock::now();
-            auto result = solver.solvePropagation();
-            auto end = std::chrono::steady_clock::now();
+        // every run that finished must agree with the first one that did
+        const auto reference = std::find_if(runs.begin(), runs.end(), [](const ScalingRun& scaling) { return scaling.interruption.empty(); });
+        const std::string delim = ";";
+        std::cout << "Scaling:" << std::endl;
+        std::cout << "workers" << delim << "time (µS)" << delim << "speedup" << delim << "lifts" << delim << "ids sent" << std::endl;
+        for (auto& scaling : runs) {
+            std::cout << (scaling.workers == 0 ? std::string("single process") : std::to_string(scaling.workers)) << delim;
+            if (!scaling.interruption.empty()) {
+                std::cout << scaling.interruption << std::endl;
+                continue;
+            }
+            if (scaling.results != reference->results) {
+                throw std::logic_error("ERR: the sharded solver with " + std::to_string(scaling.workers) + " workers finds other winners than the single-process solver.");
+            }
+            std::cout << scaling.time << delim;
+            if (runs.front().interruption.empty()) {
+                std::cout << std::setprecision(3) << static_cast<double>(runs.front().time) / std::max(1ull, scaling.time);
+            } else {
+                std::cout << "-";
+            }
+            std::cout << delim << scaling.lifts << delim << (scaling.workers == 0 ? std::string("-") : std::to_string(scaling.idsSent)) << std::endl;
+        }
+        std::cout << "# total vertices: " << arena.getSize() << std::endl;
+    } catch (const std::exception& exception) {
+        std::cerr << exception.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+enum class OutputMode {
+    automatic, // human for one game, table for more
+    human,
+    table,
+    bench
+};
 
-            localTimes.push_back(std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count());
-            localLifts.push_back(solver.getLiftCount());
-            localResults.push_back(result);
-            solver.resetLiftCount();
+int main(int argc, char* argv[])
+{
+    if (argc > 1 && std::strcmp(argv[1], "serve") == 0) {
+        return serve(argc - 1, argv + 1);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "mapped") == 0) {
+        return solveMapped(argc - 1, argv + 1);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "sharded") == 0) {
+        return solveSharded(argc - 1, argv + 1);
+    }
+
+    std::vector<std::string> engines;
+    std::vector<std::string> names;
+    OutputMode mode = OutputMode::automatic;
+    bool isListing = false;
+    bool isPreprocessing = true;
+    Reduction reduction = Reduction::off;
+    unsigned warmups = 1;
+    unsigned repetitions = 5;
+    std::vector<std::string> paths;
+    std::string tracePath;
+    std::string modelPath;
+    bool isCounting = false;
+    std::string cacheDirectory;
+    std::string checkpointPath;
+    double checkpointInterval = 60; // seconds
+    bool isResuming = false;
+    double cacheSize = 1024; // MB
+    PAPG::SolveControl control;
+
+    // parses the value of the option at argv[i] as a number, at least minimum
+    auto parseNumber = [&](int& i, double& number, double minimum) {
+        if (i + 1 == argc) {
+            return false;
         }
+        try {
+            number = std::stod(argv[++i]);
+        } catch (const std::exception&) {
+            return false;
+        }
+        return number >= minimum;
+    };
 
-        {
-            // propagationRecursiveHybrid
-            auto begin = std::chrono::steady_clock::now();
-            auto result = solver.solvePropagationRecursiveHybrid();
-            auto end = std::chrono::steady_clock::now();
+    auto isOption = [&](int i, const char shortName[], const char longName[]) {
+        return (shortName != nullptr && std::strcmp(argv[i], shortName) == 0) || std::strcmp(argv[i], longName) == 0;
+    };
+
+    for (int i = 1; i < argc; i++) {
+        double number = 0;
+        bool isValid = true;
+
+        if (isOption(i, "-e", "--engine") || isOption(i, "-s", "--strategy") || isOption(i, "-o", "--output")) {
+            if (i + 1 == argc) {
+                printUsage();
+                return 1;
+            }
+
+            const std::string value = argv[i + 1];
+            if (isOption(i, "-e", "--engine")) {
+                for (auto& engine : splitList(value)) {
+                    engines.push_back(engine);
+                }
+            } else if (isOption(i, "-s", "--strategy")) {
+                for (auto& name : splitList(value)) {
+                    names.push_back(name);
+                }
+            } else {
+                if (value == "human") {
+                    mode = OutputMode::human;
+                } else if (value == "table") {
+                    mode = OutputMode::table;
+                } else if (value == "bench") {
+                    mode = OutputMode::bench;
+                } else {
+                    isValid = false;
+                }
+            }
+            i++;
+        } else if (isOption(i, "-l", "--list")) {
+            isListing = true;
+        } else if (isOption(i, "-w", "--warmup")) {
+            isValid = parseNumber(i, number, 0);
+            warmups = static_cast<unsigned>(number);
+        } else if (isOption(i, "-r", "--repeat")) {
+            isValid = parseNumber(i, number, 1);
+            repetitions = static_cast<unsigned>(number);
+        } else if (isOption(i, nullptr, "--no-preprocess")) {
+            isPreprocessing = false;
+        } else if (isOption(i, nullptr, "--reduce")) {
+            reduction = std::max(reduction, Reduction::on);
+        } else if (isOption(i, nullptr, "--compare-reduction")) {
+            reduction = Reduction::compared;
+        } else if (isOption(i, "-t", "--timeout")) {
+            isValid = parseNumber(i, number, 0) && number > 0;
+            control.setTimeLimit(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(number)));
+        } else if (isOption(i, nullptr, "--lift-budget")) {
+            isValid = parseNumber(i, number, 1);
+            control.setLiftBudget(static_cast<unsigned long long>(number));
+        } else if (isOption(i, nullptr, "--progress")) {
+            isValid = parseNumber(i, number, 0) && number > 0;
+            control.setProgressInterval(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(number)));
+        } else if (isOption(i, nullptr, "--cache")) {
+            isValid = i + 1 < argc;
+            cacheDirectory = isValid ? argv[++i] : "";
+        } else if (isOption(i, nullptr, "--cache-size")) {
+            isValid = parseNumber(i, cacheSize, 0);
+        } else if (isOption(i, nullptr, "--checkpoint")) {
+            isValid = i + 1 < argc;
+            checkpointPath = isValid ? argv[++i] : "";
+        } else if (isOption(i, nullptr, "--checkpoint-interval")) {
+            isValid = parseNumber(i, checkpointInterval, 0) && checkpointInterval > 0;
+        } else if (isOption(i, nullptr, "--resume")) {
+            isResuming = true;
+        } else if (isOption(i, nullptr, "--model")) {
+            isValid = i + 1 < argc;
+            modelPath = isValid ? argv[++i] : "";
+        } else if (isOption(i, nullptr, "--perf")) {
+            isCounting = true;
+        } else if (isOption(i, nullptr, "--trace")) {
+            isValid = i + 1 < argc;
+            tracePath = isValid ? argv[++i] : "";
+        } else if (isOption(i, "-h", "--help")) {
+            printUsage();
+            return 0;
+        } else if (argv[i][0] == '-') {
+            isValid = false; // an option we don't know, rather than a game
+        } else {
+            paths.push_back(argv[i]);
+        }
 
-            localTimes.push_back(std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count());
-            localLifts.push_back(solver.getLiftCount());
-            localResults.push_back(result);
-            solver.resetLiftCount();
+        if (!isValid) {
+            printUsage();
+            return 1;
         }
+    }
 
-        paths.push_back(path);
-        times.push_back(localTimes);
-        lifts.push_back(localLifts);
-        results.push_back(localResults);
+    // auto isn't one of the strategies that run by default, it goes last when named
+    const auto autoName = std::remove(names.begin(), names.end(), "auto");
+    const bool isAuto = autoName != names.end();
+    names.erase(autoName, names.end());
 
-        std::cerr << "DONE" << std::endl;
+    std::vector<Strategy> strategies;
+    if ((!isAuto || !names.empty() || !engines.empty()) && !selectStrategies(PAPG::makeStrategies(), engines, names, strategies)) {
+        return 1;
     }
 
-    std::cout << std::endl;
+    if (mode == OutputMode::automatic) {
+        mode = (paths.size() == 1) ? OutputMode::human : OutputMode::table;
+    }
 
-    std::string delim = ";";
+    if (isAuto) {
+        try {
+            PAPG::StrategySelector selector = PAPG::StrategySelector::makeDefault();
+            if (!modelPath.empty()) {
+                std::ifstream model(modelPath);
+                if (!model.is_open()) {
+                    throw std::runtime_error("ERR: Failed to open model " + modelPath);
+                }
+                selector = PAPG::StrategySelector::read(model);
+            }
+
+            // in the tables the choices are in the auto choice counter, the reasons go to stderr
+            const bool isHuman = mode == OutputMode::human;
+            strategies.push_back(PAPG::makeAutoStrategy(selector, [isHuman](const PAPG::StrategySelector::Choice& choice) {
+                autoChoice = choice.strategy + " (" + choice.reason + ")";
+                if (!isHuman) {
+                    std::cerr << "# auto: " << autoChoice << std::endl;
+                }
+            }));
+        } catch (const std::exception& exception) {
+            std::cerr << exception.what() << std::endl;
+            return 1;
+        }
+    }
 
-    std::string header = "path";
-    header += delim + "input order" + delim + "random order" + delim + "priority order" + delim + "incoming order"; 
-    header += delim + "recursive" + delim + "recursive priority order" + delim + "recursive incoming order" + delim + "propagation" + delim + "propagation recursive hybrid";
+    if (isListing) {
+        printStrategies(strategies);
+        return 0;
+    }
 
-    std::cout << "Lifts:" << std::endl;
-    std::cout << header << std::endl;
-    for (size_t game = 0; game < paths.size(); game++) {
-        std::cout << paths[game];
-        for (auto& numLifts : lifts[game]) {
-            std::cout << delim << numLifts;
+    if (paths.empty()) {
+        printUsage();
+        return argc == 1 ? 0 : 1;
+    }
+
+    if (!tracePath.empty()) {
+#ifdef PAPG_TRACE
+        try {
+            PAPG::LiftTrace::open(tracePath);
+        } catch (const std::exception& exception) {
+            std::cerr << exception.what() << std::endl;
+            return 1;
         }
-        std::cout << std::endl;
+#else
+        std::cerr << "ERR: --trace needs papg built with make TRACE=1." << std::endl;
+        return 1;
+#endif
     }
 
-    std::cout << "Time (µS):" << std::endl;
-    std::cout << header << std::endl;
-    for (size_t game = 0; game < paths.size(); game++) {
-        std::cout << paths[game];
-        for (auto& time : times[game]) {
-            std::cout << delim << time;
+    std::unique_ptr<PAPG::PerfCounters> counters;
+    if (isCounting) {
+        counters.reset(new PAPG::PerfCounters());
+        if (!counters->isAvailable()) {
+            std::cerr << "# hardware counters are unavailable, running without them (" << counters->getError() << ")" << std::endl;
+        } else {
+            if (!counters->isComplete()) {
+                std::cerr << "# some hardware counters are unavailable (" << counters->getError() << ")" << std::endl;
+            }
+            perfCounters = counters.get();
         }
-        std::cout << std::endl;
     }
 
-    std::cout << "Outcome V0:" << std::endl;
-    std::cout << header << std::endl;
-    for (size_t game = 0; game < paths.size(); game++) {
-        std::cout << paths[game];
-        for (auto& result : results[game]) {
-            std::cout << delim << (result[0] == PAPG::Player::odd);
+    std::unique_ptr<PAPG::SolutionCache> cache;
+    if (!cacheDirectory.empty()) {
+        try {
+            cache.reset(new PAPG::SolutionCache(cacheDirectory, static_cast<uint64_t>(cacheSize * 1024 * 1024)));
+        } catch (const std::exception& exception) {
+            std::cerr << exception.what() << std::endl;
+            return 1;
         }
-        std::cout << std::endl;
+        solutionCache = cache.get();
     }
-}
 
-int main(int argc, char* argv[])
-{
-    if (argc == 1) {
-        std::cout << "Usage: input one file for (somewhat) human-readable output or multiple files for ';'-delimited tables. i.e.:" << std::endl;
-        std::cout << "papg <PGSolver min parity game>" << std::endl;
-        std::cout << "\te.g. papg testcases/1.gm" << std::endl;
-        std::cout << "\tWill run all strategies on the given game and output basic results and measurements in a (somewhat) human-readable format." << std::endl;
-        std::cout << "papg <PGSolver min parity game> <PGSolver min parity game>+" << std::endl;
-        std::cout << "\te.g. papg testcases/1.gm testcases/2.gm testcases/3.gm" << std::endl;
-        std::cout << "\tWill run all stratgeies on the given games and output results and measurements in ';'-delimited tables." << std::endl;
-    } else if (argc == 2) {
-        processGame(argv[1]);
-    } else {
-        generateResultsTable(argc, argv);
+    if (isResuming && checkpointPath.empty()) {
+        std::cerr << "ERR: --resume needs --checkpoint." << std::endl;
+        return 1;
+    }
+    std::unique_ptr<PAPG::Checkpointer> checkpointer;
+    if (!checkpointPath.empty()) {
+        checkpointer.reset(new PAPG::Checkpointer(checkpointPath,
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(checkpointInterval))));
+        if (isResuming) {
+            try {
+                checkpointer->loadResume();
+            } catch (const std::exception& exception) {
+                std::cerr << exception.what() << std::endl;
+                return 1;
+            }
+        }
+        control.setCheckpointer(checkpointer.get());
     }
 
-    return 0;
-}
\ No newline at end of file
+    signalControl = &control;
+    std::signal(SIGINT, handleSignal);
+    std::signal(SIGUSR1, handleSignal);
+    if (checkpointer) {
+        std::signal(SIGTERM, handleSignal); // a job being preempted gets a last checkpoint
+    }
+
+    switch (mode) {
+    case OutputMode::human:
+        for (auto& path : paths) {
+            processGame(path.c_str(), strategies, isPreprocessing, reduction, control);
+        }
+        break;
+    case OutputMode::table:
+        generateResultsTable(paths, strategies, isPreprocessing, reduction, control);
+        break;
+    case OutputMode::bench:
+        generateBenchmarkTable(paths, strategies, isPreprocessing, reduction, warmups, repetitions, control);
+        break;
+    case OutputMode::automatic:
+        break;
+    }
+
+    if (checkpointer) {
+        checkpointer->flush();
+        std::cout << "# checkpoints written: " << checkpointer->getWrittenCount() << std::endl;
+        if (!checkpointer->getError().empty()) {
+            std::cerr << checkpointer->getError() << std::endl;
+        }
+    }
+
+    if (cache) {
+        const PAPG::SolutionCache::Stats& stats = cache->getStats();
+        std::cout << "# solution cache: " << stats.hits << " hits, " << stats.misses << " misses, "
+                  << stats.stores << " stored, " << stats.evictions << " evicted" << std::endl;
+    }
+
+#ifdef PAPG_TRACE
+    try {
+        PAPG::LiftTrace::close();
+    } catch (const std::exception& exception) {
+        std::cerr << exception.what() << std::endl;
+        return 1;
+    }
+#endif
+
+    return control.isCancelled() ? 130 : 0;
+}
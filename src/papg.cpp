@@ -0,0 +1,330 @@
+#include "papg.h"
+#include "Arena.hpp"
+#include "Parser.hpp"
+#include "Preprocessor.hpp"
+#include "SolveControl.hpp"
+#include "Strategies.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <new>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+struct papg_arena {
+    PAPG::Arena arena;
+
+    explicit papg_arena(PAPG::Arena&& arena)
+        : arena(std::move(arena))
+    {
+    }
+};
+
+struct papg_solver {
+    PAPG::Strategy strategy;
+    bool isPreprocessing = true;
+    PAPG::SolveControl control;
+    PAPG::Workspace workspace; // the strategy's solver, rebound to every arena solved
+
+    // results of the last solve, reused between solves
+    std::vector<uint8_t> winners;
+    std::vector<size_t> residualStrategy;
+    std::vector<size_t> strategyBuffer;
+    bool hasStrategy = false;
+    PAPG::Counters counters;
+    std::string error;
+
+    explicit papg_solver(const PAPG::Strategy& strategy)
+        : strategy(strategy)
+    {
+    }
+};
+
+namespace {
+// reads directly from a block of memory, so text can be parsed without copying it
+class MemoryBuffer : public std::streambuf {
+public:
+    MemoryBuffer(const char* text, size_t length)
+    {
+        char* begin = const_cast<char*>(text); // only ever read
+        setg(begin, begin, begin + length);
+    }
+};
+
+const std::vector<PAPG::Strategy>& getStrategies()
+{
+    static const std::vector<PAPG::Strategy> strategies = PAPG::makeStrategies();
+    return strategies;
+}
+
+// every vertex needs a way out, parsed games can leave declared vertices without one
+bool hasDeadEnd(const PAPG::Arena& arena)
+{
+    return std::any_of(arena.getVertices().begin(), arena.getVertices().end(),
+        [](const PAPG::Vertex& vertex) { return vertex.outgoing.empty(); });
+}
+
+// runs the solve of solver on arena, without the error handling
+void solve(papg_solver& solver, const PAPG::Arena& arena)
+{
+    PAPG::Preprocessor preprocessor(arena);
+    if (solver.isPreprocessing) {
+        preprocessor.run();
+    }
+    const PAPG::Arena& game = solver.isPreprocessing ? preprocessor.getResidualArena() : arena;
+
+    std::vector<PAPG::Player> results;
+    solver.residualStrategy.clear();
+    solver.workspace.startGame(); // game is gone after this solve
+    if (game.getSize() > 0) {
+        solver.control.start();
+        results = solver.strategy.solve(game, solver.workspace, solver.control, solver.counters, &solver.residualStrategy);
+    }
+    if (solver.isPreprocessing) {
+        results = preprocessor.mergeResults(results);
+    }
+
+    solver.winners.resize(results.size());
+    for (size_t id = 0; id < results.size(); id++) {
+        solver.winners[id] = (results[id] == PAPG::Player::even) ? PAPG_EVEN : PAPG_ODD;
+    }
+
+    // an empty residual means preprocessing decided everything, strategies included
+    solver.hasStrategy = !solver.residualStrategy.empty() || (solver.isPreprocessing && game.getSize() == 0);
+    if (solver.hasStrategy) {
+        if (solver.isPreprocessing) {
+            solver.strategyBuffer = preprocessor.mergeStrategy(solver.residualStrategy);
+        } else {
+            solver.strategyBuffer.swap(solver.residualStrategy);
+        }
+    }
+}
+}
+
+const char* papg_version(void)
+{
+    return "1.0";
+}
+
+papg_status papg_arena_create(size_t num_vertices, const uint8_t* owners, const uint32_t* priorities,
+    const size_t* successor_offsets, const size_t* successors, papg_arena** arena)
+{
+    if (arena == nullptr || (num_vertices > 0 && (owners == nullptr || priorities == nullptr || successor_offsets == nullptr || successors == nullptr))) {
+        return PAPG_INVALID_ARGUMENT;
+    }
+    *arena = nullptr;
+
+    try {
+        PAPG::Arena result(num_vertices);
+        for (size_t id = 0; id < num_vertices; id++) {
+            if (owners[id] != PAPG_EVEN && owners[id] != PAPG_ODD) {
+                return PAPG_INVALID_ARGUMENT;
+            }
+            // every vertex needs a way out
+            if (successor_offsets[id] >= successor_offsets[id + 1]) {
+                return PAPG_INVALID_ARGUMENT;
+            }
+
+            result.setVertexOwner(id, (owners[id] == PAPG_EVEN) ? PAPG::Player::even : PAPG::Player::odd);
+            result.setVertexPriority(id, priorities[id]);
+            for (size_t edge = successor_offsets[id]; edge < successor_offsets[id + 1]; edge++) {
+                if (successors[edge] >= num_vertices) {
+                    return PAPG_INVALID_ARGUMENT;
+                }
+                result.addEdge(id, successors[edge]);
+            }
+        }
+
+        *arena = new papg_arena(std::move(result));
+        return PAPG_OK;
+    } catch (const std::bad_alloc&) {
+        return PAPG_INTERNAL_ERROR;
+    }
+}
+
+papg_status papg_arena_parse(const char* path, papg_arena** arena)
+{
+    if (path == nullptr || arena == nullptr) {
+        return PAPG_INVALID_ARGUMENT;
+    }
+    *arena = nullptr;
+
+    if (!std::ifstream(path).is_open()) {
+        return PAPG_INVALID_ARGUMENT;
+    }
+
+    try {
+        PAPG::Arena result = PAPG::Parser::parse(std::string(path));
+        if (hasDeadEnd(result)) {
+            return PAPG_INVALID_ARGUMENT;
+        }
+        *arena = new papg_arena(std::move(result));
+        return PAPG_OK;
+    } catch (const std::bad_alloc&) {
+        return PAPG_INTERNAL_ERROR;
+    } catch (const std::exception&) {
+        return PAPG_INVALID_ARGUMENT; // malformed or truncated input
+    }
+}
+
+papg_status papg_arena_parse_text(const char* text, size_t length, papg_arena** arena)
+{
+    if ((text == nullptr && length > 0) || arena == nullptr) {
+        return PAPG_INVALID_ARGUMENT;
+    }
+    *arena = nullptr;
+
+    try {
+        MemoryBuffer buffer(text, length);
+        std::istream stream(&buffer);
+        PAPG::Arena result = PAPG::Parser::parse(stream);
+        if (hasDeadEnd(result)) {
+            return PAPG_INVALID_ARGUMENT;
+        }
+        *arena = new papg_arena(std::move(result));
+        return PAPG_OK;
+    } catch (const std::bad_alloc&) {
+        return PAPG_INTERNAL_ERROR;
+    } catch (const std::exception&) {
+        return PAPG_INVALID_ARGUMENT;
+    }
+}
+
+void papg_arena_destroy(papg_arena* arena)
+{
+    delete arena;
+}
+
+size_t papg_arena_size(const papg_arena* arena)
+{
+    return (arena != nullptr) ? arena->arena.getSize() : 0;
+}
+
+size_t papg_strategy_count(void)
+{
+    return getStrategies().size();
+}
+
+const char* papg_strategy_name(size_t index)
+{
+    return (index < getStrategies().size()) ? getStrategies()[index].name.c_str() : nullptr;
+}
+
+const char* papg_strategy_engine(size_t index)
+{
+    return (index < getStrategies().size()) ? getStrategies()[index].engine.c_str() : nullptr;
+}
+
+papg_status papg_solver_create(const char* name, papg_solver** solver)
+{
+    if (name == nullptr || solver == nullptr) {
+        return PAPG_INVALID_ARGUMENT;
+    }
+    *solver = nullptr;
+
+    const PAPG::Strategy* match = nullptr;
+    for (const PAPG::Strategy& strategy : getStrategies()) {
+        if (strategy.name == name) {
+            match = &strategy;
+            break;
+        }
+        if (match == nullptr && strategy.engine == name) {
+            match = &strategy;
+        }
+    }
+    if (match == nullptr) {
+        return PAPG_UNKNOWN_STRATEGY;
+    }
+
+    try {
+        *solver = new papg_solver(*match);
+        return PAPG_OK;
+    } catch (const std::bad_alloc&) {
+        return PAPG_INTERNAL_ERROR;
+    }
+}
+
+void papg_solver_destroy(papg_solver* solver)
+{
+    delete solver;
+}
+
+void papg_solver_set_time_limit(papg_solver* solver, double seconds)
+{
+    solver->control.setTimeLimit(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds)));
+}
+
+void papg_solver_set_lift_budget(papg_solver* solver, unsigned long long lifts)
+{
+    solver->control.setLiftBudget(lifts);
+}
+
+void papg_solver_set_preprocessing(papg_solver* solver, int enabled)
+{
+    solver->isPreprocessing = (enabled != 0);
+}
+
+void papg_solver_cancel(papg_solver* solver)
+{
+    solver->control.cancel();
+}
+
+papg_status papg_solve(papg_solver* solver, const papg_arena* arena)
+{
+    if (solver == nullptr || arena == nullptr) {
+        return PAPG_INVALID_ARGUMENT;
+    }
+
+    solver->winners.clear();
+    solver->hasStrategy = false;
+    solver->counters.clear();
+    solver->error.clear();
+
+    try {
+        solve(*solver, arena->arena);
+        return PAPG_OK;
+    } catch (const PAPG::SolveInterrupted& interruption) {
+        solver->error = PAPG::toString(interruption.getReason());
+        return PAPG_INTERRUPTED;
+    } catch (const std::exception& exception) {
+        solver->error = exception.what();
+    } catch (...) {
+        solver->error = "unknown error";
+    }
+    solver->winners.clear();
+    solver->hasStrategy = false;
+    return PAPG_INTERNAL_ERROR;
+}
+
+const uint8_t* papg_solver_winners(const papg_solver* solver)
+{
+    return solver->winners.data();
+}
+
+const size_t* papg_solver_strategy(const papg_solver* solver)
+{
+    return solver->hasStrategy ? solver->strategyBuffer.data() : nullptr;
+}
+
+size_t papg_solver_counter_count(const papg_solver* solver)
+{
+    return solver->counters.size();
+}
+
+const char* papg_solver_counter_name(const papg_solver* solver, size_t index)
+{
+    return (index < solver->counters.size()) ? solver->counters[index].first.c_str() : nullptr;
+}
+
+unsigned long long papg_solver_counter_value(const papg_solver* solver, size_t index)
+{
+    return (index < solver->counters.size()) ? solver->counters[index].second : 0;
+}
+
+const char* papg_solver_error(const papg_solver* solver)
+{
+    return solver->error.c_str();
+}
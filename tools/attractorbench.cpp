@@ -0,0 +1,79 @@
+// Measures the throughput of the attractor computation in edges per second,
+// sequentially and with a parallel frontier, see printUsage().
+
+#include "Attractor.hpp"
+#include "Parser.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace PAPG;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// Attractors of random targets (about one in targetRatio vertices) for both
+// players on the full game, returns the edges per second.
+double measure(const Arena& arena, unsigned threads, unsigned repetitions, unsigned targetRatio)
+{
+    Attractor attractor(arena);
+    attractor.setMaxThreads(threads);
+
+    const VertexSet game(arena.getSize(), true);
+    std::mt19937 random(1);
+    Clock::duration time(0);
+
+    for (unsigned repetition = 0; repetition < repetitions; repetition++) {
+        for (const Player player : { Player::even, Player::odd }) {
+            VertexSet region(arena.getSize());
+            for (size_t id = 0; id < arena.getSize(); id++) {
+                if (random() % targetRatio == 0) {
+                    region.insert(id);
+                }
+            }
+
+            const Clock::time_point start = Clock::now();
+            attractor.attract(game, region, player);
+            time += Clock::now() - start;
+        }
+    }
+
+    return attractor.getEdgeCount() / std::chrono::duration<double>(time).count();
+}
+
+void printUsage()
+{
+    std::cout << "Usage: attractorbench <repetitions> <PGSolver min parity game>+" << std::endl;
+    std::cout << "\tComputes attractors of random targets for both players on every game, sequentially and with a parallel" << std::endl;
+    std::cout << "\tfrontier on all hardware threads, and prints the incoming edges looked at per second." << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3) {
+        printUsage();
+        return 1;
+    }
+    const unsigned repetitions = std::max(1, std::atoi(argv[1]));
+    const unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::cout << "Attractor throughput (edges/s)" << std::endl;
+    std::cout << "game;vertices;sparse targets;dense targets;sparse targets " << threads << " threads;dense targets " << threads << " threads" << std::endl;
+    for (int i = 2; i < argc; i++) {
+        const Arena arena = Parser::parse(std::string(argv[i]));
+        std::cout << argv[i] << ";" << arena.getSize()
+                  << ";" << measure(arena, 1, repetitions, 1000) << ";" << measure(arena, 1, repetitions, 20)
+                  << ";" << measure(arena, threads, repetitions, 1000) << ";" << measure(arena, threads, repetitions, 20) << std::endl;
+    }
+
+    return 0;
+}
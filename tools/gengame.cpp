@@ -0,0 +1,103 @@
+// Generates parity games in PGSolver format for benchmarking, see printUsage().
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+
+namespace {
+
+void printVertex(size_t id, size_t priority, int owner, const std::set<size_t>& successors)
+{
+    std::cout << id << " " << priority << " " << owner << " ";
+    for (auto it = successors.begin(); it != successors.end(); ++it) {
+        std::cout << (it == successors.begin() ? "" : ",") << *it;
+    }
+    std::cout << ";\n";
+}
+
+// Uniformly random game: random owners, priorities in [0, maxPriority] and
+// between 1 and maxOutgoing random successors per vertex.
+void generateRandom(size_t size, size_t maxPriority, size_t maxOutgoing, unsigned seed)
+{
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<size_t> vertexDistribution(0, size - 1);
+    std::uniform_int_distribution<size_t> priorityDistribution(0, maxPriority);
+    std::uniform_int_distribution<size_t> outgoingDistribution(1, maxOutgoing);
+    std::uniform_int_distribution<int> ownerDistribution(0, 1);
+
+    std::cout << "parity " << size - 1 << ";\n";
+    for (size_t id = 0; id < size; id++) {
+        const size_t priority = priorityDistribution(random);
+        const int owner = ownerDistribution(random);
+
+        std::set<size_t> successors;
+        for (size_t i = outgoingDistribution(random); i > 0; i--) {
+            successors.insert(vertexDistribution(random));
+        }
+
+        printVertex(id, priority, owner, successors);
+    }
+}
+
+// Counter game, adversarial for small progress measures: Even vertex 0
+// (priority 2 * levels) chooses between levels 1 to levels, where level i is
+// a chain of width odd vertices with priority 2i - 1 leading back to vertex 0. Odd
+// wins everywhere, but while lifting vertex 0 Even always takes the level
+// giving the least increment, so its measure counts through all
+// (width + 1)^levels classic measures before reaching top.
+void generateCounter(size_t levels, size_t width)
+{
+    std::cout << "parity " << levels * width << ";\n";
+
+    std::set<size_t> choices;
+    for (size_t level = 0; level < levels; level++) {
+        choices.insert(1 + level * width);
+    }
+    printVertex(0, 2 * levels, 0, choices);
+
+    for (size_t level = 0; level < levels; level++) {
+        for (size_t i = 0; i < width; i++) {
+            const size_t id = 1 + level * width + i;
+            printVertex(id, 2 * level + 1, 1, { i + 1 < width ? id + 1 : 0 });
+        }
+    }
+}
+
+void printUsage()
+{
+    std::cout << "Usage:" << std::endl;
+    std::cout << "gengame random <vertices> <max priority> <max outgoing> <seed>" << std::endl;
+    std::cout << "\tUniformly random game." << std::endl;
+    std::cout << "gengame counter <levels> <width>" << std::endl;
+    std::cout << "\tGame on which classic progress measures count through (width + 1)^levels values." << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    if (argc == 6 && std::strcmp(argv[1], "random") == 0) {
+        const size_t size = std::strtoul(argv[2], nullptr, 10);
+        if (size == 0) {
+            printUsage();
+            return 1;
+        }
+        generateRandom(size, std::strtoul(argv[3], nullptr, 10), std::max(1ul, std::strtoul(argv[4], nullptr, 10)), std::strtoul(argv[5], nullptr, 10));
+    } else if (argc == 4 && std::strcmp(argv[1], "counter") == 0) {
+        const size_t levels = std::strtoul(argv[2], nullptr, 10);
+        const size_t width = std::strtoul(argv[3], nullptr, 10);
+        if (levels == 0 || width == 0) {
+            printUsage();
+            return 1;
+        }
+        generateCounter(levels, width);
+    } else {
+        printUsage();
+        return argc == 1 ? 0 : 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,331 @@
+// Measures the cost of the primitives the solvers are built from, one at a
+// time, in nanoseconds per operation, see printUsage().
+
+#include "Arena.hpp"
+#include "Measure.hpp"
+#include "SPMSolver.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace PAPG;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+const unsigned numSamples = 15;
+const Clock::duration sampleTime = std::chrono::milliseconds(5);
+
+// results are added up here so the compiler can't drop the work
+volatile unsigned long long sink = 0;
+
+struct Statistics {
+    double min;
+    double median;
+    double mean;
+    double p95;
+    double stddev;
+};
+
+// statistics of the given nanoseconds per operation, which must not be empty
+Statistics getStatistics(std::vector<double> samples)
+{
+    std::sort(samples.begin(), samples.end());
+
+    double mean = 0;
+    for (const double sample : samples) {
+        mean += sample;
+    }
+    mean /= samples.size();
+
+    double variance = 0;
+    for (const double sample : samples) {
+        variance += (sample - mean) * (sample - mean);
+    }
+    variance /= samples.size();
+
+    // p95 by nearest rank
+    const size_t p95Rank = (samples.size() * 95 + 99) / 100;
+
+    return Statistics{ samples.front(), samples[(samples.size() - 1) / 2], mean, samples[p95Rank - 1], std::sqrt(variance) };
+}
+
+// A benchmark runs a batch of at least the given number of operations and
+// returns how many it did, setting the time they took without any setup.
+struct Benchmark {
+    std::string name;
+    std::function<size_t(size_t, Clock::duration&)> run;
+};
+
+// times a batch of operations as a whole, for benchmarks that need no untimed preparation
+std::function<size_t(size_t, Clock::duration&)> timed(std::function<void(size_t)> operations)
+{
+    return [operations](size_t count, Clock::duration& time) {
+        const Clock::time_point start = Clock::now();
+        operations(count);
+        time = Clock::now() - start;
+        return count;
+    };
+}
+
+// Finds a batch size that takes about sampleTime, runs one warm-up batch and
+// then numSamples measured ones, and prints their statistics.
+void measure(const Benchmark& benchmark)
+{
+    size_t batch = 1;
+    size_t operations = 0;
+    Clock::duration time(0);
+    while (true) {
+        operations = benchmark.run(batch, time);
+        if (time >= sampleTime / 4) {
+            break;
+        }
+        batch = std::max(batch, operations) * 4;
+    }
+    batch = std::max<size_t>(1, operations * std::chrono::duration<double>(sampleTime).count() / std::chrono::duration<double>(time).count());
+
+    std::vector<double> samples;
+    for (unsigned sample = 0; sample <= numSamples; sample++) {
+        operations = benchmark.run(batch, time);
+        if (sample > 0) {
+            samples.push_back(std::chrono::duration<double, std::nano>(time).count() / operations);
+        }
+    }
+
+    const Statistics statistics = getStatistics(samples);
+    std::cout << std::fixed << std::setprecision(2) << benchmark.name << ";" << operations << ";" << statistics.min << ";" << statistics.median << ";"
+              << statistics.mean << ";" << statistics.p95 << ";" << statistics.stddev << std::endl;
+}
+
+// the max measure for games with priorities [0, size), maxValue vertices of every odd priority
+Measure makeMaxMeasure(size_t size, unsigned maxValue)
+{
+    std::vector<unsigned> maxValues(size, 0);
+    for (size_t priority = 1; priority < size; priority += 2) {
+        maxValues[priority] = maxValue;
+    }
+    return Measure(maxValues);
+}
+
+// random measures of maxMeasure's space, in a deque as measures can't be moved around
+std::deque<Measure> makeMeasures(const Measure& maxMeasure, size_t count, unsigned seed)
+{
+    std::mt19937 random(seed);
+    std::deque<Measure> measures;
+    for (size_t i = 0; i < count; i++) {
+        measures.emplace_back(maxMeasure);
+        for (size_t index = 1; index < maxMeasure.getSize(); index += 2) {
+            measures.back().setValue(index, random() % (maxMeasure.getValue(index) + 1));
+        }
+    }
+    return measures;
+}
+
+// Measures that agree on all but their last value, so comparing them looks at every value.
+std::deque<Measure> makeSimilarMeasures(const Measure& maxMeasure, size_t count, unsigned seed)
+{
+    std::deque<Measure> measures = makeMeasures(maxMeasure, count, seed);
+    for (size_t i = 1; i < count; i++) {
+        for (size_t index = 1; index + 2 < maxMeasure.getSize(); index += 2) {
+            measures[i].setValue(index, measures[0].getValue(index));
+        }
+    }
+    return measures;
+}
+
+void addMeasureBenchmarks(std::vector<Benchmark>& benchmarks, size_t size)
+{
+    const std::string suffix = " (" + std::to_string(size) + " priorities)";
+    const size_t count = 1024; // a power of two
+
+    benchmarks.push_back(Benchmark{ "measure compare" + suffix, [=](size_t batch, Clock::duration& time) {
+        const Measure maxMeasure = makeMaxMeasure(size, 1000);
+        const std::deque<Measure> measures = makeSimilarMeasures(maxMeasure, count, 1);
+        return timed([&](size_t operations) {
+            unsigned long long less = 0;
+            for (size_t i = 0; i < operations; i++) {
+                less += measures[i % count] < measures[(i + 1) % count];
+            }
+            sink += less;
+        })(batch, time);
+    } });
+
+    benchmarks.push_back(Benchmark{ "measure truncate" + suffix, [=](size_t batch, Clock::duration& time) {
+        const Measure maxMeasure = makeMaxMeasure(size, 1000);
+        const std::deque<Measure> measures = makeMeasures(maxMeasure, count, 2);
+        Measure result(maxMeasure);
+        return timed([&](size_t operations) {
+            for (size_t i = 0; i < operations; i++) {
+                result.makePartialEqualOf(size - 1 - (i % 2), measures[i % count]); // boundaries of either parity
+            }
+            sink += result.getValue(1);
+        })(batch, time);
+    } });
+
+    benchmarks.push_back(Benchmark{ "measure increment" + suffix, [=](size_t batch, Clock::duration& time) {
+        const Measure maxMeasure = makeMaxMeasure(size, 3); // carries every fourth increment
+        const Measure bottom(maxMeasure);
+        Measure result(maxMeasure);
+        return timed([&](size_t operations) {
+            for (size_t i = 0; i < operations; i++) {
+                if (!result.partialIncrementIfAble(size - 1)) {
+                    result = bottom; // past the max measure, start over
+                }
+            }
+            sink += result.getValue(size - 1);
+        })(batch, time);
+    } });
+}
+
+// A game of centers that all have the same outDegree successors, of various
+// odd priorities up to 7 and with a self-loop each: every lift of a center
+// looks at outDegree successors.
+Arena makeStarGame(size_t numCenters, size_t outDegree)
+{
+    Arena arena(numCenters + outDegree);
+    for (size_t successor = numCenters; successor < arena.getSize(); successor++) {
+        arena.setVertexOwner(successor, Player::odd);
+        arena.setVertexPriority(successor, 2 * (successor % 4) + 1);
+        arena.addEdge(successor, successor);
+    }
+    for (size_t center = 0; center < numCenters; center++) {
+        arena.setVertexOwner(center, Player::even);
+        arena.setVertexPriority(center, 3);
+        for (size_t successor = numCenters; successor < arena.getSize(); successor++) {
+            arena.addEdge(center, successor);
+        }
+    }
+    return arena;
+}
+
+void addSolverBenchmarks(std::vector<Benchmark>& benchmarks, size_t outDegree)
+{
+    const std::string suffix = " (out-degree " + std::to_string(outDegree) + ")";
+    const size_t numCenters = 1024;
+
+    // prog from every center to every successor
+    benchmarks.push_back(Benchmark{ "prog" + suffix, [=](size_t batch, Clock::duration& time) {
+        const Arena arena = makeStarGame(numCenters, outDegree);
+        SPMSolver solver(arena);
+        solver.initializeMeasures();
+        return timed([&](size_t operations) {
+            unsigned long long tops = 0;
+            for (size_t i = 0; i < operations; i++) {
+                tops += solver.prog(i % numCenters, numCenters + i % outDegree).isTop();
+            }
+            sink += tops;
+        })(batch, time);
+    } });
+
+    // the first lift of a vertex looks at every successor
+    benchmarks.push_back(Benchmark{ "lift, full scan" + suffix, [=](size_t batch, Clock::duration& time) {
+        const Arena arena = makeStarGame(numCenters, outDegree);
+        SPMSolver solver(arena);
+        size_t operations = 0;
+        time = Clock::duration(0);
+        while (operations < batch) {
+            solver.initializeMeasures();
+            const Clock::time_point start = Clock::now();
+            for (size_t center = 0; center < numCenters; center++) {
+                sink += solver.lift(center);
+            }
+            time += Clock::now() - start;
+            operations += numCenters;
+        }
+        return operations;
+    } });
+
+    // lifting again while nothing changed only checks the witness
+    benchmarks.push_back(Benchmark{ "lift, unchanged witness" + suffix, [=](size_t batch, Clock::duration& time) {
+        const Arena arena = makeStarGame(numCenters, outDegree);
+        SPMSolver solver(arena);
+        solver.initializeMeasures();
+        for (size_t center = 0; center < numCenters; center++) {
+            solver.lift(center);
+        }
+        return timed([&](size_t operations) {
+            unsigned long long lifted = 0;
+            for (size_t i = 0; i < operations; i++) {
+                lifted += solver.lift(i % numCenters);
+            }
+            sink += lifted;
+        })(batch, time);
+    } });
+}
+
+// building a random game of 65536 vertices with outDegree edges each, per edge
+void addArenaBenchmark(std::vector<Benchmark>& benchmarks, size_t outDegree)
+{
+    const size_t numVertices = 1 << 16;
+
+    benchmarks.push_back(Benchmark{ "addEdge (out-degree " + std::to_string(outDegree) + ")", [=](size_t batch, Clock::duration& time) {
+        std::mt19937 random(3);
+        std::vector<size_t> targets(numVertices * outDegree);
+        for (auto& target : targets) {
+            target = random() % numVertices;
+        }
+
+        size_t operations = 0;
+        time = Clock::duration(0);
+        while (operations < batch) {
+            const Clock::time_point start = Clock::now();
+            Arena arena(numVertices);
+            for (size_t edge = 0; edge < targets.size(); edge++) {
+                arena.addEdge(edge / outDegree, targets[edge]);
+            }
+            time += Clock::now() - start;
+            sink += arena[0].outgoing.size();
+            operations += targets.size();
+        }
+        return operations;
+    } });
+}
+
+void printUsage()
+{
+    std::cout << "Usage: microbench [filter]" << std::endl;
+    std::cout << "\tRuns the microbenchmarks whose name contains filter (all without one) and prints per benchmark the" << std::endl;
+    std::cout << "\toperations per sample and the min, median, mean, p95 and standard deviation of the nanoseconds per" << std::endl;
+    std::cout << "\toperation over " << numSamples << " samples, after one warm-up sample." << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    if (argc > 2 || (argc == 2 && (std::string(argv[1]) == "-h" || std::string(argv[1]) == "--help"))) {
+        printUsage();
+        return argc > 2;
+    }
+    const std::string filter = (argc == 2) ? argv[1] : "";
+
+    std::vector<Benchmark> benchmarks;
+    for (const size_t size : { 2, 8, 32, 128 }) {
+        addMeasureBenchmarks(benchmarks, size);
+    }
+    for (const size_t outDegree : { 1, 4, 16, 64 }) {
+        addSolverBenchmarks(benchmarks, outDegree);
+    }
+    for (const size_t outDegree : { 2, 8, 32 }) {
+        addArenaBenchmark(benchmarks, outDegree);
+    }
+
+    std::cout << "benchmark;operations per sample;min (ns/op);median (ns/op);mean (ns/op);p95 (ns/op);stddev (ns/op)" << std::endl;
+    for (const Benchmark& benchmark : benchmarks) {
+        if (benchmark.name.find(filter) != std::string::npos) {
+            measure(benchmark);
+        }
+    }
+
+    return 0;
+}
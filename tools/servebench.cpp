@@ -0,0 +1,258 @@
+// Compares the latency and throughput of solving games through a running
+// papg serve against spawning papg for every game, see printUsage().
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+unsigned long long microseconds(Clock::duration duration)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+}
+
+unsigned long long median(std::vector<unsigned long long> values)
+{
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+void appendUint32(std::string& out, unsigned long value)
+{
+    for (int byte = 0; byte < 4; byte++) {
+        out += static_cast<char>((value >> (8 * byte)) & 0xff);
+    }
+}
+
+// the binary arena format of papg serve for a PGSolver game (without labels)
+std::string encodeBinary(const std::string& game)
+{
+    std::istringstream input(game);
+    std::string line;
+    std::getline(input, line); // header
+
+    std::vector<std::string> vertices;
+    while (std::getline(input, line)) {
+        std::istringstream fields(line);
+        size_t id;
+        if (fields >> id) {
+            vertices.resize(std::max(vertices.size(), id + 1));
+            vertices[id] = line;
+        }
+    }
+
+    std::string out;
+    appendUint32(out, vertices.size());
+    for (auto& vertex : vertices) {
+        std::istringstream fields(vertex);
+        unsigned long id, priority, owner;
+        std::string successorList;
+        fields >> id >> priority >> owner >> successorList;
+
+        std::vector<unsigned long> successors;
+        std::istringstream list(successorList);
+        unsigned long successor;
+        while (list >> successor) {
+            successors.push_back(successor);
+            list.ignore(1); // ',' or ';'
+        }
+
+        out += static_cast<char>(owner);
+        appendUint32(out, priority);
+        appendUint32(out, successors.size());
+        for (auto next : successors) {
+            appendUint32(out, next);
+        }
+    }
+    return out;
+}
+
+// one request and response on a connection to papg serve
+class Client {
+private:
+    int connection;
+    std::string buffer;
+
+    bool readLine(std::string& line)
+    {
+        size_t newline;
+        while ((newline = buffer.find('\n')) == std::string::npos) {
+            char chunk[1 << 16];
+            const ssize_t length = ::read(connection, chunk, sizeof(chunk));
+            if (length <= 0) {
+                return false;
+            }
+            buffer.append(chunk, length);
+        }
+        line = buffer.substr(0, newline);
+        buffer.erase(0, newline + 1);
+        return true;
+    }
+
+public:
+    explicit Client(const std::string& path)
+        : connection(::socket(AF_UNIX, SOCK_STREAM, 0))
+    {
+        sockaddr_un address;
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+        if (connection < 0 || ::connect(connection, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            std::cerr << "Failed to connect to " << path << std::endl;
+            std::exit(1);
+        }
+    }
+
+    ~Client() { ::close(connection); }
+
+    // sends a request, returns the winners line (empty on an error)
+    std::string solve(const std::string& format, const std::string& strategy, const std::string& game)
+    {
+        const std::string request = format + " " + std::to_string(game.size()) + " " + strategy + "\n" + game;
+        for (size_t written = 0; written < request.size();) {
+            const ssize_t length = ::write(connection, request.data() + written, request.size() - written);
+            if (length <= 0) {
+                return "";
+            }
+            written += length;
+        }
+
+        std::string line;
+        if (!readLine(line) || line.compare(0, 3, "ok ") != 0) {
+            std::cerr << "Request failed: " << line << std::endl;
+            return "";
+        }
+        std::istringstream header(line.substr(3));
+        size_t numVertices, time, numCounters;
+        header >> numVertices >> time >> numCounters;
+        for (size_t i = 0; i <= numCounters; i++) { // the counters and the winners
+            readLine(line);
+        }
+        return line;
+    }
+};
+
+// runs papg on the game with the strategy, as a client would without a server
+void spawn(const std::string& papg, const std::string& strategy, const std::string& path)
+{
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+
+    std::vector<std::string> arguments = { papg, "-s", strategy, path };
+    std::vector<char*> argv;
+    for (auto& argument : arguments) {
+        argv.push_back(&argument[0]);
+    }
+    argv.push_back(nullptr);
+
+    pid_t pid;
+    if (posix_spawn(&pid, papg.c_str(), &actions, nullptr, argv.data(), environ) != 0) {
+        std::cerr << "Failed to run " << papg << std::endl;
+        std::exit(1);
+    }
+    int status;
+    ::waitpid(pid, &status, 0);
+    posix_spawn_file_actions_destroy(&actions);
+}
+
+void printUsage()
+{
+    std::cout << "Usage: servebench <papg> <socket> <strategy> <repetitions> <game>+" << std::endl;
+    std::cout << "\tSolves every game repetitions times with the strategy, once by spawning papg for every solve and once through" << std::endl;
+    std::cout << "\tthe papg serve listening on socket (sending the games as text and in the binary format), and prints the" << std::endl;
+    std::cout << "\tmedian latency per game and the throughput of each." << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    if (argc < 6) {
+        printUsage();
+        return 1;
+    }
+    const std::string papg = argv[1];
+    const std::string socketPath = argv[2];
+    const std::string strategy = argv[3];
+    const int repetitions = std::max(1, std::atoi(argv[4]));
+    const std::vector<std::string> paths(argv + 5, argv + argc);
+
+    std::vector<std::string> games;
+    std::vector<std::string> binaryGames;
+    for (auto& path : paths) {
+        std::ifstream file(path);
+        std::stringstream contents;
+        contents << file.rdbuf();
+        games.push_back(contents.str());
+        binaryGames.push_back(encodeBinary(games.back()));
+    }
+
+    std::vector<std::vector<unsigned long long> > spawnTimes(games.size());
+
+    const Clock::time_point spawnStart = Clock::now();
+    for (int repetition = 0; repetition < repetitions; repetition++) {
+        for (size_t game = 0; game < games.size(); game++) {
+            const Clock::time_point start = Clock::now();
+            spawn(papg, strategy, paths[game]);
+            spawnTimes[game].push_back(microseconds(Clock::now() - start));
+        }
+    }
+    const Clock::duration spawnTotal = Clock::now() - spawnStart;
+
+    Client client(socketPath);
+
+    // times every game through the server in the given format, returns the total
+    auto serve = [&](const std::string& format, const std::vector<std::string>& requests, std::vector<std::vector<unsigned long long> >& times) {
+        times.assign(games.size(), {});
+        const Clock::time_point serveStart = Clock::now();
+        for (int repetition = 0; repetition < repetitions; repetition++) {
+            for (size_t game = 0; game < games.size(); game++) {
+                const Clock::time_point start = Clock::now();
+                if (client.solve(format, strategy, requests[game]).empty()) {
+                    std::exit(1);
+                }
+                times[game].push_back(microseconds(Clock::now() - start));
+            }
+        }
+        return Clock::now() - serveStart;
+    };
+
+    std::vector<std::vector<unsigned long long> > textTimes;
+    std::vector<std::vector<unsigned long long> > binaryTimes;
+    const Clock::duration textTotal = serve("text", games, textTimes);
+    const Clock::duration binaryTotal = serve("binary", binaryGames, binaryTimes);
+
+    std::cout << "Latency (median µS)" << std::endl;
+    std::cout << "game;spawn;serve text;serve binary" << std::endl;
+    for (size_t game = 0; game < games.size(); game++) {
+        std::cout << paths[game] << ";" << median(spawnTimes[game]) << ";" << median(textTimes[game]) << ";" << median(binaryTimes[game]) << std::endl;
+    }
+    std::cout << std::endl;
+
+    const double requests = static_cast<double>(repetitions) * games.size();
+    auto throughput = [&](Clock::duration total) { return requests / (microseconds(total) / 1e6); };
+    std::cout << "Throughput (games/s)" << std::endl;
+    std::cout << "spawn;serve text;serve binary" << std::endl;
+    std::cout << throughput(spawnTotal) << ";" << throughput(textTotal) << ";" << throughput(binaryTotal) << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,198 @@
+// Summarizes a lift trace recorded with papg --trace (built with make
+// TRACE=1), see printUsage() and inc/LiftTrace.hpp for the format.
+
+#include "LiftTrace.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace PAPG;
+
+namespace {
+
+const size_t numPhases = static_cast<size_t>(LiftPhase::worklist) + 1;
+
+struct VertexStats {
+    unsigned long long attempts = 0;
+    unsigned long long lifts = 0; // attempts that changed the measure
+};
+
+struct PhaseStats {
+    unsigned long long attempts = 0;
+    unsigned long long lifts = 0;
+};
+
+// A chain is a run of successful lifts one after the other on a thread, a
+// change leading to the next without a wasted attempt in between.
+struct RunStats {
+    std::string name;
+    unsigned long long attempts = 0;
+    unsigned long long lifts = 0;
+    unsigned long long liftsToTop = 0;
+    unsigned maxRecursionDepth = 0;
+    PhaseStats phases[numPhases];
+    std::unordered_map<uint64_t, VertexStats> vertices;
+    unsigned long long numChains = 0;
+    unsigned long long chainedLifts = 0;
+    unsigned long long longestChain = 0;
+};
+
+struct ThreadState {
+    uint16_t run = 0;
+    unsigned long long chain = 0; // length of the chain so far
+};
+
+void endChain(RunStats& run, ThreadState& thread)
+{
+    if (thread.chain > 0) {
+        run.numChains++;
+        run.chainedLifts += thread.chain;
+        run.longestChain = std::max(run.longestChain, thread.chain);
+        thread.chain = 0;
+    }
+}
+
+double percentage(unsigned long long part, unsigned long long whole)
+{
+    return (whole > 0) ? 100.0 * part / whole : 0.0;
+}
+
+void printRun(uint16_t id, const RunStats& run, size_t numHotVertices)
+{
+    std::cout << "run " << id << ": " << (run.name.empty() ? "(unnamed)" : run.name) << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "\tlift attempts: " << run.attempts << ", lifted: " << run.lifts << ", wasted: " << run.attempts - run.lifts
+              << " (" << percentage(run.attempts - run.lifts, run.attempts) << "%), lifted to top: " << run.liftsToTop << std::endl;
+    std::cout << "\tvertices tried: " << run.vertices.size() << ", max recursion depth: " << run.maxRecursionDepth << std::endl;
+
+    for (size_t phase = 0; phase < numPhases; phase++) {
+        const PhaseStats& stats = run.phases[phase];
+        if (stats.attempts > 0) {
+            std::cout << "\tphase " << toString(static_cast<LiftPhase>(phase)) << ": " << stats.attempts << " attempts, "
+                      << stats.lifts << " lifted, " << percentage(stats.attempts - stats.lifts, stats.attempts) << "% wasted" << std::endl;
+        }
+    }
+
+    std::cout << "\tlift chains: " << run.numChains << ", mean length: "
+              << ((run.numChains > 0) ? static_cast<double>(run.chainedLifts) / run.numChains : 0.0)
+              << ", longest: " << run.longestChain << std::endl;
+
+    std::vector<std::pair<uint64_t, VertexStats> > hot(run.vertices.begin(), run.vertices.end());
+    const size_t count = std::min(numHotVertices, hot.size());
+    std::partial_sort(hot.begin(), hot.begin() + count, hot.end(), [](const std::pair<uint64_t, VertexStats>& a, const std::pair<uint64_t, VertexStats>& b) {
+        return (a.second.attempts != b.second.attempts) ? a.second.attempts > b.second.attempts : a.first < b.first;
+    });
+    if (count > 0) {
+        std::cout << "\thot vertices (attempts, lifted, wasted):" << std::endl;
+    }
+    for (size_t i = 0; i < count; i++) {
+        const VertexStats& stats = hot[i].second;
+        std::cout << "\t\t" << hot[i].first << ": " << stats.attempts << ", " << stats.lifts << ", " << stats.attempts - stats.lifts << std::endl;
+    }
+}
+
+void printUsage()
+{
+    std::cout << "Usage: tracereport <trace file> [hot vertices]" << std::endl;
+    std::cout << "\tPrints per run the lift attempts and how many of them were wasted (left the measure as it was), per" << std::endl;
+    std::cout << "\tphase of the strategy, the lift chains (successful lifts one after the other) and the vertices with" << std::endl;
+    std::cout << "\tthe most lift attempts (10 unless given)." << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2 || argc > 3) {
+        printUsage();
+        return 1;
+    }
+    const size_t numHotVertices = (argc == 3) ? std::strtoul(argv[2], nullptr, 10) : 10;
+
+    std::FILE* file = std::fopen(argv[1], "rb");
+    char magic[sizeof(traceMagic)];
+    if (file == nullptr || std::fread(magic, sizeof(magic), 1, file) != 1 || std::memcmp(magic, traceMagic, sizeof(magic)) != 0) {
+        std::cerr << "ERR: " << argv[1] << " is not a lift trace." << std::endl;
+        if (file != nullptr) {
+            std::fclose(file);
+        }
+        return 1;
+    }
+
+    std::map<uint16_t, RunStats> runs;
+    std::unordered_map<uint32_t, ThreadState> threads;
+    std::vector<LiftRecord> records;
+    ChunkHeader header;
+    bool isTruncated = false;
+
+    while (std::fread(&header, sizeof(header), 1, file) == 1) {
+        if (header.kind == ChunkHeader::run) {
+            std::string name(header.size, '\0');
+            if (std::fread(&name[0], 1, name.size(), file) != name.size()) {
+                isTruncated = true;
+                break;
+            }
+            runs[static_cast<uint16_t>(header.id)].name = name;
+            continue;
+        }
+
+        records.resize(header.size);
+        if (header.kind != ChunkHeader::records || std::fread(records.data(), sizeof(LiftRecord), records.size(), file) != records.size()) {
+            isTruncated = true;
+            break;
+        }
+
+        ThreadState& thread = threads[header.id];
+        for (const LiftRecord& record : records) {
+            if (record.run != thread.run) {
+                endChain(runs[thread.run], thread);
+                thread.run = record.run;
+            }
+
+            RunStats& run = runs[record.run];
+            const bool isLifted = record.flags & LiftRecord::isLiftedFlag;
+            VertexStats& vertex = run.vertices[record.vertex];
+            run.attempts++;
+            vertex.attempts++;
+            run.maxRecursionDepth = std::max(run.maxRecursionDepth, record.recursionDepth);
+            if (record.phase < numPhases) {
+                run.phases[record.phase].attempts++;
+                run.phases[record.phase].lifts += isLifted;
+            }
+
+            if (isLifted) {
+                run.lifts++;
+                vertex.lifts++;
+                run.liftsToTop += (record.flags & LiftRecord::isTopFlag) != 0;
+                thread.chain++;
+            } else {
+                endChain(run, thread);
+            }
+        }
+    }
+    std::fclose(file);
+
+    for (auto& thread : threads) {
+        endChain(runs[thread.second.run], thread.second);
+    }
+
+    for (const auto& run : runs) {
+        if (run.second.attempts > 0) {
+            printRun(run.first, run.second, numHotVertices);
+        }
+    }
+
+    if (isTruncated) {
+        std::cerr << "ERR: " << argv[1] << " ends in the middle of a chunk, it was not closed properly." << std::endl;
+        return 1;
+    }
+    return 0;
+}
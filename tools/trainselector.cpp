@@ -0,0 +1,152 @@
+// Trains the decision tree of papg -s auto from the table or bench output of
+// papg runs, see printUsage() and inc/StrategySelector.hpp.
+
+#include "Parser.hpp"
+#include "Preprocessor.hpp"
+#include "StrategySelector.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace PAPG;
+
+namespace {
+
+std::vector<std::string> splitRow(const std::string& row)
+{
+    std::vector<std::string> cells;
+    std::istringstream stream(row);
+    std::string cell;
+    while (std::getline(stream, cell, ';')) {
+        cells.push_back(cell);
+    }
+    return cells;
+}
+
+// The table of times in the output, the median in bench mode: the
+// strategies of the header and a row per game. Returns false if there is none.
+bool readTimes(std::istream& input, std::vector<std::string>& strategies, std::vector<std::vector<std::string> >& rows)
+{
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(input, line)) {
+        lines.push_back(line);
+    }
+
+    size_t title = lines.size();
+    for (size_t i = 0; i < lines.size(); i++) {
+        if (lines[i] == "Time median (µS):" || (lines[i] == "Time (µS):" && title == lines.size())) {
+            title = i;
+        }
+    }
+    if (title + 1 >= lines.size()) {
+        return false;
+    }
+
+    const std::vector<std::string> header = splitRow(lines[title + 1]);
+    strategies.assign(header.begin() + 1, header.end());
+    for (size_t i = title + 2; i < lines.size() && lines[i].find(';') != std::string::npos; i++) {
+        rows.push_back(splitRow(lines[i]));
+    }
+    return true;
+}
+
+void printUsage()
+{
+    std::cout << "Usage: trainselector [--depth <levels>] [--no-preprocess] [papg output]" << std::endl;
+    std::cout << "\tReads the table or bench output of papg (from stdin unless given), takes the features of every game in" << std::endl;
+    std::cout << "\tit (after preprocessing, as papg solves it, unless --no-preprocess) and writes a decision tree of at" << std::endl;
+    std::cout << "\tmost depth levels (default 4) picking among the strategies in it for papg --model to stdout. The" << std::endl;
+    std::cout << "\tgames are read from the paths in the output. Runs that didn't finish count as very slow." << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    size_t maxDepth = 4;
+    bool isPreprocessing = true;
+    std::string inputPath;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--depth") == 0 && i + 1 < argc) {
+            maxDepth = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--no-preprocess") == 0) {
+            isPreprocessing = false;
+        } else if (inputPath.empty() && argv[i][0] != '-') {
+            inputPath = argv[i];
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    std::ifstream file;
+    if (!inputPath.empty()) {
+        file.open(inputPath);
+        if (!file.is_open()) {
+            std::cerr << "ERR: Failed to open " << inputPath << std::endl;
+            return 1;
+        }
+    }
+    std::vector<std::string> strategies;
+    std::vector<std::vector<std::string> > rows;
+    if (!readTimes(inputPath.empty() ? std::cin : file, strategies, rows)) {
+        std::cerr << "ERR: no table of times in the input, it should be the table or bench output of papg." << std::endl;
+        return 1;
+    }
+
+    // a model choosing itself makes no sense
+    std::vector<size_t> candidates;
+    std::vector<std::string> candidateNames;
+    for (size_t i = 0; i < strategies.size(); i++) {
+        if (strategies[i] != "auto") {
+            candidates.push_back(i);
+            candidateNames.push_back(strategies[i]);
+        }
+    }
+
+    std::vector<StrategySelector::Sample> samples;
+    for (auto& row : rows) {
+        if (row.size() != strategies.size() + 1) {
+            std::cerr << "ERR: the row of " << row[0] << " doesn't have a time for every strategy." << std::endl;
+            return 1;
+        }
+
+        StrategySelector::Sample sample;
+        try {
+            const Arena arena = Parser::parse(row[0].c_str());
+            if (isPreprocessing) {
+                Preprocessor preprocessor(arena);
+                preprocessor.run();
+                sample.features = StrategySelector::computeFeatures(preprocessor.getResidualArena());
+            } else {
+                sample.features = StrategySelector::computeFeatures(arena);
+            }
+        } catch (const std::exception& exception) {
+            std::cerr << exception.what() << std::endl;
+            return 1;
+        }
+
+        // anything but a number is the reason the run was stopped
+        for (const size_t candidate : candidates) {
+            const std::string& cell = row[candidate + 1];
+            char* end = nullptr;
+            const double time = std::strtod(cell.c_str(), &end);
+            sample.times.push_back((!cell.empty() && *end == '\0') ? time : -1);
+        }
+        samples.push_back(sample);
+    }
+
+    try {
+        StrategySelector::train(candidateNames, samples, maxDepth).write(std::cout);
+    } catch (const std::exception& exception) {
+        std::cerr << exception.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}